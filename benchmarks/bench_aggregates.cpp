@@ -0,0 +1,85 @@
+//---------------------------------------------------------------------------------------------------------------------
+// bench_aggregates.cpp
+//
+// benchmarks for the AvgCalc/MinCalc/MaxCalc/SumCalc functors.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#include "bench_helpers.h"
+#include "oura_charts/functors.h"
+#include <algorithm>
+#include <functional>
+
+namespace oura_charts::bench
+{
+   /// <summary>
+   ///   run the calculator over the BPM values of the synthetic HR series, using the supplied
+   ///   conversion to get the input type the calculator expects.
+   /// </summary>
+   template <typename CalcT, typename ConvertT>
+   static void runCalc(benchmark::State& state, ConvertT convert)
+   {
+      const auto values = syntheticHeartRates(state.range(0)) | vw::transform([&convert] (const hr_data& hr) { return convert(hr.bpm); })
+                                                              | rg::to<std::vector>();
+      for (auto _ : state)
+      {
+         CalcT calc{};
+         rg::for_each(values, std::ref(calc));
+         auto result = calc.result();
+         benchmark::DoNotOptimize(result);
+      }
+      state.SetItemsProcessed(state.iterations() * state.range(0));
+   }
+
+
+   static void BM_AvgCalc_int(benchmark::State& state)
+   {
+      runCalc<AvgCalc<int>>(state, std::identity{});
+   }
+   BENCHMARK(BM_AvgCalc_int)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_RECORDS);
+
+
+   static void BM_AvgCalc_double(benchmark::State& state)
+   {
+      runCalc<AvgCalc<double>>(state, [] (int val) { return static_cast<double>(val); });
+   }
+   BENCHMARK(BM_AvgCalc_double)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_RECORDS);
+
+
+   static void BM_AvgCalc_nullable(benchmark::State& state)
+   {
+      // every 10th value is null, to include the null-check path.
+      runCalc<AvgCalc<double>>(state, [] (int val) { return val % 10 ? std::optional<double>{ val } : std::nullopt; });
+   }
+   BENCHMARK(BM_AvgCalc_nullable)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_RECORDS);
+
+
+   static void BM_AvgCalc_seconds(benchmark::State& state)
+   {
+      runCalc<AvgCalc<seconds>>(state, [] (int val) { return seconds{ val }; });
+   }
+   BENCHMARK(BM_AvgCalc_seconds)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_RECORDS);
+
+
+   static void BM_SumCalc_int(benchmark::State& state)
+   {
+      runCalc<SumCalc<int, int64_t>>(state, std::identity{});
+   }
+   BENCHMARK(BM_SumCalc_int)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_RECORDS);
+
+
+   static void BM_MinCalc_int(benchmark::State& state)
+   {
+      runCalc<MinCalc<int>>(state, std::identity{});
+   }
+   BENCHMARK(BM_MinCalc_int)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_RECORDS);
+
+
+   static void BM_MaxCalc_int(benchmark::State& state)
+   {
+      runCalc<MaxCalc<int>>(state, std::identity{});
+   }
+   BENCHMARK(BM_MaxCalc_int)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_RECORDS);
+
+} // namespace oura_charts::bench
@@ -0,0 +1,86 @@
+//---------------------------------------------------------------------------------------------------------------------
+// bench_chrono.cpp
+//
+// benchmarks for the date/time helpers in chrono_helpers.h
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#include "bench_helpers.h"
+
+namespace oura_charts::bench
+{
+   static void BM_parseIsoDateTime(benchmark::State& state)
+   {
+      // same timestamp format as the REST api uses.
+      const auto timestamps = syntheticHeartRates(state.range(0)) | vw::transform([] (const hr_data& hr) { return toIsoDateTime(hr.timestamp); })
+                                                                  | rg::to<std::vector>();
+      for (auto _ : state)
+      {
+         for (const auto& ts : timestamps)
+         {
+            auto res = parseIsoDateTime(ts);
+            benchmark::DoNotOptimize(res);
+         }
+      }
+      state.SetItemsProcessed(state.iterations() * state.range(0));
+   }
+   BENCHMARK(BM_parseIsoDateTime)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_TEXT_RECORDS)->Unit(benchmark::kMillisecond);
+
+
+   static void BM_parseIsoDate(benchmark::State& state)
+   {
+      const auto dates = syntheticHeartRates(state.range(0)) | vw::transform([] (const hr_data& hr) { return toIsoDate(getCalendarDate(hr.timestamp)); })
+                                                             | rg::to<std::vector>();
+      for (auto _ : state)
+      {
+         for (const auto& date : dates)
+         {
+            auto res = parseIsoDate(date);
+            benchmark::DoNotOptimize(res);
+         }
+      }
+      state.SetItemsProcessed(state.iterations() * state.range(0));
+   }
+   BENCHMARK(BM_parseIsoDate)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_TEXT_RECORDS)->Unit(benchmark::kMillisecond);
+
+
+   // weekday/month keys computed from the timestamp each time, the way the projections used to work.
+   static void BM_calendarKeys_timestamp(benchmark::State& state)
+   {
+      const auto& series = syntheticHeartRateSeries(state.range(0));
+      for (auto _ : state)
+      {
+         for (const auto& hr : series)
+         {
+            auto ymd = getCalendarDate(hr.timestamp());
+            auto wd = weekday{ sys_days{ ymd } };
+            auto ym = stripDay(ymd);
+            benchmark::DoNotOptimize(wd);
+            benchmark::DoNotOptimize(ym);
+         }
+      }
+      state.SetItemsProcessed(state.iterations() * state.range(0));
+   }
+   BENCHMARK(BM_calendarKeys_timestamp)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_RECORDS)->Unit(benchmark::kMillisecond);
+
+
+   // same keys from the day number that HeartRate caches when it's created.
+   static void BM_calendarKeys_dayNumber(benchmark::State& state)
+   {
+      const auto& series = syntheticHeartRateSeries(state.range(0));
+      for (auto _ : state)
+      {
+         for (const auto& hr : series)
+         {
+            auto wd = heartRateWeekday(hr);
+            auto ym = heartRateYearMonth(hr);
+            benchmark::DoNotOptimize(wd);
+            benchmark::DoNotOptimize(ym);
+         }
+      }
+      state.SetItemsProcessed(state.iterations() * state.range(0));
+   }
+   BENCHMARK(BM_calendarKeys_dayNumber)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_RECORDS)->Unit(benchmark::kMillisecond);
+
+} // namespace oura_charts::bench
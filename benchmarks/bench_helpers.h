@@ -0,0 +1,129 @@
+//---------------------------------------------------------------------------------------------------------------------
+// bench_helpers.h
+//
+// synthetic data and common settings used by the benchmarks.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "oura_charts/chrono_helpers.h"
+#include "oura_charts/HeartRate.h"
+#include "oura_charts/detail/json_structs.h"
+#include <benchmark/benchmark.h>
+#include <fmt/format.h>
+#include <array>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace oura_charts::bench
+{
+   using namespace detail;
+   using namespace std::literals;
+
+   // smallest/largest number of records used for the scaling benchmarks.
+   inline constexpr int64_t MIN_RECORDS = 1'000;
+   inline constexpr int64_t MAX_RECORDS = 10'000'000;
+
+   // JSON text for 10M HR records is close to a GB, so the text-based benchmarks stop at 1M.
+   inline constexpr int64_t MAX_TEXT_RECORDS = 1'000'000;
+   inline constexpr int RANGE_MULTIPLIER = 10;
+
+   inline constexpr local_days SYNTHETIC_START_DATE{ 2020y / 1 / 1 };
+   inline constexpr seconds SYNTHETIC_HR_INTERVAL{ 300 };
+   inline constexpr uint64_t SYNTHETIC_SEED = 20240101;
+
+
+   /// <summary>
+   ///   caches the value generated for the most recent size only. The scaling benchmarks run each size in
+   ///   order, so keeping every size alive would just grow memory use until the largest one.
+   /// </summary>
+   template <typename T>
+   class LatestSizeCache
+   {
+   public:
+      template <typename GenFunc>
+      const T& get(int64_t count, GenFunc&& gen)
+      {
+         if (!m_value || m_count != count)
+         {
+            m_value.reset(); // free the old size before generating the new one.
+            m_value.emplace(gen());
+            m_count = count;
+         }
+         return *m_value;
+      }
+
+   private:
+      int64_t m_count{ -1 };
+      std::optional<T> m_value{};
+   };
+
+
+   /// <summary>
+   ///   generate 'count' heart rate structs, one every 5 minutes starting from a fixed date. Results for the
+   ///   last count are cached, because google-benchmark calls each benchmark function several times while it's
+   ///   figuring out the iteration count and we don't want to re-generate millions of records every time.
+   ///   The returned reference is only valid until the next call with a different count.
+   /// </summary>
+   inline const std::vector<hr_data>& syntheticHeartRates(int64_t count)
+   {
+      static LatestSizeCache<std::vector<hr_data>> cache{};
+
+      return cache.get(count, [count]
+         {
+            std::mt19937_64 rng{ SYNTHETIC_SEED };
+            std::uniform_int_distribution bpm_dist{ 45, 160 };
+            const std::array sources{ "awake"s, "rest"s, "sleep"s, "workout"s };
+
+            std::vector<hr_data> data{};
+            data.reserve(static_cast<size_t>(count));
+            auto timestamp = local_seconds{ SYNTHETIC_START_DATE };
+            for (int64_t idx = 0; idx < count; ++idx, timestamp += SYNTHETIC_HR_INTERVAL)
+            {
+               data.emplace_back(hr_data{ bpm_dist(rng), sources[rng() % sources.size()], timestamp });
+            }
+            return data;
+         });
+   }
+
+
+   /// <summary>
+   ///   cached HeartRateSeries containing the same data as syntheticHeartRates()
+   /// </summary>
+   inline const HeartRateSeries& syntheticHeartRateSeries(int64_t count)
+   {
+      static LatestSizeCache<HeartRateSeries> cache{};
+
+      return cache.get(count, [count] { return HeartRateSeries{ syntheticHeartRates(count) }; });
+   }
+
+
+   /// <summary>
+   ///   cached JSON text for a single page containing 'count' heart rate records, in the same
+   ///   format the REST API uses.
+   /// </summary>
+   inline const std::string& syntheticHeartRateJson(int64_t count)
+   {
+      static LatestSizeCache<std::string> cache{};
+
+      return cache.get(count, [count]
+         {
+            std::string json{ R"({"data":[)" };
+            auto out = std::back_inserter(json);
+            bool first = true;
+            for (const auto& hr : syntheticHeartRates(count))
+            {
+               fmt::format_to(out, R"({}{{"bpm":{},"source":"{}","timestamp":"{}"}})", first ? "" : ",", hr.bpm, hr.source, toIsoDateTime(hr.timestamp));
+               first = false;
+            }
+            json.append(R"(],"next_token":null})");
+            return json;
+         });
+   }
+
+} // namespace oura_charts::bench
@@ -0,0 +1,108 @@
+//---------------------------------------------------------------------------------------------------------------------
+// bench_json.cpp
+//
+// benchmarks for parsing REST JSON responses into data structs.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#include "bench_helpers.h"
+#include "SyntheticDataGenerator.h"
+#include <string>
+
+namespace oura_charts::bench
+{
+   static void BM_readJson_HeartRate(benchmark::State& state)
+   {
+      const auto& json = syntheticHeartRateJson(state.range(0));
+      for (auto _ : state)
+      {
+         auto res = readJson<RestDataCollection<hr_data>>(json);
+         if (!res)
+         {
+            state.SkipWithError(res.error().what());
+            break;
+         }
+         benchmark::DoNotOptimize(res);
+      }
+      state.SetItemsProcessed(state.iterations() * state.range(0));
+      state.SetBytesProcessed(state.iterations() * std::ssize(json));
+   }
+   BENCHMARK(BM_readJson_HeartRate)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_TEXT_RECORDS)->Unit(benchmark::kMillisecond);
+
+
+
+   // one week to ten years of sleep sessions
+   inline constexpr int64_t MIN_SLEEP_DAYS = 7;
+   inline constexpr int64_t MAX_SLEEP_DAYS = 3650;
+
+
+   /// <summary>
+   ///   cached JSON text for a single page containing 'num_days' of sleep sessions. Sleep records are large, with
+   ///   interval arrays and long strings, so they're a very different payload shape from heart rate.
+   /// </summary>
+   inline const std::string& syntheticSleepJson(int64_t num_days)
+   {
+      static LatestSizeCache<std::string> cache{};
+
+      return cache.get(num_days, [num_days]
+         {
+            test::SyntheticDataGenerator gen{ test::SyntheticDataOptions{ .seed = SYNTHETIC_SEED, .num_days = static_cast<int>(num_days), .page_size = 0 } };
+            return std::move(gen.sleepSessionPages().front());
+         });
+   }
+
+
+   /// <summary>
+   ///   parse a single page of JSON with the specified backend, so the backends can be compared on the same
+   ///   payload.
+   /// </summary>
+   template <JsonBackend BackendT, typename StorageT>
+   static void readJsonBackend(benchmark::State& state, const std::string& json)
+   {
+      int64_t record_count{};
+      for (auto _ : state)
+      {
+         auto res = readJson<RestDataCollection<StorageT>>(json, {}, BackendT{});
+         if (!res)
+         {
+            state.SkipWithError(res.error().what());
+            break;
+         }
+         record_count = std::ssize(res.value().data);
+         benchmark::DoNotOptimize(res);
+      }
+      state.SetLabel(std::string{ BackendT::NAME });
+      state.SetItemsProcessed(state.iterations() * record_count);
+      state.SetBytesProcessed(state.iterations() * std::ssize(json));
+   }
+
+   template <JsonBackend BackendT>
+   static void BM_readJsonBackend_HeartRate(benchmark::State& state)
+   {
+      readJsonBackend<BackendT, hr_data>(state, syntheticHeartRateJson(state.range(0)));
+   }
+
+   template <JsonBackend BackendT>
+   static void BM_readJsonBackend_SleepSession(benchmark::State& state)
+   {
+      readJsonBackend<BackendT, sleep_data>(state, syntheticSleepJson(state.range(0)));
+   }
+
+   template <JsonBackend BackendT>
+   static void BM_readJsonBackend_SleepSummary(benchmark::State& state)
+   {
+      readJsonBackend<BackendT, sleep_summary_data>(state, syntheticSleepJson(state.range(0)));
+   }
+
+   BENCHMARK(BM_readJsonBackend_HeartRate<GlazeBackend>)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_TEXT_RECORDS)->Unit(benchmark::kMillisecond);
+   BENCHMARK(BM_readJsonBackend_SleepSession<GlazeBackend>)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_SLEEP_DAYS, MAX_SLEEP_DAYS)->Unit(benchmark::kMillisecond);
+   BENCHMARK(BM_readJsonBackend_SleepSummary<GlazeBackend>)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_SLEEP_DAYS, MAX_SLEEP_DAYS)->Unit(benchmark::kMillisecond);
+
+#if defined(OURACHARTS_SIMDJSON) && OURACHARTS_SIMDJSON
+   BENCHMARK(BM_readJsonBackend_HeartRate<SimdjsonBackend>)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_TEXT_RECORDS)->Unit(benchmark::kMillisecond);
+   BENCHMARK(BM_readJsonBackend_SleepSession<SimdjsonBackend>)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_SLEEP_DAYS, MAX_SLEEP_DAYS)->Unit(benchmark::kMillisecond);
+   BENCHMARK(BM_readJsonBackend_SleepSummary<SimdjsonBackend>)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_SLEEP_DAYS, MAX_SLEEP_DAYS)->Unit(benchmark::kMillisecond);
+#endif
+
+} // namespace oura_charts::bench
@@ -0,0 +1,121 @@
+//---------------------------------------------------------------------------------------------------------------------
+// bench_logging.cpp
+//
+// benchmarks the cost (on the calling thread) of logging REST response bodies with sync/async loggers, both on
+// its own and as part of fetching data from a loopback mock of the REST API.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#include "bench_helpers.h"
+#include "oura_charts/HeartRate.h"
+#include "oura_charts/RestDataProvider.h"
+#include "oura_charts/TokenAuth.h"
+#include "oura_charts/detail/logging.h"
+#include "MockOuraServer.h"
+#include <spdlog/sinks/basic_file_sink.h>
+#include <filesystem>
+
+namespace oura_charts::bench
+{
+   // roughly a single page of HR data from the REST API
+   inline constexpr int64_t LOGGING_BODY_RECORDS = 10'000;
+
+   // number of days of HR data fetched from the mock server, which is 9 pages with the default page size.
+   inline constexpr int FETCH_DAYS = 30;
+   inline constexpr const char* FETCH_TOKEN = "bench_token";
+
+   enum class ResponseLogging
+   {
+      Off,
+      Sync,
+      Async
+   };
+
+   namespace
+   {
+      logging::sink_ptr_t makeBenchSink()
+      {
+         auto log_path = std::filesystem::temp_directory_path() / "oura_charts_bench.log";
+         return std::make_shared<spdlog::sinks::basic_file_sink_mt>(log_path.generic_string(), true);
+      }
+
+      // LogFactory::makePrivate() also replaces the default logger, so the sync logger is created directly. The
+      // async logger blocks when its queue is full, so every message gets formatted and written and the two are
+      // doing the same amount of work.
+      logging::log_ptr_t makeBenchLogger(bool async)
+      {
+         if (async)
+         {
+            return logging::LogFactory::makePrivateAsync("bench", { makeBenchSink() }, logging::level_enum::trace,
+                                                         logging::AsyncLogOptions{ .overflow_policy = logging::async_overflow_policy::block });
+         }
+         auto logger = std::make_shared<spdlog::logger>("bench", makeBenchSink());
+         logger->set_level(logging::level_enum::trace);
+         return logger;
+      }
+   }
+
+
+   /// <summary>
+   ///   log a response body the way RestDataProvider does, either with the full text or just a summary.
+   /// </summary>
+   template <bool Async, bool Summarize>
+   static void BM_logResponseBody(benchmark::State& state)
+   {
+      const auto& body = syntheticHeartRateJson(LOGGING_BODY_RECORDS);
+
+      auto logger = makeBenchLogger(Async);
+
+      for (auto _ : state)
+      {
+         if constexpr (Summarize)
+            logger->trace("RestDataProvider - received JSON response: {}", logging::TextSummary{ body });
+         else
+            logger->trace("RestDataProvider - received the following JSON:\r\n{}", body);
+      }
+      logger->flush();
+      state.SetBytesProcessed(state.iterations() * std::ssize(body));
+   }
+   BENCHMARK(BM_logResponseBody<false, false>);
+   BENCHMARK(BM_logResponseBody<false, true>);
+   BENCHMARK(BM_logResponseBody<true, false>);
+   BENCHMARK(BM_logResponseBody<true, true>);
+
+
+   /// <summary>
+   ///   fetch HR data from a loopback mock of the REST API with RestDataProvider's response logging turned off,
+   ///   or going to a sync/async default logger, to see how much the logging adds to a real fetch.
+   /// </summary>
+   template <ResponseLogging Logging>
+   static void BM_fetchWithResponseLogging(benchmark::State& state)
+   {
+      static const test::SyntheticDataGenerator generator{ test::SyntheticDataOptions{ .seed = SYNTHETIC_SEED, .num_days = FETCH_DAYS, .time_zone = "" } };
+      test::MockOuraServer server{ generator, test::MockServerOptions{ .token = FETCH_TOKEN } };
+      RestDataProvider provider{ TokenAuth{ FETCH_TOKEN }, server.baseUrl() };
+
+      // RestDataProvider logs to the default logger, so swap ours in and put the old one back when finished.
+      auto previous_logger = spdlog::default_logger();
+      auto logger = makeBenchLogger(Logging == ResponseLogging::Async);
+      if constexpr (Logging == ResponseLogging::Off)
+         logger->set_level(logging::level_enum::off);
+
+      spdlog::set_default_logger(logger);
+
+      const sys_days start{ chrono::year{ 2022 } / 1 / 1 };
+      size_t record_count{};
+      for (auto _ : state)
+      {
+         auto series = getDataSeries<HeartRate>(provider, start, start + days{ FETCH_DAYS });
+         record_count = series.size();
+         benchmark::DoNotOptimize(series);
+      }
+      logger->flush();
+      spdlog::set_default_logger(previous_logger);
+      state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(record_count));
+   }
+   BENCHMARK(BM_fetchWithResponseLogging<ResponseLogging::Off>)->Unit(benchmark::kMillisecond)->UseRealTime();
+   BENCHMARK(BM_fetchWithResponseLogging<ResponseLogging::Sync>)->Unit(benchmark::kMillisecond)->UseRealTime();
+   BENCHMARK(BM_fetchWithResponseLogging<ResponseLogging::Async>)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+} // namespace oura_charts::bench
@@ -0,0 +1,185 @@
+//---------------------------------------------------------------------------------------------------------------------
+// bench_provider.cpp
+//
+// end-to-end benchmarks for getDataSeries(), using paged synthetic data served from memory.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#include "bench_helpers.h"
+#include "oura_charts/DailySleepScore.h"
+#include "oura_charts/ReplayDataProvider.h"
+#include "oura_charts/SleepSession.h"
+#include "oura_charts/ThreadPool.h"
+#include "oura_charts/detail/utility.h"
+#include "CountingResource.h"
+#include "SyntheticDataGenerator.h"
+#include "TestDataProvider.h"
+#include <memory_resource>
+#include <optional>
+
+namespace oura_charts::bench
+{
+   // one to ten years of data
+   inline constexpr int64_t MIN_PROVIDER_DAYS = 365;
+   inline constexpr int64_t MAX_PROVIDER_DAYS = 3650;
+
+   // environment variable with the folder of a recording to use for the replay benchmarks.
+   inline constexpr const char* REPLAY_FOLDER_VAR = "OURACHARTS_REPLAY_FOLDER";
+
+
+   /// <summary>
+   ///   Returns a provider populated with 'num_days' of synthetic data, cached for the same reason
+   ///   as syntheticHeartRates()
+   /// </summary>
+   inline const test::TestDataProvider& syntheticProvider(int64_t num_days)
+   {
+      static LatestSizeCache<test::TestDataProvider> cache{};
+
+      return cache.get(num_days, [num_days]
+         {
+            test::SyntheticDataGenerator gen{ test::SyntheticDataOptions{ .seed = SYNTHETIC_SEED, .num_days = static_cast<int>(num_days) } };
+            test::TestDataProvider provider{};
+            gen.populate(provider);
+            return provider;
+         });
+   }
+
+
+   template <typename ElementT>
+   static void BM_getDataSeries(benchmark::State& state)
+   {
+      const auto& provider = syntheticProvider(state.range(0));
+      size_t record_count{};
+      for (auto _ : state)
+      {
+         auto series = detail::getDataSeries<ElementT>(provider, detail::SortedPropertyMap{});
+         record_count = series.size();
+         benchmark::DoNotOptimize(series);
+      }
+      state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(record_count));
+   }
+   BENCHMARK(BM_getDataSeries<HeartRate>)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_PROVIDER_DAYS, MAX_PROVIDER_DAYS)->Unit(benchmark::kMillisecond);
+   BENCHMARK(BM_getDataSeries<SleepSession>)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_PROVIDER_DAYS, MAX_PROVIDER_DAYS)->Unit(benchmark::kMillisecond);
+   BENCHMARK(BM_getDataSeries<SleepSessionSummary>)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_PROVIDER_DAYS, MAX_PROVIDER_DAYS)->Unit(benchmark::kMillisecond);
+
+
+   /// <summary>
+   ///   ten years of heart rate data, parsed on a pool with the number of threads given by the benchmark
+   ///   argument. Shows how page parsing scales with cores.
+   /// </summary>
+   static void BM_getDataSeries_threads(benchmark::State& state)
+   {
+      const auto& provider = syntheticProvider(MAX_PROVIDER_DAYS);
+      ThreadPool pool{ static_cast<size_t>(state.range(0)) };
+      size_t record_count{};
+      for (auto _ : state)
+      {
+         auto series = detail::getDataSeries<HeartRate>(provider, SortedPropertyMap{}, pool);
+         record_count = series.size();
+         benchmark::DoNotOptimize(series);
+      }
+      state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(record_count));
+   }
+   BENCHMARK(BM_getDataSeries_threads)->RangeMultiplier(2)->Range(1, 16)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+   /// <summary>
+   ///   same as BM_getDataSeries, but allocating the series and page buffers from a memory resource. The
+   ///   "allocs" counter is the number of allocations made by the container storage, and "arena_blocks" is
+   ///   how many of those actually reach the heap when they go through a monotonic arena instead.
+   /// </summary>
+   template <typename ElementT>
+   static void BM_getDataSeries_arena(benchmark::State& state)
+   {
+      const auto& provider = syntheticProvider(state.range(0));
+      size_t record_count{};
+      test::CountingResource direct{};
+      {
+         auto series = detail::getDataSeries<ElementT>(provider, SortedPropertyMap{}, &direct);
+      }
+
+      test::CountingResource upstream{};
+      for (auto _ : state)
+      {
+         upstream.reset();
+         std::pmr::monotonic_buffer_resource arena{ &upstream };
+         auto series = detail::getDataSeries<ElementT>(provider, SortedPropertyMap{}, &arena);
+         record_count = series.size();
+         benchmark::DoNotOptimize(series);
+      }
+      state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(record_count));
+      state.counters["allocs"] = static_cast<double>(direct.allocationCount());
+      state.counters["arena_blocks"] = static_cast<double>(upstream.allocationCount());
+   }
+   BENCHMARK(BM_getDataSeries_arena<HeartRate>)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_PROVIDER_DAYS, MAX_PROVIDER_DAYS)->Unit(benchmark::kMillisecond);
+   BENCHMARK(BM_getDataSeries_arena<SleepSession>)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_PROVIDER_DAYS, MAX_PROVIDER_DAYS)->Unit(benchmark::kMillisecond);
+
+
+   /// <summary>
+   ///   Returns a provider for the recording in the OURACHARTS_REPLAY_FOLDER folder, or nullptr if the variable
+   ///   isn't set. Loaded once for the same reason as syntheticProvider().
+   /// </summary>
+   inline const ReplayDataProvider* replayProvider()
+   {
+      static const auto provider = [] () -> std::optional<ReplayDataProvider>
+         {
+            auto folder = detail::getEnvironmentVariable(REPLAY_FOLDER_VAR);
+            if (folder.empty())
+               return std::nullopt;
+
+            // match by path and next_token, since the recorded requests were probably for a date range.
+            return ReplayDataProvider{ folder, ReplayOptions{ .match_params = false } };
+         }();
+
+      return provider ? &provider.value() : nullptr;
+   }
+
+
+   /// <summary>
+   ///   same as BM_getDataSeries, but using real REST responses saved with RecordingDataProvider (eg with
+   ///   get_sleep_data --record) and replayed from memory, so parsing can be measured on production payloads.
+   ///   Skipped unless OURACHARTS_REPLAY_FOLDER is set.
+   /// </summary>
+   template <typename ElementT>
+   static void BM_getDataSeries_replay(benchmark::State& state)
+   {
+      const ReplayDataProvider* provider{};
+      try
+      {
+         provider = replayProvider();
+      }
+      catch (oura_exception& e)
+      {
+         state.SkipWithError(e.what());
+         return;
+      }
+
+      if (!provider)
+      {
+         state.SkipWithError("OURACHARTS_REPLAY_FOLDER not set");
+         return;
+      }
+
+      size_t record_count{};
+      for (auto _ : state)
+      {
+         try
+         {
+            auto series = detail::getDataSeries<ElementT>(*provider);
+            record_count = series.size();
+            benchmark::DoNotOptimize(series);
+         }
+         catch (oura_exception& e)
+         {
+            state.SkipWithError(e.what());
+            break;
+         }
+      }
+      state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(record_count));
+   }
+   BENCHMARK(BM_getDataSeries_replay<HeartRate>)->Unit(benchmark::kMillisecond);
+   BENCHMARK(BM_getDataSeries_replay<SleepSession>)->Unit(benchmark::kMillisecond);
+   BENCHMARK(BM_getDataSeries_replay<DailySleepScore>)->Unit(benchmark::kMillisecond);
+
+} // namespace oura_charts::bench
@@ -0,0 +1,64 @@
+//---------------------------------------------------------------------------------------------------------------------
+// bench_series.cpp
+//
+// benchmarks for constructing and grouping DataSeries objects.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#include "bench_helpers.h"
+
+namespace oura_charts::bench
+{
+   static void BM_DataSeries_construct(benchmark::State& state)
+   {
+      const auto& source = syntheticHeartRates(state.range(0));
+      for (auto _ : state)
+      {
+         // the ctor consumes its argument, so make a fresh copy outside of the timed section.
+         state.PauseTiming();
+         auto structs = source;
+         state.ResumeTiming();
+
+         HeartRateSeries series{ std::move(structs) };
+         benchmark::DoNotOptimize(series);
+
+         state.PauseTiming();
+         { auto discard = std::move(series); }
+         state.ResumeTiming();
+      }
+      state.SetItemsProcessed(state.iterations() * state.range(0));
+   }
+   BENCHMARK(BM_DataSeries_construct)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_RECORDS)->Unit(benchmark::kMillisecond);
+
+
+   /// <summary>
+   ///   benchmark groupBy() into one of the MapBy* map types using the supplied projection.
+   /// </summary>
+   template <typename MapT, const auto& Proj>
+   static void BM_groupBy(benchmark::State& state)
+   {
+      const auto& source = syntheticHeartRateSeries(state.range(0));
+      for (auto _ : state)
+      {
+         state.PauseTiming();
+         HeartRateSeries series{ source };
+         MapT map{};
+         state.ResumeTiming();
+
+         groupBy(std::move(series), map, Proj);
+         benchmark::DoNotOptimize(map);
+
+         // don't time the destruction of the map's nodes
+         state.PauseTiming();
+         { auto discard = std::move(map); }
+         state.ResumeTiming();
+      }
+      state.SetItemsProcessed(state.iterations() * state.range(0));
+   }
+   BENCHMARK(BM_groupBy<HeartRateByWeekday, heartRateWeekday>)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_RECORDS)->Unit(benchmark::kMillisecond);
+   BENCHMARK(BM_groupBy<HeartRateByMonth, heartRateMonth>)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_RECORDS)->Unit(benchmark::kMillisecond);
+   BENCHMARK(BM_groupBy<HeartRateByYearMonth, heartRateYearMonth>)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_RECORDS)->Unit(benchmark::kMillisecond);
+   BENCHMARK(BM_groupBy<HeartRateByYear, heartRateYear>)->RangeMultiplier(RANGE_MULTIPLIER)->Range(MIN_RECORDS, MAX_RECORDS)->Unit(benchmark::kMillisecond);
+
+} // namespace oura_charts::bench
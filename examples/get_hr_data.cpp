@@ -5,15 +5,30 @@
 //
 // Copyright (c) 2024 Jeff Kohn. All Right Reserved.
 //---------------------------------------------------------------------------------------------------------------------
-#include "oura_charts/HeartRate.h"
+#include "oura_charts/HeartRateFollower.h"
 #include "helpers.h"
 #include "oura_charts/RestDataProvider.h"
 #include "oura_charts/TokenAuth.h"
 #include "oura_charts/detail/logging.h"
-#include "oura_charts/functors.h"
+#include <fmt/chrono.h>
 #include <fmt/format.h>
-#include <map>
-#include <ranges>
+#include <atomic>
+#include <csignal>
+#include <stop_token>
+#include <thread>
+
+
+namespace
+{
+   // set when Ctrl+C is pressed. Only lock-free atomics are safe to touch from a signal handler.
+   std::atomic<bool> g_interrupted{ false };
+   static_assert(std::atomic<bool>::is_always_lock_free);
+
+   extern "C" void onInterrupt(int /*signal*/)
+   {
+      g_interrupted = true;
+   }
+}
 
 
 // This example retrieves heart-rate data from the REST API
@@ -22,7 +37,7 @@ int main(int argc, char* argv[])
    using std::string;
    using fmt::println;
    using namespace oura_charts;
-   namespace rg = std::ranges;
+   using namespace std::literals;
 
    auto logger = logging::LogFactory::makeDefault();
    try
@@ -30,6 +45,10 @@ int main(int argc, char* argv[])
       cxxopts::Options options{ argv[0], "Get today's HR data from Oura Ring API." }; //NOLINT (cppcoreguidelines-pro-bounds-pointer-arithmetic)
       options.add_options()
          ("t,token", "Personal Access Token for your Oura cloud account", cxxopts::value<string>()->default_value(""))
+         ("f,follow", "keep running, and print new samples as they arrive", cxxopts::value<bool>())
+         ("i,interval", "seconds between polls in follow mode", cxxopts::value<int>()->default_value("60"))
+         ("s,stats", "print performance statistics when finished, as a 'table' or 'json'", cxxopts::value<std::string>()->implicit_value("table"))
+         ("a,async-log", "write log messages from a background thread, so logging doesn't slow down fetching", cxxopts::value<bool>())
          ("h,help", "show help", cxxopts::value<bool>());
 
       auto args = options.parse(argc, argv);
@@ -38,45 +57,61 @@ int main(int argc, char* argv[])
          println("{}", options.help());
          return 0;
       }
+
+      if (args.count("async-log"))
+         logger = logging::LogFactory::makeDefaultAsync();
+
       auto pat{ getPersonalToken(args) };
 
-      // Get all data from midnight local time to now.
+      const chrono::seconds interval{ args["interval"].as<int>() };
+      if (interval <= 0s)
+         throw std::runtime_error("--interval must be a positive number of seconds.");
+
+      // Get all data from midnight local time to now. The follower keeps hourly averages as samples are added,
+      // so there's no need to group and re-average the whole day afterwards.
       RestDataProvider rest_server{ TokenAuth{pat}, constants::REST_DEFAULT_BASE_URL };
-      auto until = localNow();
-      auto from = stripTimeOfDay(until);
-      auto heart_rate_data = getDataSeries<HeartRate>(rest_server, from, until);
+      const auto midnight = stripTimeOfDay(chrono::floor<chrono::seconds>(localNow()));
+      HeartRateFollower follower{ rest_server, midnight, HeartRateFollowOptions{ .poll_interval = interval } };
+      follower.poll();
 
-      // group HR measurements by hour of day.
-      std::multimap<chrono::hours, int> heart_rates_by_hour{};
-      for (auto& hr : heart_rate_data)
+      for (const auto& [hour, avg_calc] : follower.hourlyAverages().groups())
       {
-         auto [ymd, tod] = getCivilTime(hr.timestamp());
-         heart_rates_by_hour.insert(std::make_pair(chrono::floor<chrono::hours>(tod.hours()), hr.beatsPerMin()));
+         auto result = avg_calc.result();
+         if (result.has_value())
+            fmt::println("{:%I:%M%p}-{:%I:%M%p} average heart rate = {:.1f} bpm", hour, hour + 1h, result.value());
       }
 
-      // Now for each hour, calculate the avergage of all the HR readings we have.
-      auto it = heart_rates_by_hour.begin();
-      while (it != heart_rates_by_hour.end())
+      // in follow mode keep polling for new samples until Ctrl+C is pressed. Each poll only asks for
+      // samples newer than the last one received.
+      if (args.count("follow"))
       {
-         // get the sub range representing all the values for the current key/hour and compute an average
-         auto [beg, end] = heart_rates_by_hour.equal_range(it->first);
-         std::ranges::subrange hour_range{ beg, end };
+         // request_stop() isn't safe to call from a signal handler, so a watcher thread calls it once the
+         // handler has set the flag.
+         std::stop_source stop_follow{};
+         std::signal(SIGINT, onInterrupt);
+         std::jthread interrupt_watcher{ [&stop_follow] (std::stop_token watcher_stop)
+            {
+               while (!watcher_stop.stop_requested() && !g_interrupted)
+                  std::this_thread::sleep_for(100ms);
 
-         AvgCalc<int> avg_calc{};
-         rg::for_each(hour_range, std::ref(avg_calc), [] (auto&& val) { return val.second; });
+               stop_follow.request_stop();
+            } };
 
-         // need the hour range for display purposes
-         auto start_time = from + it->first;
-         auto end_time = start_time + 1h;
+         fmt::println("\nwaiting for new samples every {}, press Ctrl+C to exit...", interval);
+         follower.follow(stop_follow.get_token(), [] (const auto& f, size_t added)
+            {
+               const auto& latest = f.series().back();
+               auto hour_avg = f.hourlyAverages().result(heartRateHour(latest));
+               fmt::println("{:%I:%M:%S%p} {} new sample(s), latest = {} bpm, hour average = {:.1f} bpm, today's range = {}-{} bpm",
+                            latest.timestamp(), added, latest.beatsPerMin(), hour_avg.value_or(0.0),
+                            f.minBpm().value_or(0), f.maxBpm().value_or(0));
+            });
 
-         // output the average to the console
-         auto result = avg_calc.result();
-         if (result.has_value())
-            fmt::println("{:%I:%M%p}-{:%I:%M%p} average heart rate = {:.1f} bpm", start_time, end_time, result.value());
-
-         // move to next hour range if we're not already at the last.
-         it = end;
+         std::signal(SIGINT, SIG_DFL);
       }
+
+      if (args.count("stats"))
+         printStats(args["stats"].as<string>());
    }
    catch (oura_exception& e)
    {
@@ -27,6 +27,7 @@ int main(int argc, char* argv[])
       cxxopts::Options options(argv[0], "OuraCharts Get User Profile"); //NOLINT (cppcoreguidelines-pro-bounds-pointer-arithmetic)
       options.add_options()
          ("t,token", "Personal Access Token for your Oura cloud account", cxxopts::value<string>()->default_value(""))
+         ("s,stats", "print performance statistics when finished, as a 'table' or 'json'", cxxopts::value<std::string>()->implicit_value("table"))
          ("h,help", "show help", cxxopts::value<bool>());
 
       auto args = options.parse(argc, argv);
@@ -40,6 +41,9 @@ int main(int argc, char* argv[])
       RestDataProvider rest_server{ TokenAuth{pat}, constants::REST_DEFAULT_BASE_URL };
       auto profile = getUserProfile(rest_server);
       fmt::println("Successfully retrieved {}", profile);
+
+      if (args.count("stats"))
+         printStats(args["stats"].as<string>());
    }
    catch (oura_exception& e)
    {
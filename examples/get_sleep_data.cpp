@@ -11,6 +11,7 @@
 #include "oura_charts/concepts.h"
 #include "oura_charts/DataSeries.h"
 #include "oura_charts/DailySleepScore.h"
+#include "oura_charts/ReplayDataProvider.h"
 #include "oura_charts/RestDataProvider.h"
 #include "oura_charts/SleepSession.h"
 #include "oura_charts/TokenAuth.h"
@@ -107,6 +108,10 @@ int main(int argc, char* argv[])
       cxxopts::Options options{ argv[0], "Get sleep session data for the given date range." }; //NOLINT (cppcoreguidelines-pro-bounds-pointer-arithmetic)
       options.add_options()
          ("t,token", "Personal Access Token for your Oura cloud account", cxxopts::value<std::string>()->default_value(""))
+         ("s,stats", "print performance statistics when finished, as a 'table' or 'json'", cxxopts::value<std::string>()->implicit_value("table"))
+         ("a,async-log", "write log messages from a background thread, so logging doesn't slow down fetching", cxxopts::value<bool>())
+         ("r,record", "save the REST responses to a folder, so they can be replayed later with --replay", cxxopts::value<std::string>())
+         ("p,replay", "use the responses saved with --record instead of the REST API", cxxopts::value<std::string>())
          ("h,help", "show help", cxxopts::value<bool>());
 
       auto args = options.parse(argc, argv);
@@ -115,14 +120,25 @@ int main(int argc, char* argv[])
          fmt::println("{}", options.help());
          return 0;
       }
-      auto pat{ getPersonalToken(args) };
+
+      if (args.count("async-log"))
+         logger = logging::LogFactory::makeDefaultAsync();
 
       // Get sleep data for the past year. score is a separate data source
       auto today = stripTimeOfDay(localNow());
       auto last_week = today - months{ 12 };
-      RestDataProvider rest_server{ TokenAuth{pat}, constants::REST_DEFAULT_BASE_URL };
-      auto sleep_data = getDataSeries<SleepSession>(rest_server, getCalendarDate(last_week), getCalendarDate(today));
-      auto score_data = getDataSeries<DailySleepScore>(rest_server, getCalendarDate(last_week), getCalendarDate(today));
+      auto fetch = [from = getCalendarDate(last_week), thru = getCalendarDate(today)] (auto&& provider)
+         {
+            return getDataSeries<SleepSession, DailySleepScore>(provider, from, thru);
+         };
+
+      // the dates move every day, so a replay only matches the recording by path and next_token.
+      auto series = args.count("replay")
+                  ? fetch(ReplayDataProvider{ args["replay"].as<std::string>(), ReplayOptions{ .match_params = false } })
+                  : args.count("record")
+                  ? fetch(RecordingDataProvider{ RestDataProvider{ TokenAuth{ getPersonalToken(args) }, constants::REST_DEFAULT_BASE_URL }, args["record"].as<std::string>() })
+                  : fetch(RestDataProvider{ TokenAuth{ getPersonalToken(args) }, constants::REST_DEFAULT_BASE_URL });
+      auto& [sleep_data, score_data] = series;
 
       // group by day of week. in case of sleep we filter for only "long" sleep (no naps)
       auto sleep_by_weekday = group<SleepByWeekday>(std::move(sleep_data), sessionWeekday, long_sleep_filter);
@@ -201,6 +217,9 @@ int main(int argc, char* argv[])
 
       result_table.print(std::cout);
       std::cout << std::endl;
+
+      if (args.count("stats"))
+         printStats(args["stats"].as<std::string>());
    }
    catch (oura_exception& e)
    {
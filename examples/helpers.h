@@ -1,10 +1,14 @@
 #pragma once
+#include "oura_charts/detail/instrumentation.h"
 #include "oura_charts/detail/utility.h"
 #include "oura_charts/concepts.h"
 #include <cxxopts.hpp>
+#include <fmt/format.h>
+#include <tabulate/table.hpp>
 #include <string>
 #include <filesystem>
 #include <fstream>
+#include <iostream>
 
 namespace fs = std::filesystem;
 
@@ -41,3 +45,62 @@ inline bool saveTextToFile(oura_charts::StringViewCompatible auto text, fs::path
    file_out << text;
    return true;
 }
+
+
+/// <summary>
+///   format a metric value for display according to its unit.
+/// </summary>
+inline std::string formatMetricValue(oura_charts::instrumentation::MetricUnit unit, double value)
+{
+   using oura_charts::instrumentation::MetricUnit;
+
+   switch (unit)
+   {
+   case MetricUnit::Nanoseconds:
+      return fmt::format("{:.3f} ms", value / 1'000'000.0); // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+   case MetricUnit::Bytes:
+      return fmt::format("{:.1f} KB", value / 1024.0);     // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+   case MetricUnit::Count:
+      break;
+   }
+   return fmt::format("{:.0f}", value);
+}
+
+
+/// <summary>
+///   print the metrics collected by the instrumentation layer, either as a table or as JSON.
+/// </summary>
+inline void printStats(std::string_view format)
+{
+   namespace inst = oura_charts::instrumentation;
+
+   if constexpr (!inst::ENABLED)
+   {
+      fmt::println("No statistics available, instrumentation was disabled at compile time.");
+      return;
+   }
+
+   if (format == "json")
+   {
+      fmt::println("{}", inst::snapshotToJson());
+      return;
+   }
+
+   tabulate::Table table{};
+   table.add_row({ "Metric", "Count", "Total", "Min", "Avg", "Max" });
+   for (const auto& metric : inst::snapshot())
+   {
+      table.add_row({ metric.name,
+                      std::to_string(metric.count),
+                      formatMetricValue(metric.unit, static_cast<double>(metric.sum)),
+                      formatMetricValue(metric.unit, static_cast<double>(metric.min)),
+                      formatMetricValue(metric.unit, metric.average()),
+                      formatMetricValue(metric.unit, static_cast<double>(metric.max)) });
+   }
+   table.format().font_align(tabulate::FontAlign::right);
+   table.column(0).format().font_align(tabulate::FontAlign::left);
+   table[0].format().font_style({ tabulate::FontStyle::bold });
+
+   table.print(std::cout);
+   std::cout << std::endl;
+}
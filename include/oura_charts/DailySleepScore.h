@@ -10,6 +10,7 @@
 
 #include "oura_charts/oura_charts.h"
 #include "DataSeries.h"
+#include "oura_charts/FieldDescriptor.h"
 #include "oura_charts/detail/json_structs.h"
 
 
@@ -35,6 +36,11 @@ namespace oura_charts
       /// </summary>
       const chrono::year_month_day& date() const { return m_data.day; }
 
+      /// <summary>
+      ///   date() as a number of days since 1970-01-01, calculated once at construction.
+      /// </summary>
+      DayNumber dayNumber() const { return m_day; }
+
       /// <summary>
       ///   the sleep score, a value from 1-100 taking various sleep factors
       ///   into account.
@@ -61,6 +67,7 @@ namespace oura_charts
 
    private:
       StorageType m_data{};
+      DayNumber m_day{ toDayNumber(m_data.day) };
    };
 
 
@@ -71,11 +78,11 @@ namespace oura_charts
    //
    // These lambda's can be used as projections for converting sessionDate() to various calandar types.
    //
-   inline constexpr auto sleepScoreYearMonthDay = selectAsYearMonthDay<&DailySleepScore::date>;
-   inline constexpr auto sleepScoreYear         = selectAsYear<&DailySleepScore::date>;
-   inline constexpr auto sleepScoreYearMonth    = selectAsYearMonth<&DailySleepScore::date>;
-   inline constexpr auto sleepScoreMonth        = selectAsMonth<&DailySleepScore::date>;
-   inline constexpr auto sleepScoreWeekday      = selectAsWeekday<&DailySleepScore::date>;
+   inline constexpr auto sleepScoreYearMonthDay = selectDayNumberAsYearMonthDay<&DailySleepScore::dayNumber>;
+   inline constexpr auto sleepScoreYear         = selectDayNumberAsYear<&DailySleepScore::dayNumber>;
+   inline constexpr auto sleepScoreYearMonth    = selectDayNumberAsYearMonth<&DailySleepScore::dayNumber>;
+   inline constexpr auto sleepScoreMonth        = selectDayNumberAsMonth<&DailySleepScore::dayNumber>;
+   inline constexpr auto sleepScoreWeekday      = selectDayNumberAsWeekday<&DailySleepScore::dayNumber>;
 
    //
    // aliases for grouping maps
@@ -86,6 +93,22 @@ namespace oura_charts
    using SleepScoreByYear       = MapByYear<DailySleepScore>;
 
 
+   //
+   // field descriptors, for use with extractColumn(), aggregateColumn(), writeCsv(), etc. The contributors
+   // map isn't a single value, so it doesn't have one.
+   //
+   inline constexpr FieldDescriptor<&DailySleepScore::id>        sleepScoreIdField        { "id" };
+   inline constexpr FieldDescriptor<&DailySleepScore::date>      sleepScoreDateField      { "date" };
+   inline constexpr FieldDescriptor<&DailySleepScore::score>     sleepScoreScoreField     { "score" };
+   inline constexpr FieldDescriptor<&DailySleepScore::timestamp> sleepScoreTimestampField { "timestamp" };
+
+   template <>
+   struct ElementFields<DailySleepScore>
+   {
+      static inline constexpr auto value = std::tuple{ sleepScoreIdField, sleepScoreDateField, sleepScoreScoreField, sleepScoreTimestampField };
+   };
+
+
    /// <summary>
    ///   concept for a map that can hold SleepSession objects.
    /// </summary>
@@ -8,10 +8,22 @@
 #pragma once
 
 #include "oura_charts/oura_charts.h"
+#include "oura_charts/detail/instrumentation.h"
 #include "oura_charts/detail/json_structs.h"
+#include "oura_charts/detail/json_stream.h"
+#include "oura_charts/ThreadPool.h"
 #include <algorithm>
+#include <cassert>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
 #include <map>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
 #include <ranges>
+#include <tuple>
 #include <vector>
 
 namespace oura_charts
@@ -27,6 +39,89 @@ namespace oura_charts
 
 
    /// <summary>
+   ///   concept for an element type whose REST endpoint filters on date/time values (start_datetime/end_datetime)
+   ///   instead of dates. The element class opts in by defining REST_FILTER_BY_DATETIME = true
+   /// </summary>
+   template <typename T>
+   concept FiltersByDateTime = requires { requires T::REST_FILTER_BY_DATETIME; };
+
+
+   /// <summary>
+   ///   concept for an element type that has a timestamp, which DataSeries uses to keep its elements in order.
+   /// </summary>
+   template <typename T>
+   concept TimestampedElement = requires (const T& t)
+   {
+      { t.timestamp() } -> std::convertible_to<local_seconds>;
+   };
+
+
+   /// <summary>
+   ///   concept for an element type that has a unique identifier.
+   /// </summary>
+   template <typename T>
+   concept IdentifiedElement = requires (const T& t)
+   {
+      { t.id() } -> std::convertible_to<std::string_view>;
+   };
+
+
+   /// <summary>
+   ///   projection that returns an element's timestamp
+   /// </summary>
+   inline constexpr auto elementTimestamp = [] (const TimestampedElement auto& elem) -> local_seconds
+      {
+         return elem.timestamp();
+      };
+
+
+   /// <summary>
+   ///   projection for the key used to detect duplicate elements when merging series: the element's id()
+   ///   if it has one, otherwise its timestamp.
+   /// </summary>
+   inline constexpr auto elementMergeKey = [] (const TimestampedElement auto& elem) -> decltype(auto)
+      {
+         if constexpr (IdentifiedElement<std::remove_cvref_t<decltype(elem)>>)
+            return elem.id();
+         else
+            return elem.timestamp();
+      };
+
+
+   /// <summary>
+   ///   An element class whose JSON is parsed into a different (smaller) struct than its usual StorageType. Any
+   ///   JSON members that aren't in StorageT are skipped by the parser instead of being decoded, so a query that
+   ///   only needs a few values doesn't pay to parse (and allocate) the rest of the record. eg:
+   ///
+   ///      auto sessions = getDataSeries<SleepSessionSummary>(provider, from, thru);
+   /// </summary>
+   /// <remarks>
+   ///   ElementT needs a constructor that accepts a StorageT, and is responsible for leaving any values that
+   ///   weren't parsed empty. Since a ProjectedElement is-a ElementT, the accessors, projections and field
+   ///   descriptors for ElementT can all be used with it.
+   /// </remarks>
+   template <DataSeriesElement ElementT, typename StorageT> requires std::constructible_from<ElementT, StorageT&&>
+   class ProjectedElement : public ElementT
+   {
+   public:
+      using StorageType = StorageT;
+
+      explicit ProjectedElement(StorageType data) noexcept(std::is_nothrow_constructible_v<ElementT, StorageT&&>) : ElementT{ std::move(data) } {}
+      ProjectedElement(const ProjectedElement&) = default;
+      ProjectedElement(ProjectedElement&&) = default;
+      ~ProjectedElement() = default;
+      ProjectedElement& operator=(const ProjectedElement&) = default;
+      ProjectedElement& operator=(ProjectedElement&&) = default;
+   };
+
+
+   /// <summary>
+   ///   concept for a callable that consumes elements as they're parsed by streamDataSeries()
+   /// </summary>
+   template <typename SinkT, typename ElementT>
+   concept RecordSink = std::invocable<SinkT&, ElementT&&>;
+
+
    /// <summary>
    ///   Concept for a type that is an instantiation of the DataSeries<> template.
    /// </summary>
@@ -42,12 +137,18 @@ namespace oura_charts
    /// <summary>
    ///   template class for constructing and managing a series of data objects from the Oura API
    /// </summary>
-   template <DataSeriesElement ElementT>
-   class DataSeries : private std::vector<ElementT>
+   /// <remarks>
+   ///   The allocator is only used for the series' own storage. Use pmr::DataSeries with an arena such as
+   ///   std::pmr::monotonic_buffer_resource to have a fetch allocate into a few large blocks that are all
+   ///   released at once.
+   /// </remarks>
+   template <DataSeriesElement ElementT, typename AllocatorT = std::allocator<ElementT>>
+   class DataSeries : private std::vector<ElementT, AllocatorT>
    {
    public:
-      using base = std::vector<ElementT>;
+      using base = std::vector<ElementT, AllocatorT>;
       using ElementType = ElementT;
+      using allocator_type = AllocatorT;
 
       // expose the needed base interface from base class. clang insists on teh "typename"
       // even though I don't think it should be necessary and MSVC doens't need it.
@@ -58,6 +159,8 @@ namespace oura_charts
       using typename base::const_reference;
       using typename base::pointer;
       using typename base::const_pointer;
+      using typename base::iterator;
+      using typename base::const_iterator;
       using typename base::reverse_iterator;
       using typename base::const_reverse_iterator;
 
@@ -74,6 +177,10 @@ namespace oura_charts
       using base::empty;
       using base::front;
       using base::back;
+      using base::push_back;
+      using base::emplace_back;
+      using base::reserve;
+      using base::get_allocator;
 
 
       /// <summary>
@@ -83,7 +190,7 @@ namespace oura_charts
       ///   the source data.
       /// </summary>
       template <rg::forward_range RangeT> requires JsonStructRange<RangeT, ElementT>
-      explicit DataSeries(RangeT data_series)
+      explicit DataSeries(RangeT data_series, const AllocatorT& alloc = AllocatorT{}) : base(alloc)
       {
          // stupid libstdc++ doesn't actually call ElementT(StorageType&&) like it should ,instead it default constructs and calls operator=(StorageType&&) 
          // which doesn't exist. So even though this would be faster, we have to use a ranged for loop and emplace() each element. pretty fucking lame
@@ -95,6 +202,105 @@ namespace oura_charts
          {
             base::emplace_back(data);
          }
+
+         if constexpr (TimestampedElement<ElementT>)
+            sortByTime();
+      }
+
+
+      /// <summary>
+      ///   returns true if the elements are in timestamp order, which is needed for range(), atOrBefore() and merge().
+      /// </summary>
+      /// <remarks>
+      ///   Series created from JSON data are always sorted. If you add elements with push_back()/emplace_back() you're
+      ///   responsible for adding them in order, or calling sortByTime() afterwards.
+      /// </remarks>
+      [[nodiscard]] bool isOrdered() const requires TimestampedElement<ElementT>
+      {
+         return rg::is_sorted(*this, {}, elementTimestamp);
+      }
+
+
+      /// <summary>
+      ///   put the elements in timestamp order. Elements with the same timestamp keep their relative order, and
+      ///   a series that's already sorted is left alone, so this is O(n) in the usual case.
+      /// </summary>
+      void sortByTime() requires TimestampedElement<ElementT>
+      {
+         if (!isOrdered())
+            rg::stable_sort(base::begin(), base::end(), {}, elementTimestamp);
+      }
+
+
+      /// <summary>
+      ///   returns the elements with a timestamp in the half-open range [from, until), without modifying or copying
+      ///   the series. The series must be ordered, lookup is O(log n).
+      /// </summary>
+      [[nodiscard]] rg::subrange<const_iterator> range(local_seconds from, local_seconds until) const requires TimestampedElement<ElementT>
+      {
+         assert(isOrdered());
+         auto first = rg::lower_bound(cbegin(), cend(), from, {}, elementTimestamp);
+         auto last = rg::lower_bound(first, cend(), std::max(from, until), {}, elementTimestamp);
+         return { first, last };
+      }
+
+
+      /// <summary>
+      ///   returns the last element with a timestamp at or before 't', or end() if there isn't one. The series must
+      ///   be ordered, lookup is O(log n).
+      /// </summary>
+      [[nodiscard]] const_iterator atOrBefore(local_seconds t) const requires TimestampedElement<ElementT>
+      {
+         assert(isOrdered());
+         auto it = rg::upper_bound(cbegin(), cend(), t, {}, elementTimestamp);
+         return it == cbegin() ? cend() : std::prev(it);
+      }
+
+
+      /// <summary>
+      ///   merge the elements from another (ordered) series into this one, in O(n + m). Where both series contain the
+      ///   same element, as determined by 'key_proj', the one from 'other' is kept since it's assumed to be from a more
+      ///   recent fetch.
+      /// </summary>
+      /// <remarks>
+      ///   Duplicates must have the same timestamp, which is true for the same record fetched twice. The default key
+      ///   is the element's id(), or its timestamp for element types without one.
+      /// </remarks>
+      template <typename KeyProjT = std::remove_const_t<decltype(elementMergeKey)>>
+         requires TimestampedElement<ElementT> and std::equality_comparable<std::invoke_result_t<KeyProjT&, const ElementT&>>
+      void merge(DataSeries other, KeyProjT key_proj = {})
+      {
+         assert(isOrdered() && other.isOrdered());
+
+         // 'other' goes first so that for equal timestamps its elements come first, and win.
+         base merged{ base::get_allocator() };
+         merged.reserve(size() + other.size());
+         rg::merge(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()),
+                   std::make_move_iterator(begin()), std::make_move_iterator(end()),
+                   std::back_inserter(merged), {}, elementTimestamp, elementTimestamp);
+
+         // drop any element whose key matches one already kept with the same timestamp. runs of equal
+         // timestamps are short (usually 1), so the nested scan doesn't matter.
+         auto run_start = merged.begin();
+         auto kept_end = merged.begin();
+         for (auto it = merged.begin(); it != merged.end(); ++it)
+         {
+            if (run_start == kept_end or elementTimestamp(*run_start) != elementTimestamp(*it))
+               run_start = kept_end;
+
+            auto is_dup = std::any_of(run_start, kept_end, [&] (const ElementT& kept)
+                                                           {
+                                                              return std::invoke(key_proj, kept) == std::invoke(key_proj, *it);
+                                                           });
+            if (!is_dup)
+            {
+               if (kept_end != it)
+                  *kept_end = std::move(*it);
+               ++kept_end;
+            }
+         }
+         merged.erase(kept_end, merged.end());
+         base::swap(merged);
       }
 
 
@@ -130,6 +336,8 @@ namespace oura_charts
       }
 
 
+      DataSeries() = default;
+      explicit DataSeries(const AllocatorT& alloc) noexcept : base(alloc) {}
       ~DataSeries() = default;
       DataSeries(DataSeries&& other) : base(std::move(other)) {}
       DataSeries(const DataSeries& other) : base(other) {}
@@ -145,6 +353,17 @@ namespace oura_charts
       }
    };
 
+
+   namespace pmr
+   {
+      /// <summary>
+      ///   DataSeries that allocates from a std::pmr::memory_resource.
+      /// </summary>
+      template <DataSeriesElement ElementT>
+      using DataSeries = oura_charts::DataSeries<ElementT, std::pmr::polymorphic_allocator<ElementT>>;
+
+   } // namespace pmr
+
    
    // template alias for map of DataSeriesElements grouped by day of week
    template <DataSeriesElement ElementT, template <typename, typename, typename> typename MapT = std::multimap>
@@ -175,6 +394,11 @@ namespace oura_charts
       using ValueType = DataSeriesT::ElementType;
       using MapValueType = rg::range_value_t<MapT>;
 
+      static auto& group_timer = instrumentation::timer(constants::METRIC_SERIES_GROUP);
+      static auto& grouped_records = instrumentation::counter(constants::METRIC_SERIES_GROUPED_RECORDS);
+      instrumentation::ScopedTimer timer{ group_timer };
+      grouped_records.add(rg::size(series));
+
       rg::transform(std::forward<DataSeriesT>(series),
                     std::inserter(map, map.end()),
                     [&proj] (ValueType& val) -> auto
@@ -188,45 +412,277 @@ namespace oura_charts
    {
       using SortedPropertyMap = std::map<std::string, std::string>;
 
-      template <DataSeriesElement ElementT, DataProvider ProviderT, KeyValueRange MapT>
-      [[nodiscard]] DataSeries<ElementT> getDataSeries(ProviderT& provider, MapT&& param_map = SortedPropertyMap{}) noexcept(false)
+      /// <summary>
+      ///   fetch all pages of data for the specified params, using 'alloc' for both the returned series and the
+      ///   buffer each page is parsed into.
+      /// </summary>
+      /// <remarks>
+      ///   Only the container storage comes from 'alloc'. Strings and vectors inside each record (eg a sleep
+      ///   session's id and interval data) still use the default heap, since the detail::*_data structs aren't
+      ///   allocator-aware.
+      /// </remarks>
+      template <DataSeriesElement ElementT, typename AllocatorT, DataProvider ProviderT, KeyValueRange MapT>
+         requires std::same_as<typename AllocatorT::value_type, ElementT>
+      [[nodiscard]] DataSeries<ElementT, AllocatorT> getDataSeries(ProviderT& provider, MapT&& param_map, const AllocatorT& alloc) noexcept(false)
+      {
+         using StorageT = typename ElementT::StorageType;
+         using PageAllocatorT = typename std::allocator_traits<AllocatorT>::template rebind_alloc<StorageT>;
+         using JsonCollectionT = detail::RestDataCollection<StorageT, PageAllocatorT>;
+
+         static auto& fetch_timer = instrumentation::timer(constants::METRIC_SERIES_FETCH);
+         static auto& pages_per_fetch = instrumentation::histogram(constants::METRIC_SERIES_PAGES);
+         static auto& records_per_page = instrumentation::histogram(constants::METRIC_SERIES_RECORDS_PER_PAGE);
+         static auto& record_count = instrumentation::counter(constants::METRIC_SERIES_RECORDS);
+         instrumentation::ScopedTimer timer{ fetch_timer };
+
+         // elements are moved straight from each page into the result, and the page buffer is re-used for
+         // the next page so its capacity only has to be allocated once.
+         DataSeries<ElementT, AllocatorT> series{ alloc };
+         JsonCollectionT page{ .data = typename JsonCollectionT::DataVector{ PageAllocatorT{ alloc } } };
+         uint64_t page_count{};
+         do
+         {
+            // the page is parsed in place and glaze leaves missing members alone, so next_token has to be reset
+            // or a response without one would repeat the previous request forever.
+            if (page.next_token)
+            {
+               param_map[constants::REST_PARAM_NEXT_TOKEN] = std::move(*page.next_token);
+               page.next_token.reset();
+            }
+
+            // get JSON from rest server
+            auto json_res = provider.getJsonData(ElementT::REST_PATH, std::forward<MapT>(param_map));
+            if (!json_res)
+               throw oura_exception{ std::move(json_res.error()) };
+
+            // parse into structs
+            page.data.clear();
+            auto data_res = readJson<JsonCollectionT>(json_res.value(), std::move(page));
+            if (!data_res)
+               throw oura_exception{ std::move(data_res.error()) };
+
+            page = std::move(data_res.value());
+            records_per_page.record(page.data.size());
+            ++page_count;
+
+            for (auto& data : page.data)
+            {
+               series.emplace_back(std::move(data));
+            }
+         } while (page.next_token); // as long as we got a non-null "next_token" back from the REST server, there's still more data to get.
+
+         pages_per_fetch.record(page_count);
+         record_count.add(series.size());
+
+         if constexpr (TimestampedElement<ElementT>)
+            series.sortByTime();
+
+         return series;
+      }
+
+
+      /// <summary>
+      ///   move the records from a set of parsed pages into a DataSeries, in page order.
+      /// </summary>
+      template <DataSeriesElement ElementT, rg::forward_range PagesT>
+      [[nodiscard]] DataSeries<ElementT> joinPages(PagesT& pages)
       {
-         using JsonCollectionT = detail::RestDataCollection<typename ElementT::StorageType>;
-         using CollectionBuffer = std::deque<typename JsonCollectionT::value_type>;
+         static auto& pages_per_fetch = instrumentation::histogram(constants::METRIC_SERIES_PAGES);
+         static auto& records_per_page = instrumentation::histogram(constants::METRIC_SERIES_RECORDS_PER_PAGE);
+         static auto& record_count = instrumentation::counter(constants::METRIC_SERIES_RECORDS);
+
+         DataSeries<ElementT> series{};
+         series.reserve(std::accumulate(rg::begin(pages), rg::end(pages), size_t{}, [] (size_t total, const auto& page) { return total + page.data.size(); }));
+         for (auto& page : pages)
+         {
+            records_per_page.record(page.data.size());
+            for (auto& data : page.data)
+            {
+               series.emplace_back(std::move(data));
+            }
+         }
 
-         // get JSON from rest server
-         auto json_res = provider.getJsonData(ElementT::REST_PATH, std::forward<MapT>(param_map));
-         if (!json_res)
-            throw oura_exception{ json_res.error() };
+         pages_per_fetch.record(static_cast<size_t>(rg::distance(pages)));
+         record_count.add(series.size());
 
-         // parse into structs
-         auto data_res = readJson<JsonCollectionT>(json_res.value());
-         if (!data_res.has_value())
-            throw oura_exception(data_res.error());
+         if constexpr (TimestampedElement<ElementT>)
+            series.sortByTime();
+
+         return series;
+      }
+
+
+      /// <summary>
+      ///   fetch all pages of data for the specified params, parsing the pages on 'pool' while the next one is
+      ///   being fetched. The pages are stitched together in the order they were received.
+      /// </summary>
+      /// <remarks>
+      ///   Only the next_token is read from each page before requesting the next one, so fetching and parsing
+      ///   overlap, and pages that arrive faster than they can be parsed are parsed concurrently. This is used
+      ///   for the default allocator only, since a custom allocator may not be safe to use from other threads.
+      /// </remarks>
+      template <DataSeriesElement ElementT, DataProvider ProviderT, KeyValueRange MapT>
+      [[nodiscard]] DataSeries<ElementT> getDataSeries(ProviderT& provider, MapT&& param_map, ThreadPool& pool) noexcept(false)
+      {
+         using StorageT = typename ElementT::StorageType;
+         using JsonCollectionT = detail::RestDataCollection<StorageT>;
 
-         // move the structs into temporary holding so we can accumulate if there's more.
-         auto& rest_data = data_res.value();
-         CollectionBuffer buf{ std::make_move_iterator(rest_data.data.begin()), std::make_move_iterator(rest_data.data.end()) };
+         static auto& fetch_timer = instrumentation::timer(constants::METRIC_SERIES_FETCH);
+         instrumentation::ScopedTimer timer{ fetch_timer };
 
-         // as long as we got a non-null "next_token" back from the REST server, there's still more data to get.
-         while (rest_data.next_token)
+         auto parse_page = [] (std::string_view json) -> JsonCollectionT
+                           {
+                              auto data_res = readJson<JsonCollectionT>(json);
+                              if (!data_res)
+                                 throw oura_exception{ std::move(data_res.error()) };
+
+                              return std::move(data_res.value());
+                           };
+
+         // deque so that adding a page doesn't move the ones the parse tasks are writing to. The task group is
+         // declared after it so that if we throw, the group waits for any running tasks before the pages go away.
+         std::deque<JsonCollectionT> pages{};
+         TaskGroup parse_tasks{ pool };
+         nullable_string next_token{};
+         do
          {
-            param_map[constants::REST_PARAM_NEXT_TOKEN] = rest_data.next_token.value();
-            json_res = provider.getJsonData(ElementT::REST_PATH, std::forward<MapT>(param_map));
+            if (next_token)
+               param_map[constants::REST_PARAM_NEXT_TOKEN] = std::move(*next_token);
+
+            // get JSON from rest server
+            auto json_res = provider.getJsonData(ElementT::REST_PATH, std::forward<MapT>(param_map));
             if (!json_res)
-               throw oura_exception{ json_res.error() };
+               throw oura_exception{ std::move(json_res.error()) };
+
+            auto token_res = readNextToken(json_res.value());
+            if (!token_res)
+               throw oura_exception{ std::move(token_res.error()) };
+
+            next_token = std::move(token_res.value());
+            auto& page = pages.emplace_back();
+            if (pages.size() == 1 and !next_token)
+            {
+               // only one page, so there's nothing to overlap with.
+               page = parse_page(json_res.value());
+            }
+            else
+            {
+               parse_tasks.run([&page, &parse_page, json = std::move(json_res.value())] { page = parse_page(json); });
+            }
+         } while (next_token); // as long as we got a non-null "next_token" back from the REST server, there's still more data to get.
+
+         parse_tasks.wait();
+         return joinPages<ElementT>(pages);
+      }
 
-            data_res = readJson<JsonCollectionT>(json_res.value());
-            if (!data_res)
-               throw oura_exception{ json_res.error() };
 
-            rest_data = data_res.value();
-            // no append_range() in libstdc++ yet
-            buf.insert(buf.end(), std::make_move_iterator(rest_data.data.begin()), std::make_move_iterator(rest_data.data.end()));
+      template <DataSeriesElement ElementT, DataProvider ProviderT, KeyValueRange MapT = SortedPropertyMap>
+      [[nodiscard]] DataSeries<ElementT> getDataSeries(ProviderT& provider, MapT&& param_map = SortedPropertyMap{}) noexcept(false)
+      {
+         return getDataSeries<ElementT>(provider, std::forward<MapT>(param_map), ThreadPool::shared());
+      }
+
+
+      /// <summary>
+      ///   getDataSeries() overload that allocates from the specified memory resource.
+      /// </summary>
+      template <DataSeriesElement ElementT, DataProvider ProviderT, KeyValueRange MapT>
+      [[nodiscard]] pmr::DataSeries<ElementT> getDataSeries(ProviderT& provider, MapT&& param_map, std::pmr::memory_resource* resource) noexcept(false)
+      {
+         return getDataSeries<ElementT>(provider, std::forward<MapT>(param_map), std::pmr::polymorphic_allocator<ElementT>{ resource });
+      }
+
+
+      /// <summary>
+      ///   Streaming version of getDataSeries(), each record is parsed as soon as its JSON has been received and
+      ///   handed to the sink, rather than parsing a whole page at a time. Returns the number of records read.
+      /// </summary>
+      template <DataSeriesElement ElementT, StreamingDataProvider ProviderT, RecordSink<ElementT> SinkT>
+      size_t streamDataSeries(ProviderT& provider, SortedPropertyMap param_map, SinkT&& sink) noexcept(false)
+      {
+         static auto& fetch_timer = instrumentation::timer(constants::METRIC_SERIES_FETCH);
+         static auto& pages_per_fetch = instrumentation::histogram(constants::METRIC_SERIES_PAGES);
+         static auto& records_per_page = instrumentation::histogram(constants::METRIC_SERIES_RECORDS_PER_PAGE);
+         static auto& record_count = instrumentation::counter(constants::METRIC_SERIES_RECORDS);
+         instrumentation::ScopedTimer timer{ fetch_timer };
+
+         size_t total_records{};
+         uint64_t page_count{};
+         std::string record_buf{};
+         for (;;)
+         {
+            // the provider calls us from its transfer callback, so errors have to be smuggled out rather than thrown.
+            std::exception_ptr sink_error{};
+            auto on_record = [&] (std::string_view json) -> bool
+               {
+                  try
+                  {
+                     // glaze wants a null-terminated buffer, which the record text inside a chunk isn't.
+                     record_buf.assign(json);
+                     auto data_res = readJson<typename ElementT::StorageType>(record_buf);
+                     if (!data_res)
+                        throw oura_exception{ std::move(data_res.error()) };
+
+                     std::invoke(sink, ElementT{ std::move(data_res.value()) });
+                     return true;
+                  }
+                  catch (...)
+                  {
+                     sink_error = std::current_exception();
+                     return false;
+                  }
+               };
+
+            JsonPageSplitter splitter{};
+            auto stream_res = provider.streamJsonData(ElementT::REST_PATH, param_map,
+                                                      [&] (std::string_view chunk) { return splitter.feed(chunk, on_record); });
+            if (sink_error)
+               std::rethrow_exception(sink_error);
+            if (!stream_res)
+               throw oura_exception{ std::move(stream_res.error()) };
+
+            auto next_token = splitter.finish();
+            if (!next_token)
+               throw oura_exception{ std::move(next_token.error()) };
+
+            records_per_page.record(splitter.recordCount());
+            total_records += splitter.recordCount();
+            ++page_count;
+
+            if (!next_token.value())
+               break;
+
+            param_map[constants::REST_PARAM_NEXT_TOKEN] = std::move(*next_token.value());
          }
+         pages_per_fetch.record(page_count);
+         record_count.add(total_records);
+         return total_records;
+      }
+
+   } // namespace detail
+
 
-         // finally move the accumulated data into a new DataSeries to return
-         return DataSeries<ElementT>{std::move(buf) };
+   namespace detail
+   {
+      /// <summary>
+      ///   build the REST params to filter an endpoint for the given (inclusive) date range. Endpoints that filter on
+      ///   date/time get the range from the start of 'from' until the start of the day after 'thru', in local time.
+      /// </summary>
+      template <DataSeriesElement ElementT>
+      [[nodiscard]] SortedPropertyMap dateRangeParams(chrono::year_month_day from, chrono::year_month_day thru)
+      {
+         if constexpr (FiltersByDateTime<ElementT>)
+         {
+            auto begin = localToUtc(local_days{ from });
+            auto end = localToUtc(local_days{ thru } + days{ 1 });
+            return { { constants::REST_PARAM_START_DATETIME, toIsoDateTime(begin) },
+                     { constants::REST_PARAM_END_DATETIME, toIsoDateTime(end) } };
+         }
+         else
+         {
+            return { { constants::REST_PARAM_START_DATE, toIsoDate(from) },
+                     { constants::REST_PARAM_END_DATE, toIsoDate(thru) } };
+         }
       }
 
    } // namespace detail
@@ -236,15 +692,73 @@ namespace oura_charts
    ///   Get a series of data of the requested type, for the given date range.
    /// </summary>
    /// <remarks>
-   ///   This overload should be used for REST endpoints that accepts a date (no time) for the filter range.
+   ///   The date range is inclusive. For endpoints that filter on date/time rather than date (see FiltersByDateTime)
+   ///   the dates are converted to a local time range covering the full days.
    /// </remarks>
    template <DataSeriesElement ElementT, DataProvider ProviderT>
    [[nodiscard]] DataSeries<ElementT> getDataSeries(ProviderT& provider, chrono::year_month_day from, chrono::year_month_day thru) noexcept(false)
    {
-      detail::SortedPropertyMap param_map{ { constants::REST_PARAM_START_DATE, toIsoDate(from) },
-                                           { constants::REST_PARAM_END_DATE, toIsoDate(thru) } };
+      return detail::getDataSeries<ElementT>(provider, detail::dateRangeParams<ElementT>(from, thru));
+   }
 
-      return detail::getDataSeries<ElementT>(provider, std::move(param_map));
+
+   /// <summary>
+   ///   Get a series of data of the requested type for the given date range, allocating from the specified memory
+   ///   resource. The resource must outlive the returned series.
+   /// </summary>
+   template <DataSeriesElement ElementT, DataProvider ProviderT>
+   [[nodiscard]] pmr::DataSeries<ElementT> getDataSeries(ProviderT& provider, chrono::year_month_day from, chrono::year_month_day thru,
+                                                         std::pmr::memory_resource* resource) noexcept(false)
+   {
+      return detail::getDataSeries<ElementT>(provider, detail::dateRangeParams<ElementT>(from, thru), resource);
+   }
+
+
+   /// <summary>
+   ///   Stream the data of the requested type for the given date range into a sink, without storing the
+   ///   whole result set (or even a whole page of it). Returns the number of records read.
+   /// </summary>
+   /// <remarks>
+   ///   Records are parsed as they arrive from the provider, so parsing overlaps the network transfer. The
+   ///   sink is called with each element as an rvalue, eg appendTo(series) or an aggregator.
+   /// </remarks>
+   template <DataSeriesElement ElementT, StreamingDataProvider ProviderT, RecordSink<ElementT> SinkT>
+   size_t streamDataSeries(ProviderT& provider, chrono::year_month_day from, chrono::year_month_day thru, SinkT&& sink) noexcept(false)
+   {
+      return detail::streamDataSeries<ElementT>(provider, detail::dateRangeParams<ElementT>(from, thru), std::forward<SinkT>(sink));
+   }
+
+
+   /// <summary>
+   ///   returns a sink for streamDataSeries() that appends each element to a DataSeries.
+   /// </summary>
+   template <DataSeriesElement ElementT, typename AllocatorT>
+   [[nodiscard]] auto appendTo(DataSeries<ElementT, AllocatorT>& series)
+   {
+      return [&series] (ElementT&& elem) { series.push_back(std::move(elem)); };
+   }
+
+
+   /// <summary>
+   ///   Get a series for each of the requested types for the given date range, returned as a tuple in the same
+   ///   order as the template arguments. eg:
+   /// 
+   ///      auto [sleep, scores] = getDataSeries<SleepSession, DailySleepScore>(provider, from, thru);
+   /// </summary>
+   /// <remarks>
+   ///   Each endpoint is fetched concurrently on its own thread, so the total time is roughly that of the
+   ///   slowest endpoint rather than the sum of all of them. The provider must be safe to call from multiple
+   ///   threads. If any fetch fails, its exception is rethrown after all fetches have completed.
+   /// </remarks>
+   template <DataSeriesElement... ElementTs, DataProvider ProviderT> requires (sizeof...(ElementTs) > 1)
+   [[nodiscard]] std::tuple<DataSeries<ElementTs>...> getDataSeries(ProviderT& provider, chrono::year_month_day from, chrono::year_month_day thru) noexcept(false)
+   {
+      auto futures = std::make_tuple(std::async(std::launch::async,
+                                                [&provider, from, thru] { return getDataSeries<ElementTs>(provider, from, thru); })...);
+
+      // wait for everything before get()'ing, so a failed fetch doesn't leave the others running while the exception propagates.
+      std::apply([] (auto&... fut) { (fut.wait(), ...); }, futures);
+      return std::apply([] (auto&... fut) { return std::tuple<DataSeries<ElementTs>...>{ fut.get()... }; }, futures);
    }
 
 
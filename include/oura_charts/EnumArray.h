@@ -0,0 +1,217 @@
+//---------------------------------------------------------------------------------------------------------------------
+// EnumArray.h
+//
+// Declaration for class template EnumArray, a fixed-size array of optional values indexed by an enum, and a functor
+// for averaging them.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "oura_charts/oura_charts.h"
+#include <array>
+#include <bitset>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+
+namespace oura_charts
+{
+   /// <summary>
+   ///   Fixed-size array of values indexed by an enum whose enumerators are 0 to Size-1, with a flag for each
+   ///   value indicating whether it's present.
+   /// </summary>
+   /// <remarks>
+   ///   This replaces a std::map<EnumT, ValueT> for small enums. Everything is stored inline, so there are
+   ///   no allocations and lookups are just an index. Missing values are stored as ValueT{} so the values
+   ///   can be summed/averaged in straight loops without checking each one, see EnumArrayAvgCalc.
+   /// </remarks>
+   template <typename EnumT, typename ValueT, size_t Size> requires std::is_enum_v<EnumT>
+   class EnumArray
+   {
+   public:
+      using EnumType = EnumT;
+      using ValueType = ValueT;
+      using ValueArray = std::array<ValueT, Size>;
+      using PresenceMask = std::bitset<Size>;
+
+      static inline constexpr size_t SIZE = Size;
+
+      /// <summary>
+      ///   returns true if a value has been set for the specified key
+      /// </summary>
+      [[nodiscard]] bool contains(EnumT key) const noexcept
+      {
+         return m_present.test(index(key));
+      }
+
+      /// <summary>
+      ///   returns the value for the specified key, or nullopt if it hasn't been set.
+      /// </summary>
+      [[nodiscard]] std::optional<ValueT> get(EnumT key) const noexcept
+      {
+         return contains(key) ? std::optional<ValueT>{ m_values[index(key)] } : std::nullopt;
+      }
+
+      /// <summary>
+      ///   returns the value for the specified key, which will be ValueT{} if it hasn't been set.
+      /// </summary>
+      [[nodiscard]] const ValueT& operator[](EnumT key) const noexcept
+      {
+         return m_values[index(key)];
+      }
+
+      void set(EnumT key, ValueT value) noexcept
+      {
+         m_values[index(key)] = std::move(value);
+         m_present.set(index(key));
+      }
+
+      void set(EnumT key, const std::optional<ValueT>& value) noexcept
+      {
+         if (value)
+            set(key, *value);
+         else
+            reset(key);
+      }
+
+      void reset(EnumT key) noexcept
+      {
+         m_values[index(key)] = ValueT{};
+         m_present.reset(index(key));
+      }
+
+      // number of values that have been set.
+      [[nodiscard]] size_t count() const noexcept { return m_present.count(); }
+
+      // total number of keys, whether they've been set or not.
+      [[nodiscard]] static constexpr size_t size() noexcept { return Size; }
+
+      // the values for all keys in enum order, unset values are ValueT{}
+      [[nodiscard]] const ValueArray& values() const noexcept { return m_values; }
+
+      // bit N is set if the value for key N has been set.
+      [[nodiscard]] const PresenceMask& presence() const noexcept { return m_present; }
+
+      /// <summary>
+      ///   call func(key, value) for each value that has been set, in enum order.
+      /// </summary>
+      template <std::invocable<EnumT, const ValueT&> FuncT>
+      void forEach(FuncT&& func) const
+      {
+         for (size_t idx = 0; idx < Size; ++idx)
+         {
+            if (m_present.test(idx))
+               func(static_cast<EnumT>(idx), m_values[idx]);
+         }
+      }
+
+      bool operator==(const EnumArray&) const = default;
+
+   private:
+      ValueArray m_values{};
+      PresenceMask m_present{};
+
+      static constexpr size_t index(EnumT key) noexcept
+      {
+         auto idx = static_cast<size_t>(key);
+         assert(idx < Size);
+         return idx;
+      }
+   };
+
+
+   /// <summary>
+   ///   Functor to calculate the average of each value in a series of EnumArray's. Values that aren't present
+   ///   in an array aren't included in the average for that key.
+   /// </summary>
+   /// <remarks>
+   ///   The sums and counts are kept in plain arrays and updated without branching on the presence of each
+   ///   value, so the compiler can vectorize the loop in operator().
+   ///
+   ///   Like the other calc functors, this object is move-only so make sure to use std::ref() with algorithms
+   ///   that take their functor by value.
+   /// </remarks>
+   template <typename EnumArrayT, typename ResultTypeT = double>
+   class EnumArrayAvgCalc
+   {
+   public:
+      using InputType = EnumArrayT;
+      using NullableInputType = std::optional<InputType>;
+      using ResultType = EnumArray<typename EnumArrayT::EnumType, ResultTypeT, EnumArrayT::SIZE>;
+
+      void operator()(const InputType& val) noexcept
+      {
+         const auto& values = val.values();
+         const auto& present = val.presence();
+
+         std::array<ResultTypeT, SIZE> flags{};
+         for (size_t idx = 0; idx < SIZE; ++idx)
+         {
+            flags[idx] = present.test(idx) ? ResultTypeT{ 1 } : ResultTypeT{ 0 };
+         }
+
+         // missing values are stored as zero, so they can be added unconditionally.
+         for (size_t idx = 0; idx < SIZE; ++idx)
+         {
+            m_sums[idx] += static_cast<ResultTypeT>(values[idx]);
+            m_counts[idx] += flags[idx];
+         }
+         ++m_count;
+      }
+
+      void operator()(const NullableInputType& val) noexcept
+      {
+         if (val.has_value())
+            (*this)(val.value());
+      }
+
+      /// <summary>
+      ///   returns the average for each key. Keys that had no values won't be present in the result.
+      /// </summary>
+      [[nodiscard]] ResultType result() const noexcept
+      {
+         ResultType result{};
+         for (size_t idx = 0; idx < SIZE; ++idx)
+         {
+            if (m_counts[idx] > ResultTypeT{ 0 })
+               result.set(static_cast<typename EnumArrayT::EnumType>(idx), m_sums[idx] / m_counts[idx]);
+         }
+         return result;
+      }
+
+      // number of arrays that have been passed to operator()
+      [[nodiscard]] size_t count() const noexcept { return m_count; }
+
+      [[nodiscard]] bool hasResult() const noexcept { return m_count > 0; }
+
+      // combine the values from another calculation into this one.
+      void merge(const EnumArrayAvgCalc& other) noexcept
+      {
+         for (size_t idx = 0; idx < SIZE; ++idx)
+         {
+            m_sums[idx] += other.m_sums[idx];
+            m_counts[idx] += other.m_counts[idx];
+         }
+         m_count += other.m_count;
+      }
+
+      EnumArrayAvgCalc() = default;
+      EnumArrayAvgCalc(const EnumArrayAvgCalc&) = delete;
+      EnumArrayAvgCalc(EnumArrayAvgCalc&&) = default;
+      EnumArrayAvgCalc& operator=(const EnumArrayAvgCalc&) = delete;
+      EnumArrayAvgCalc& operator=(EnumArrayAvgCalc&&) = default;
+
+   private:
+      static inline constexpr size_t SIZE = EnumArrayT::SIZE;
+
+      std::array<ResultTypeT, SIZE> m_sums{};
+      std::array<ResultTypeT, SIZE> m_counts{};
+      size_t m_count{};
+   };
+
+} // namespace oura_charts
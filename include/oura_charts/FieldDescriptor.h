@@ -0,0 +1,280 @@
+//---------------------------------------------------------------------------------------------------------------------
+// FieldDescriptor.h
+//
+// compile-time field metadata for the element classes (HeartRate, SleepSession, etc), and generic column
+// extraction/aggregation/output that's driven by it.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "oura_charts/oura_charts.h"
+#include "oura_charts/chrono_helpers.h"
+#include "oura_charts/functors.h"
+#include "oura_charts/GroupedAggregator.h"
+#include <array>
+#include <concepts>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <ostream>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace oura_charts
+{
+   namespace detail
+   {
+      template <typename T>
+      struct nullable_value_type
+      {
+         using type = T;
+      };
+
+      template <typename T>
+      struct nullable_value_type<std::optional<T>>
+      {
+         using type = T;
+      };
+   } // namespace detail
+
+
+   /// <summary>
+   ///   Compile-time description of one field of an element class: the accessor that returns it, a name and an
+   ///   (optional) unit. The type information comes from the accessor's return type, so a descriptor is just
+   ///   a couple of string_views and calling one is a direct (inlinable) call to the accessor.
+   /// </summary>
+   /// <remarks>
+   ///   Descriptors are callable, so they can be used anywhere a projection is expected, for example the value
+   ///   projection for aggregateBy().
+   /// </remarks>
+   template <auto Accessor>
+   struct FieldDescriptor
+   {
+      using AccessorType = decltype(Accessor);
+      using ElementType  = MemberFunctionClassType_t<AccessorType>;
+
+      // type returned by the accessor, which is what extractColumn() stores.
+      using ColumnType   = std::remove_cvref_t<std::invoke_result_t<AccessorType, const ElementType&>>;
+
+      // true if the field is a std::optional<>
+      static inline constexpr bool NULLABLE = NullableType<ColumnType>;
+
+      // the type of the field's value, without the std::optional<> if it's nullable.
+      using ValueType = typename detail::nullable_value_type<ColumnType>::type;
+
+      std::string_view name{};
+      std::string_view unit{};
+
+      decltype(auto) operator()(const ElementType& elem) const
+      {
+         return std::invoke(Accessor, elem);
+      }
+   };
+
+
+   /// <summary>
+   ///   Specialize this for an element class to describe its fields. The specialization needs a static constexpr
+   ///   'value' member that is a std::tuple of FieldDescriptor's, in the order the fields should be output.
+   /// </summary>
+   template <typename ElementT>
+   struct ElementFields;
+
+
+   /// <summary>
+   ///   a ProjectedElement has the same fields as the class it's derived from.
+   /// </summary>
+   template <typename ElementT, typename StorageT>
+   struct ElementFields<ProjectedElement<ElementT, StorageT>> : ElementFields<ElementT>
+   {};
+
+
+   /// <summary>
+   ///   concept for an element class that has an ElementFields specialization.
+   /// </summary>
+   template <typename T>
+   concept DescribedElement = requires { std::tuple_size<std::remove_cvref_t<decltype(ElementFields<T>::value)>>::value; };
+
+
+   /// <summary>
+   ///   concept for a FieldDescriptor of the specified element class (or one of its base classes, eg ProjectedElement).
+   /// </summary>
+   template <typename FieldT, typename ElementT>
+   concept FieldDescriptorFor = std::derived_from<ElementT, typename FieldT::ElementType>
+                                && std::invocable<const FieldT&, const ElementT&>;
+
+
+   /// <summary>
+   ///   the number of fields described for an element class.
+   /// </summary>
+   template <DescribedElement ElementT>
+   inline constexpr size_t fieldCount = std::tuple_size_v<std::remove_cvref_t<decltype(ElementFields<ElementT>::value)>>;
+
+
+   /// <summary>
+   ///   calls func(field) for each field descriptor of an element class, in order. This is a compile-time loop, so
+   ///   func is called with each descriptor's actual type.
+   /// </summary>
+   template <DescribedElement ElementT, typename FuncT>
+   constexpr void forEachField(FuncT&& func)
+   {
+      std::apply([&func] (const auto&... fields) { (std::invoke(func, fields), ...); }, ElementFields<ElementT>::value);
+   }
+
+
+   /// <summary>
+   ///   returns the names of the fields of an element class, in order.
+   /// </summary>
+   template <DescribedElement ElementT>
+   [[nodiscard]] constexpr auto fieldNames()
+   {
+      return std::apply([] (const auto&... fields) { return std::array<std::string_view, sizeof...(fields)>{ fields.name... }; },
+                        ElementFields<ElementT>::value);
+   }
+
+
+   /// <summary>
+   ///   copy the values of a single field out of a range of elements (eg a DataSeries) into a vector, which will
+   ///   contain std::optional<>'s if the field is nullable.
+   /// </summary>
+   template <rg::input_range RangeT, typename FieldT> requires FieldDescriptorFor<FieldT, rg::range_value_t<RangeT>>
+   [[nodiscard]] auto extractColumn(const RangeT& elements, const FieldT& field)
+   {
+      std::vector<typename FieldT::ColumnType> column{};
+      if constexpr (rg::sized_range<const RangeT>)
+         column.reserve(rg::size(elements));
+
+      for (const auto& elem : elements)
+      {
+         column.emplace_back(field(elem));
+      }
+      return column;
+   }
+
+
+   /// <summary>
+   ///   pass the value of a single field for each element in a range to an aggregate functor (AvgCalc, MinCalc, etc)
+   ///   and return the functor. Null values are handled the same way the functor handles them (usually ignored).
+   /// </summary>
+   /// <remarks>
+   ///   for grouped results, use the descriptor as the value projection for aggregateBy() instead.
+   /// </remarks>
+   template <AggregateCalc CalcT, rg::input_range RangeT, typename FieldT>
+      requires FieldDescriptorFor<FieldT, rg::range_value_t<RangeT>> && std::invocable<CalcT&, const typename FieldT::ColumnType&>
+   [[nodiscard]] CalcT aggregateColumn(const RangeT& elements, const FieldT& field)
+   {
+      CalcT calc{};
+      for (const auto& elem : elements)
+      {
+         calc(field(elem));
+      }
+      return calc;
+   }
+
+
+   namespace detail
+   {
+      /// <summary>
+      ///   append a single CSV value to 'buf'. Dates/times are ISO format (local times without a UTC designator,
+      ///   since they're wall-clock times in the user's time zone), durations are a count (so
+      ///   chrono::seconds is written as the number of seconds), enums are their underlying value and nulls
+      ///   are an empty string.
+      /// </summary>
+      template <typename T>
+      void appendCsvValue(std::string& buf, const T& val)
+      {
+         if constexpr (NullableType<T>)
+         {
+            if (val.has_value())
+               appendCsvValue(buf, val.value());
+         }
+         else if constexpr (std::same_as<T, local_seconds>)
+         {
+            fmt::format_to(std::back_inserter(buf), "{:%FT%T}", val);
+         }
+         else if constexpr (std::same_as<T, year_month_day>)
+         {
+            buf += toIsoDate(val);
+         }
+         else if constexpr (ChronoDuration<T>)
+         {
+            fmt::format_to(std::back_inserter(buf), "{}", val.count());
+         }
+         else if constexpr (std::is_enum_v<T>)
+         {
+            fmt::format_to(std::back_inserter(buf), "{}", std::to_underlying(val));
+         }
+         else if constexpr (StringViewCompatible<T>)
+         {
+            std::string_view str{ val };
+            if (str.find_first_of(",\"\r\n") == std::string_view::npos)
+            {
+               buf += str;
+               return;
+            }
+
+            // needs to be quoted, with any embedded quotes doubled.
+            buf += '"';
+            for (auto ch : str)
+            {
+               if (ch == '"')
+                  buf += '"';
+               buf += ch;
+            }
+            buf += '"';
+         }
+         else
+         {
+            fmt::format_to(std::back_inserter(buf), "{}", val);
+         }
+      }
+   } // namespace detail
+
+
+   /// <summary>
+   ///   write a range of elements to a stream as CSV, with a header row containing the field names. Each row is
+   ///   formatted into a buffer that's reused for the whole range, and written to the stream in one call.
+   /// </summary>
+   /// <returns>the number of rows written, not including the header</returns>
+   template <rg::input_range RangeT> requires DescribedElement<rg::range_value_t<RangeT>>
+   size_t writeCsv(std::ostream& out, const RangeT& elements)
+   {
+      using ElementT = rg::range_value_t<RangeT>;
+
+      std::string row{};
+      for (auto name : fieldNames<ElementT>())
+      {
+         if (!row.empty())
+            row += ',';
+         row += name;
+      }
+      row += '\n';
+      out << row;
+
+      size_t count{};
+      for (const auto& elem : elements)
+      {
+         row.clear();
+         bool first = true;
+         forEachField<ElementT>([&] (const auto& field)
+                                {
+                                   if (!first)
+                                      row += ',';
+                                   first = false;
+                                   detail::appendCsvValue(row, field(elem));
+                                });
+         row += '\n';
+         out << row;
+         ++count;
+      }
+      return count;
+   }
+
+} // namespace oura_charts
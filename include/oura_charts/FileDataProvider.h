@@ -0,0 +1,192 @@
+//---------------------------------------------------------------------------------------------------------------------
+// FileDataProvider.h
+//
+// Declaration for class FileDataProvider, which serves data from a folder of exported JSON files through the same
+// interface as RestDataProvider, for bulk imports of historical data.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "oura_charts/oura_charts.h"
+#include "oura_charts/chrono_helpers.h"
+#include "oura_charts/detail/utility.h"
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace oura_charts::constants
+{
+   // default size of the pages a FileDataProvider splits each file into.
+   inline constexpr size_t FILE_PROVIDER_DEFAULT_PAGE_BYTES = 1024ull * 1024;
+
+   inline constexpr const char* METRIC_FILE_PROVIDER_INDEX = "file_provider.index";
+   inline constexpr const char* METRIC_FILE_PROVIDER_RECORDS = "file_provider.records";
+
+} // namespace oura_charts::constants
+
+
+namespace oura_charts
+{
+   namespace fs = std::filesystem;
+
+
+   /// <summary>
+   ///   settings for FileDataProvider
+   /// </summary>
+   struct FileDataProviderOptions
+   {
+      // approximate size of each page returned by getJsonData(). Pages end at the first record that reaches this
+      // size, so a page always has at least one record.
+      size_t page_bytes{ constants::FILE_PROVIDER_DEFAULT_PAGE_BYTES };
+   };
+
+
+   /// <summary>
+   ///   Data provider that serves exported data from JSON files on disk, so that years of history can be imported
+   ///   without going through the REST API's paging and rate limits.
+   /// </summary>
+   /// <remarks>
+   ///   The folder should contain one file per endpoint, named for its REST path (eg heartrate.json, sleep.json),
+   ///   with the records in the same { "data": [...] } layout the REST API uses. Endpoints that return a single
+   ///   object (eg personal_info.json) are served as-is.
+   ///
+   ///   Files are memory-mapped and indexed the first time they're requested: each record is located (without
+   ///   being parsed or copied) and keyed by its "day" or "timestamp" field. Requests are then filtered with the
+   ///   same start/end date and date/time params as the REST API, and split into pages of roughly page_bytes, linked
+   ///   by next_token. That lets getDataSeries() parse the pages of a multi-gigabyte file in parallel the same way
+   ///   it does for REST responses, while only the pages in flight are ever copied.
+   ///
+   ///   Copies share the same mappings and indexes, and all methods are thread-safe.
+   /// </remarks>
+   class FileDataProvider
+   {
+   public:
+      // type returned when retrieving data. Expected value is the requested json, unexpected value is an
+      // exception describing what went wrong.
+      using JsonResult = expected<std::string, oura_exception>;
+
+      // type returned by streamJsonData(), which has no value since the JSON goes to the callback.
+      using StreamResult = expected<void, oura_exception>;
+
+      /// <summary>
+      ///   create a provider for the JSON files in export_folder. Throws if the folder doesn't exist. The files
+      ///   aren't opened until they're requested.
+      /// </summary>
+      explicit FileDataProvider(const fs::path& export_folder, FileDataProviderOptions options = {}) noexcept(false);
+
+      /// <summary>
+      ///   retrieve the first page of all the records for the specified path.
+      /// </summary>
+      [[nodiscard]] JsonResult getJsonData(std::string_view path) const noexcept
+      {
+         return getPage(path, PageQuery{});
+      }
+
+      /// <summary>
+      ///   retrieve a page of the records for the specified path, filtered by the start_date/end_date,
+      ///   start_datetime/end_datetime and next_token params. Any other params are ignored.
+      /// </summary>
+      template<KeyValueRange MapT>
+      [[nodiscard]] JsonResult getJsonData(std::string_view path, MapT&& param_map) const noexcept
+      {
+         return getPage(path, makeQuery(param_map));
+      }
+
+      /// <summary>
+      ///   same as getJsonData(), but passes the page to on_chunk instead of returning it.
+      /// </summary>
+      template<KeyValueRange MapT>
+      [[nodiscard]] StreamResult streamJsonData(std::string_view path, const MapT& param_map, const JsonChunkCallback& on_chunk) const noexcept
+      {
+         auto json_res = getPage(path, makeQuery(param_map));
+         if (!json_res)
+            return unexpected{ std::move(json_res.error()) };
+
+         if (!on_chunk(json_res.value()))
+            return unexpected{ oura_exception{ "FileDataProvider::streamJsonData() cancelled by callback", ErrorCategory::Parse } };
+
+         return {};
+      }
+
+      /// <summary>
+      ///   number of records in the file for path, indexing it if that hasn't been done yet. Returns 0 for an
+      ///   endpoint that's a single object, and an error if there's no file for path or it can't be read.
+      /// </summary>
+      [[nodiscard]] expected<size_t, oura_exception> recordCount(std::string_view path) const noexcept;
+
+      // REST paths there are files for, in sorted order.
+      [[nodiscard]] std::vector<std::string> paths() const;
+
+      [[nodiscard]] const fs::path& folder() const noexcept { return m_state->folder; }
+      [[nodiscard]] const FileDataProviderOptions& options() const noexcept { return m_state->options; }
+
+   private:
+      // filter params for a request, pointing into the caller's param map.
+      struct PageQuery
+      {
+         std::string_view start_date{};
+         std::string_view end_date{};
+         std::string_view start_datetime{};
+         std::string_view end_datetime{};
+         std::string_view next_token{};
+      };
+
+      struct Record
+      {
+         sys_seconds key{};
+         std::string_view json{};
+      };
+
+      // a file's index is built the first time it's requested, and doesn't change after that.
+      struct Endpoint
+      {
+         fs::path file_path{};
+         std::once_flag indexed{};
+         std::optional<detail::MappedFile> file{};
+         std::vector<Record> records{};   // sorted by key
+         bool document{};                 // file isn't a { "data": [...] } collection, so it's served whole
+      };
+
+      struct State
+      {
+         fs::path folder{};
+         FileDataProviderOptions options{};
+         std::map<std::string, std::unique_ptr<Endpoint>, std::less<>> endpoints{};
+      };
+
+      std::shared_ptr<State> m_state;
+
+      template<KeyValueRange MapT>
+      static PageQuery makeQuery(const MapT& param_map)
+      {
+         PageQuery query{};
+         for (const auto& [key, value] : param_map)
+         {
+            const std::string_view name{ key };
+            if (name == constants::REST_PARAM_START_DATE)
+               query.start_date = value;
+            else if (name == constants::REST_PARAM_END_DATE)
+               query.end_date = value;
+            else if (name == constants::REST_PARAM_START_DATETIME)
+               query.start_datetime = value;
+            else if (name == constants::REST_PARAM_END_DATETIME)
+               query.end_datetime = value;
+            else if (name == constants::REST_PARAM_NEXT_TOKEN)
+               query.next_token = value;
+         }
+         return query;
+      }
+
+      [[nodiscard]] JsonResult getPage(std::string_view path, const PageQuery& query) const noexcept;
+      [[nodiscard]] Endpoint& indexedEndpoint(std::string_view path) const noexcept(false);
+   };
+
+} // namespace oura_charts
@@ -0,0 +1,274 @@
+//---------------------------------------------------------------------------------------------------------------------
+// GroupedAggregator.h
+//
+// Declaration for class GroupedAggregator, which calculates statistics for groups of DataSeries elements without
+// needing to store the elements themselves.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "oura_charts/oura_charts.h"
+#include "oura_charts/chrono_helpers.h"
+#include "oura_charts/DataSeries.h"
+#include "oura_charts/ThreadPool.h"
+#include <algorithm>
+#include <concepts>
+#include <functional>
+#include <map>
+#include <ranges>
+#include <type_traits>
+#include <vector>
+
+
+namespace oura_charts::constants
+{
+   // aggregateSeries() doesn't split a series into chunks smaller than this, since below this size the cost of
+   // handing the work off to the pool and merging the results is more than the calculation itself.
+   inline constexpr size_t AGGREGATE_MIN_CHUNK_SIZE = 8192;
+
+} // namespace oura_charts::constants
+
+
+namespace oura_charts
+{
+   namespace detail
+   {
+      /// <summary>
+      ///   comparison used for the keys of a GroupedAggregator. chrono::weekday doesn't have operator<, so it gets
+      ///   the same comparison used by MapByWeekday.
+      /// </summary>
+      template <typename KeyT>
+      struct group_key_compare
+      {
+         using type = std::less<KeyT>;
+      };
+
+      template <>
+      struct group_key_compare<weekday>
+      {
+         using type = weekday_compare_less;
+      };
+
+      template <typename KeyT>
+      using group_key_compare_t = typename group_key_compare<KeyT>::type;
+
+   } // namespace detail
+
+
+   /// <summary>
+   ///   concept for the calculation functors in functors.h (AvgCalc, MinCalc, etc)
+   /// </summary>
+   template <typename CalcT>
+   concept AggregateCalc = std::default_initializable<CalcT> and requires (const CalcT& calc)
+   {
+      typename CalcT::InputType;
+      { calc.result() };
+      { calc.hasResult() } -> std::convertible_to<bool>;
+   };
+
+
+   /// <summary>
+   ///   concept for a calculation functor whose results can be combined, so that a calculation can be split
+   ///   into pieces that run in parallel.
+   /// </summary>
+   /// <remarks>
+   ///   merge() gives the same result as if the other functor's values had been passed to this one. It isn't
+   ///   thread-safe, each thread should work on its own functor and merge them after the threads are joined.
+   /// </remarks>
+   template <typename CalcT>
+   concept MergeableCalc = AggregateCalc<CalcT> and requires (CalcT& calc, const CalcT& other)
+   {
+      calc.merge(other);
+   };
+
+
+   /// <summary>
+   ///   Sink for streamDataSeries() that groups elements by a key projection, and feeds a value projection of each
+   ///   element into a separate calculation functor for each group.
+   /// </summary>
+   /// <remarks>
+   ///   This gives the same results as calling groupBy() and then running a calculation over each group's subrange,
+   ///   but the elements are never stored. Memory use is O(groups) rather than O(records), so it's a good fit for
+   ///   charts that only need a few summary values over a long date range.
+   ///
+   ///   Like the calc functors, this object is move-only. streamDataSeries() takes its sink by reference, so you can
+   ///   pass it directly, but you need to use std::ref() with algorithms that take their functor by value.
+   /// </remarks>
+   template <DataSeriesElement ElementT, AggregateCalc CalcT, typename KeyProjT, typename ValueProjT>
+      requires std::invocable<KeyProjT&, const ElementT&> and std::invocable<ValueProjT&, const ElementT&>
+   class GroupedAggregator
+   {
+   public:
+      using ElementType = ElementT;
+      using CalcType = CalcT;
+      using KeyType = std::remove_cvref_t<std::invoke_result_t<KeyProjT&, const ElementT&>>;
+      using ResultType = std::remove_cvref_t<decltype(std::declval<const CalcT&>().result())>;
+      using MapType = std::map<KeyType, CalcT, detail::group_key_compare_t<KeyType>>;
+
+      GroupedAggregator(KeyProjT key_proj, ValueProjT value_proj) :
+         m_key_proj{ std::move(key_proj) },
+         m_value_proj{ std::move(value_proj) }
+      {}
+
+      /// <summary>
+      ///   add an element to the calculation for its group.
+      /// </summary>
+      void operator()(const ElementT& elem)
+      {
+         auto [it, inserted] = m_groups.try_emplace(std::invoke(m_key_proj, elem));
+         std::invoke(it->second, std::invoke(m_value_proj, elem));
+         ++m_record_count;
+      }
+
+      /// <summary>
+      ///   returns the calculated result for the specified group, which will be empty/null if there was no
+      ///   (non-null) data for that group.
+      /// </summary>
+      [[nodiscard]] ResultType result(const KeyType& key) const
+      {
+         auto it = m_groups.find(key);
+         return it == m_groups.end() ? ResultType{} : ResultType{ it->second.result() };
+      }
+
+      /// <summary>
+      ///   the calc functor for each group that has had at least one element.
+      /// </summary>
+      [[nodiscard]] const MapType& groups() const noexcept { return m_groups; }
+
+      // the projections used for the keys and values
+      [[nodiscard]] const KeyProjT& keyProjection() const noexcept { return m_key_proj; }
+      [[nodiscard]] const ValueProjT& valueProjection() const noexcept { return m_value_proj; }
+
+      // total number of elements that have been aggregated, including elements with null values.
+      [[nodiscard]] size_t recordCount() const noexcept { return m_record_count; }
+
+      /// <summary>
+      ///   combine the groups from another aggregator into this one, which gives the same result as if the other
+      ///   aggregator's elements had been passed to this one.
+      /// </summary>
+      void merge(GroupedAggregator&& other) requires MergeableCalc<CalcT>
+      {
+         // groups we don't have yet are spliced in without copying, which leaves 'other' with just the
+         // groups that both of us have.
+         m_groups.merge(other.m_groups);
+         for (const auto& [key, calc] : other.m_groups)
+         {
+            m_groups.find(key)->second.merge(calc);
+         }
+         m_record_count += other.m_record_count;
+
+         other.m_groups.clear();
+         other.m_record_count = 0;
+      }
+
+      // object is move-only, same as the calc functors it contains.
+      GroupedAggregator(const GroupedAggregator&) = delete;
+      GroupedAggregator(GroupedAggregator&&) = default;
+      GroupedAggregator& operator=(const GroupedAggregator&) = delete;
+      GroupedAggregator& operator=(GroupedAggregator&&) = default;
+      ~GroupedAggregator() = default;
+
+   private:
+      KeyProjT m_key_proj;
+      ValueProjT m_value_proj;
+      MapType m_groups{};
+      size_t m_record_count{};
+   };
+
+
+   /// <summary>
+   ///   create a GroupedAggregator, eg:
+   ///
+   ///      auto avg_by_weekday = aggregateBy<DailySleepScore, AvgCalc<int>>(sleepScoreWeekday, &DailySleepScore::score);
+   /// </summary>
+   template <DataSeriesElement ElementT, AggregateCalc CalcT, typename KeyProjT, typename ValueProjT>
+   [[nodiscard]] auto aggregateBy(KeyProjT&& key_proj, ValueProjT&& value_proj)
+   {
+      return GroupedAggregator<ElementT, CalcT, std::decay_t<KeyProjT>, std::decay_t<ValueProjT>>{ std::forward<KeyProjT>(key_proj),
+                                                                                                   std::forward<ValueProjT>(value_proj) };
+   }
+
+
+   /// <summary>
+   ///   Aggregate a series (or any other sized random access range of elements) that's already in memory, splitting
+   ///   it into chunks that are aggregated in parallel on 'pool' and then merged. Gives the same result as passing
+   ///   each element to an aggregator created by aggregateBy() (apart from floating-point rounding), eg:
+   ///
+   ///      auto avg_by_month = aggregateSeries<AvgCalc<int>>(heart_rates, heartRateMonth, &HeartRate::beatsPerMin);
+   /// </summary>
+   /// <remarks>
+   ///   The projections are copied for each chunk and called concurrently, so they shouldn't have any state.
+   ///   Small series are aggregated on the calling thread.
+   /// </remarks>
+   template <MergeableCalc CalcT, rg::random_access_range RangeT, typename KeyProjT, typename ValueProjT>
+      requires rg::sized_range<const RangeT> and std::copy_constructible<std::decay_t<KeyProjT>>
+               and std::copy_constructible<std::decay_t<ValueProjT>>
+   [[nodiscard]] auto aggregateSeries(const RangeT& elements, KeyProjT&& key_proj, ValueProjT&& value_proj,
+                                      ThreadPool& pool = ThreadPool::shared())
+   {
+      using ElementT = rg::range_value_t<RangeT>;
+
+      auto aggregator = aggregateBy<ElementT, CalcT>(std::forward<KeyProjT>(key_proj), std::forward<ValueProjT>(value_proj));
+      using AggregatorT = decltype(aggregator);
+
+      const size_t size = rg::size(elements);
+      const size_t chunk_count = std::min(pool.threadCount(), size / constants::AGGREGATE_MIN_CHUNK_SIZE);
+      if (chunk_count <= 1)
+      {
+         for (const auto& elem : elements)
+         {
+            aggregator(elem);
+         }
+         return aggregator;
+      }
+
+      // the first chunk goes into 'aggregator', and the rest are merged into it in order once they're done.
+      std::vector<AggregatorT> partials{};
+      partials.reserve(chunk_count - 1);
+      for (size_t idx = 1; idx < chunk_count; ++idx)
+      {
+         partials.emplace_back(aggregateBy<ElementT, CalcT>(aggregator.keyProjection(), aggregator.valueProjection()));
+      }
+
+      auto aggregate_chunk = [&elements, size, chunk_count] (AggregatorT& chunk_aggregator, size_t chunk_idx)
+                             {
+                                auto first = rg::begin(elements) + static_cast<rg::range_difference_t<RangeT>>(size * chunk_idx / chunk_count);
+                                auto last = rg::begin(elements) + static_cast<rg::range_difference_t<RangeT>>(size * (chunk_idx + 1) / chunk_count);
+                                for (; first != last; ++first)
+                                {
+                                   chunk_aggregator(*first);
+                                }
+                             };
+
+      TaskGroup tasks{ pool };
+      for (size_t idx = 1; idx < chunk_count; ++idx)
+      {
+         tasks.run([&aggregate_chunk, &partials, idx] { aggregate_chunk(partials[idx - 1], idx); });
+      }
+      aggregate_chunk(aggregator, 0);
+      tasks.wait();
+
+      for (auto& partial : partials)
+      {
+         aggregator.merge(std::move(partial));
+      }
+      return aggregator;
+   }
+
+
+   /// <summary>
+   ///   Stream the data for the given (inclusive) date range directly into a GroupedAggregator, without creating a
+   ///   DataSeries. Returns the aggregator containing the calculated results for each group.
+   /// </summary>
+   template <DataSeriesElement ElementT, AggregateCalc CalcT, StreamingDataProvider ProviderT, typename KeyProjT, typename ValueProjT>
+   [[nodiscard]] auto aggregateDataSeries(ProviderT& provider, chrono::year_month_day from, chrono::year_month_day thru,
+                                          KeyProjT&& key_proj, ValueProjT&& value_proj) noexcept(false)
+   {
+      auto aggregator = aggregateBy<ElementT, CalcT>(std::forward<KeyProjT>(key_proj), std::forward<ValueProjT>(value_proj));
+      streamDataSeries<ElementT>(provider, from, thru, aggregator);
+      return aggregator;
+   }
+
+} // namespace oura_charts
@@ -9,6 +9,7 @@
 #include "oura_charts/oura_charts.h"
 #include "oura_charts/DataSeries.h"
 #include "oura_charts/chrono_helpers.h"
+#include "oura_charts/FieldDescriptor.h"
 
 
 namespace oura_charts
@@ -21,6 +22,7 @@ namespace oura_charts
    public:
       using StorageType = detail::hr_data;
       static inline constexpr std::string_view REST_PATH = constants::REST_PATH_HEART_RATE;
+      static inline constexpr bool REST_FILTER_BY_DATETIME = true;
 
       // Heart rate in BPM
       int beatsPerMin() const                    {  return m_data.bpm;                    }
@@ -32,7 +34,10 @@ namespace oura_charts
       const local_seconds& timestamp() const     {  return m_data.timestamp;              }
 
       // calendar date for this reading
-      year_month_day date() const                {  return getCalendarDate(timestamp());  }
+      year_month_day date() const                {  return dayNumberToYearMonthDay(m_day); }
+
+      // calendar date for this reading as a number of days since 1970-01-01, calculated once at construction.
+      DayNumber dayNumber() const                {  return m_day;                          }
 
 
       explicit HeartRate(const StorageType& data) noexcept : m_data(data) {}
@@ -45,6 +50,7 @@ namespace oura_charts
 
    private:
       StorageType m_data;
+      DayNumber m_day{ toDayNumber(m_data.timestamp) };
    };
 
    using HeartRateSeries = DataSeries<HeartRate>;
@@ -53,11 +59,14 @@ namespace oura_charts
    //
    // These lambda's can be used as projections for converting sessionDate() to various calandar types.
    //
-   inline constexpr auto heartRateYearMonthDay = selectAsYearMonthDay<&HeartRate::date>;
-   inline constexpr auto heartRateYear         = selectAsYear<&HeartRate::date>;
-   inline constexpr auto heartRateYearMonth    = selectAsYearMonth<&HeartRate::date>;
-   inline constexpr auto heartRateMonth        = selectAsMonth<&HeartRate::date>;
-   inline constexpr auto heartRateWeekday      = selectAsWeekday<&HeartRate::date>;
+   inline constexpr auto heartRateYearMonthDay = selectDayNumberAsYearMonthDay<&HeartRate::dayNumber>;
+   inline constexpr auto heartRateYear         = selectDayNumberAsYear<&HeartRate::dayNumber>;
+   inline constexpr auto heartRateYearMonth    = selectDayNumberAsYearMonth<&HeartRate::dayNumber>;
+   inline constexpr auto heartRateMonth        = selectDayNumberAsMonth<&HeartRate::dayNumber>;
+   inline constexpr auto heartRateWeekday      = selectDayNumberAsWeekday<&HeartRate::dayNumber>;
+
+   // local hour the reading was taken in (a time_point, not hour-of-day, so readings from different days stay separate)
+   inline constexpr auto heartRateHour = [] (const HeartRate& hr) { return chrono::floor<chrono::hours>(hr.timestamp()); };
 
 
    //
@@ -67,7 +76,21 @@ namespace oura_charts
    using HeartRateByMonth      = MapByMonth<HeartRate>;
    using HeartRateByYearMonth  = MapByYearMonth<HeartRate>;
    using HeartRateByYear       = MapByYear<HeartRate>;
-   
+
+
+   //
+   // field descriptors, for use with extractColumn(), aggregateColumn(), writeCsv(), etc.
+   //
+   inline constexpr FieldDescriptor<&HeartRate::beatsPerMin> heartRateBpmField       { "bpm", "bpm" };
+   inline constexpr FieldDescriptor<&HeartRate::source>      heartRateSourceField    { "source" };
+   inline constexpr FieldDescriptor<&HeartRate::timestamp>   heartRateTimestampField { "timestamp" };
+
+   template <>
+   struct ElementFields<HeartRate>
+   {
+      static inline constexpr auto value = std::tuple{ heartRateTimestampField, heartRateBpmField, heartRateSourceField };
+   };
+
 
    /// <summary>
    ///   custom format() support for HeartRate
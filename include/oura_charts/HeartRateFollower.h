@@ -0,0 +1,180 @@
+//---------------------------------------------------------------------------------------------------------------------
+// HeartRateFollower.h
+//
+// Declaration for class HeartRateFollower<>, which keeps a heart-rate series and its running statistics up to date
+// by polling for samples newer than the last one received.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "oura_charts/oura_charts.h"
+#include "oura_charts/chrono_helpers.h"
+#include "oura_charts/functors.h"
+#include "oura_charts/GroupedAggregator.h"
+#include "oura_charts/HeartRate.h"
+#include "oura_charts/detail/instrumentation.h"
+#include "oura_charts/detail/logging.h"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <type_traits>
+
+
+namespace oura_charts::constants
+{
+   // default time HeartRateFollower::follow() waits between polls. The ring only syncs every few minutes, so
+   // polling much more often than this just sends requests that come back empty.
+   inline constexpr std::chrono::seconds HR_FOLLOW_DEFAULT_INTERVAL{ 60 };
+
+   inline constexpr const char* METRIC_HR_FOLLOW_POLLS = "hr_follow.polls";
+   inline constexpr const char* METRIC_HR_FOLLOW_SAMPLES = "hr_follow.samples";
+
+} // namespace oura_charts::constants
+
+
+namespace oura_charts
+{
+   /// <summary>
+   ///   settings for HeartRateFollower
+   /// </summary>
+   struct HeartRateFollowOptions
+   {
+      // time to wait between polls in follow()
+      std::chrono::milliseconds poll_interval{ constants::HR_FOLLOW_DEFAULT_INTERVAL };
+   };
+
+
+   /// <summary>
+   ///   Keeps a HeartRateSeries up to date with new samples as they arrive, along with hourly averages and the
+   ///   min/max over everything received so far.
+   /// </summary>
+   /// <remarks>
+   ///   Each poll only asks for samples newer than the last one received, and only the new samples are added to
+   ///   the statistics, so the cost of a poll depends on how much new data there is rather than on how long the
+   ///   follower has been running. The window starts at the last sample rather than the last poll, so samples
+   ///   the ring syncs late (with timestamps before the previous poll) aren't missed.
+   ///
+   ///   The object isn't thread-safe. follow() runs on the calling thread and calls its callback from there.
+   /// </remarks>
+   template <DataProvider ProviderT>
+   class HeartRateFollower
+   {
+   public:
+      using ProviderType = ProviderT;
+      using HourProjection = std::remove_const_t<decltype(heartRateHour)>;
+      using HourlyAverages = GroupedAggregator<HeartRate, AvgCalc<int>, HourProjection, decltype(&HeartRate::beatsPerMin)>;
+
+      /// <summary>
+      ///   create a follower that collects samples from 'start' (local time) onwards, usually midnight today.
+      /// </summary>
+      HeartRateFollower(ProviderT provider, local_seconds start, HeartRateFollowOptions options = {}) :
+         m_provider{ std::move(provider) },
+         m_options{ options },
+         m_start{ start }
+      {}
+
+      /// <summary>
+      ///   retrieve any samples taken after the last one received (or after the start time if there aren't any
+      ///   yet) and before 'until', adding them to the series and statistics. Returns the number of new samples.
+      /// </summary>
+      size_t poll(local_seconds until) noexcept(false)
+      {
+         static auto& poll_count = instrumentation::counter(constants::METRIC_HR_FOLLOW_POLLS);
+         static auto& sample_count = instrumentation::counter(constants::METRIC_HR_FOLLOW_SAMPLES);
+
+         const auto from = m_last ? *m_last + chrono::seconds{ 1 } : m_start;
+         if (until <= from)
+            return 0;
+
+         poll_count.add();
+         auto new_samples = getDataSeries<HeartRate>(m_provider, from, until);
+
+         size_t added{};
+         for (auto& hr : new_samples)
+         {
+            // the series is sorted, so this only skips anything the server sent from before the window.
+            if (m_last and hr.timestamp() <= *m_last)
+               continue;
+
+            m_hourly(hr);
+            m_min(hr.beatsPerMin());
+            m_max(hr.beatsPerMin());
+            m_last = hr.timestamp();
+            m_series.push_back(std::move(hr));
+            ++added;
+         }
+         sample_count.add(added);
+         return added;
+      }
+
+      /// <summary>
+      ///   poll for samples up to the current time.
+      /// </summary>
+      size_t poll() noexcept(false)
+      {
+         return poll(chrono::floor<chrono::seconds>(localNow()));
+      }
+
+      /// <summary>
+      ///   poll every poll_interval until a stop is requested, calling on_update(*this, new_sample_count) after
+      ///   each poll that returned new samples.
+      /// </summary>
+      /// <remarks>
+      ///   A failed poll is logged and retried at the next interval, so a dropped connection doesn't end the
+      ///   session. Exceptions thrown by the callback are not caught.
+      /// </remarks>
+      template <typename CallbackT> requires std::invocable<CallbackT&, const HeartRateFollower&, size_t>
+      void follow(std::stop_token stop, CallbackT&& on_update)
+      {
+         std::mutex mutex{};
+         std::condition_variable_any wakeup{};
+         while (!stop.stop_requested())
+         {
+            try
+            {
+               if (auto added = poll(); added > 0)
+                  std::invoke(on_update, std::as_const(*this), added);
+            }
+            catch (oura_exception& e)
+            {
+               logging::exception("HeartRateFollower - poll failed", e);
+            }
+
+            std::unique_lock lock{ mutex };
+            wakeup.wait_for(lock, stop, m_options.poll_interval, [] { return false; });
+         }
+      }
+
+      // every sample received so far, in timestamp order.
+      [[nodiscard]] const HeartRateSeries& series() const noexcept { return m_series; }
+
+      // timestamp of the most recent sample, or empty if there haven't been any.
+      [[nodiscard]] const std::optional<local_seconds>& lastTimestamp() const noexcept { return m_last; }
+
+      // average bpm for each (local) hour that has samples.
+      [[nodiscard]] const HourlyAverages& hourlyAverages() const noexcept { return m_hourly; }
+
+      // lowest/highest bpm received so far, empty if there haven't been any samples.
+      [[nodiscard]] const std::optional<int>& minBpm() const noexcept { return m_min.result(); }
+      [[nodiscard]] const std::optional<int>& maxBpm() const noexcept { return m_max.result(); }
+
+      [[nodiscard]] const HeartRateFollowOptions& options() const noexcept { return m_options; }
+      [[nodiscard]] const ProviderT& provider() const noexcept { return m_provider; }
+
+   private:
+      ProviderT m_provider;
+      HeartRateFollowOptions m_options;
+      local_seconds m_start;
+      std::optional<local_seconds> m_last{};
+      HeartRateSeries m_series{};
+      HourlyAverages m_hourly{ heartRateHour, &HeartRate::beatsPerMin };
+      MinCalc<int> m_min{};
+      MaxCalc<int> m_max{};
+   };
+
+} // namespace oura_charts
@@ -0,0 +1,370 @@
+//---------------------------------------------------------------------------------------------------------------------
+// MultiAccountFetcher.h
+//
+// Declaration for class MultiAccountFetcher<>, which retrieves the same data series for many accounts at once,
+// sharing a fixed number of connections between them.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "oura_charts/oura_charts.h"
+#include "oura_charts/DataSeries.h"
+#include "oura_charts/RequestScheduler.h"
+#include "oura_charts/RestDataProvider.h"
+#include "oura_charts/ThreadPool.h"
+#include "oura_charts/TokenAuth.h"
+#include "oura_charts/detail/instrumentation.h"
+#include "oura_charts/detail/logging.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+
+namespace oura_charts::constants
+{
+   // default number of requests a MultiAccountFetcher will have in flight at once, across all accounts.
+   inline constexpr size_t MULTI_FETCH_DEFAULT_CONNECTIONS = 8;
+
+   inline constexpr const char* METRIC_MULTI_FETCH = "multi_fetch.run";
+   inline constexpr const char* METRIC_MULTI_FETCH_ACCOUNTS = "multi_fetch.accounts";
+   inline constexpr const char* METRIC_MULTI_FETCH_FAILED = "multi_fetch.failed_accounts";
+
+} // namespace oura_charts::constants
+
+
+namespace oura_charts
+{
+   /// <summary>
+   ///   settings for MultiAccountFetcher
+   /// </summary>
+   struct MultiFetchOptions
+   {
+      // max number of requests in flight at once, across all accounts.
+      size_t max_connections{ constants::MULTI_FETCH_DEFAULT_CONNECTIONS };
+   };
+
+
+   /// <summary>
+   ///   counts returned by MultiAccountFetcher::fetch()
+   /// </summary>
+   struct MultiFetchSummary
+   {
+      size_t accounts{};
+      size_t failed_accounts{};
+      size_t requests{};
+   };
+
+
+   /// <summary>
+   ///   result delivered for each account, the account's series or the error that stopped it from being retrieved.
+   /// </summary>
+   template <DataSeriesElement ElementT>
+   using AccountSeriesResult = expected<DataSeries<ElementT>, oura_exception>;
+
+
+   /// <summary>
+   ///   concept for a callable that receives the result for each account from MultiAccountFetcher::fetch()
+   /// </summary>
+   template <typename SinkT, typename ElementT>
+   concept AccountSeriesSink = std::invocable<SinkT&, std::string_view, AccountSeriesResult<ElementT>&&>;
+
+
+   /// <summary>
+   ///   Retrieves a data series for each of a set of accounts, each with its own data provider (and so its own
+   ///   access token and rate limit), while sharing a fixed number of connections between them.
+   /// </summary>
+   /// <remarks>
+   ///   Accounts take turns: each one sends a single request and then goes to the back of the line until its
+   ///   turn comes round again, so an account with a lot of pages doesn't hold up the others. An account whose
+   ///   RequestScheduler is out of budget (or backing off after being throttled) is skipped until it's ready,
+   ///   rather than tying up a connection while it waits. Providers that don't have a scheduler() are always
+   ///   considered ready.
+   ///
+   ///   Requests are sent from max_connections threads owned by the fetcher, since they spend most of their time
+   ///   blocked on the network; the pages are parsed on the ThreadPool while the next requests are in flight.
+   ///   One account failing doesn't affect the others, its error is passed to the sink in place of the series.
+   /// </remarks>
+   template <DataProvider ProviderT>
+   class MultiAccountFetcher
+   {
+   public:
+      using ProviderType = ProviderT;
+
+      explicit MultiAccountFetcher(MultiFetchOptions options = {}, ThreadPool& pool = ThreadPool::shared()) :
+         m_options{ options },
+         m_pool{ pool }
+      {}
+
+      /// <summary>
+      ///   add an account to be included in each fetch. The id is passed to the sink along with the account's result.
+      /// </summary>
+      void addAccount(std::string id, ProviderT provider)
+      {
+         m_accounts.emplace_back(std::move(id), std::move(provider));
+      }
+
+      [[nodiscard]] size_t accountCount() const noexcept { return m_accounts.size(); }
+      [[nodiscard]] const MultiFetchOptions& options() const noexcept { return m_options; }
+
+      /// <summary>
+      ///   retrieve the series for the given (inclusive) date range for every account, passing each account's
+      ///   result to the sink as soon as it's complete.
+      /// </summary>
+      template <DataSeriesElement ElementT, AccountSeriesSink<ElementT> SinkT>
+      MultiFetchSummary fetch(chrono::year_month_day from, chrono::year_month_day thru, SinkT&& sink) noexcept(false)
+      {
+         return fetch<ElementT>(detail::dateRangeParams<ElementT>(from, thru), std::forward<SinkT>(sink));
+      }
+
+      /// <summary>
+      ///   retrieve the series for the specified REST params for every account, passing each account's result
+      ///   to the sink as soon as it's complete.
+      /// </summary>
+      /// <remarks>
+      ///   Calls to the sink are never made concurrently, so it can update shared state without locking, but they
+      ///   are made from the fetcher's threads and in the order the accounts finish. If the sink throws, the
+      ///   remaining accounts are still fetched and the first exception is rethrown once they're done.
+      /// </remarks>
+      template <DataSeriesElement ElementT, AccountSeriesSink<ElementT> SinkT>
+      MultiFetchSummary fetch(const detail::SortedPropertyMap& params, SinkT&& sink) noexcept(false)
+      {
+         static auto& fetch_timer = instrumentation::timer(constants::METRIC_MULTI_FETCH);
+         static auto& account_count = instrumentation::counter(constants::METRIC_MULTI_FETCH_ACCOUNTS);
+         static auto& failed_count = instrumentation::counter(constants::METRIC_MULTI_FETCH_FAILED);
+         instrumentation::ScopedTimer timer{ fetch_timer };
+
+         MultiFetchSummary summary{ .accounts = m_accounts.size() };
+         if (m_accounts.empty())
+            return summary;
+
+         // deque because jobs can't be moved once their parse tasks are running.
+         std::deque<AccountJob<ElementT>> jobs{};
+         FetchQueue<ElementT> queue{};
+         for (const auto& account : m_accounts)
+         {
+            auto& job = jobs.emplace_back(account, params, m_pool);
+            queue.ready.push_back(&job);
+         }
+         queue.active = jobs.size();
+
+         std::mutex sink_mutex{};
+         std::exception_ptr sink_error{};
+         auto deliver = [&] (AccountJob<ElementT>& job)
+                        {
+                           auto result = job.finish();
+                           std::lock_guard lock{ sink_mutex };
+                           if (!result)
+                           {
+                              ++summary.failed_accounts;
+                              failed_count.add();
+                              logging::exception(fmt::format("MultiAccountFetcher - account '{}'", job.account.id), result.error());
+                           }
+                           try
+                           {
+                              std::invoke(sink, std::string_view{ job.account.id }, std::move(result));
+                           }
+                           catch (...)
+                           {
+                              if (!sink_error)
+                                 sink_error = std::current_exception();
+                           }
+                        };
+
+         {
+            const auto connection_count = std::clamp<size_t>(m_options.max_connections, 1, jobs.size());
+            std::vector<std::jthread> connections{};
+            connections.reserve(connection_count);
+            for (size_t i = 0; i < connection_count; ++i)
+            {
+               connections.emplace_back([&queue, &deliver]
+                                        {
+                                           while (auto* job = queue.nextReadyJob())
+                                           {
+                                              const bool more = job->fetchNextPage();
+                                              queue.requeue(job, more);
+                                              if (!more)
+                                                 deliver(*job);
+                                           }
+                                        });
+            }
+         }
+
+         account_count.add(summary.accounts);
+         summary.requests = queue.requests;
+         if (sink_error)
+            std::rethrow_exception(sink_error);
+
+         return summary;
+      }
+
+   private:
+      struct Account
+      {
+         std::string id{};
+         ProviderT provider;
+
+         Account(std::string account_id, ProviderT account_provider) : id{ std::move(account_id) }, provider{ std::move(account_provider) }
+         {}
+      };
+
+
+      // state for retrieving one account's series during a call to fetch()
+      template <DataSeriesElement ElementT>
+      struct AccountJob
+      {
+         using JsonCollectionT = detail::RestDataCollection<typename ElementT::StorageType>;
+
+         const Account& account;
+         detail::SortedPropertyMap params;
+         nullable_string next_token{};
+         std::deque<JsonCollectionT> pages{};
+         std::optional<oura_exception> error{};
+         TaskGroup parse_tasks;   // declared after pages, so it waits for the tasks before the pages go away
+
+         AccountJob(const Account& job_account, detail::SortedPropertyMap job_params, ThreadPool& pool) :
+            account{ job_account },
+            params{ std::move(job_params) },
+            parse_tasks{ pool }
+         {}
+
+         // how long until the account's rate limit allows another request
+         [[nodiscard]] RequestScheduler::clock::duration timeUntilReady() const
+         {
+            if constexpr (requires { account.provider.scheduler()->timeUntilReady(); })
+               return account.provider.scheduler()->timeUntilReady();
+            else
+               return RequestScheduler::clock::duration::zero();
+         }
+
+         // request the next page and queue it to be parsed, returns true if there are more pages to get.
+         bool fetchNextPage()
+         {
+            if (next_token)
+               params[constants::REST_PARAM_NEXT_TOKEN] = std::move(*next_token);
+
+            // providers take the params as an rvalue, but we need to keep ours for the next page.
+            auto json_res = account.provider.getJsonData(ElementT::REST_PATH, detail::SortedPropertyMap{ params });
+            if (!json_res)
+            {
+               error = std::move(json_res.error());
+               return false;
+            }
+
+            auto token_res = detail::readNextToken(json_res.value());
+            if (!token_res)
+            {
+               error = std::move(token_res.error());
+               return false;
+            }
+            next_token = std::move(token_res.value());
+
+            parse_tasks.run([&page = pages.emplace_back(), json = std::move(json_res.value())]
+                            {
+                               auto data_res = detail::readJson<JsonCollectionT>(json);
+                               if (!data_res)
+                                  throw oura_exception{ std::move(data_res.error()) };
+
+                               page = std::move(data_res.value());
+                            });
+            return next_token.has_value();
+         }
+
+         // wait for the pages to be parsed and build the series from them.
+         [[nodiscard]] AccountSeriesResult<ElementT> finish()
+         {
+            try
+            {
+               parse_tasks.wait();
+               if (error)
+                  return unexpected{ std::move(*error) };
+
+               return detail::joinPages<ElementT>(pages);
+            }
+            catch (oura_exception& e)
+            {
+               return unexpected{ std::move(e) };
+            }
+            catch (std::exception& e)
+            {
+               return unexpected{ oura_exception{ e.what() } };
+            }
+         }
+      };
+
+
+      // the accounts waiting for their turn to send a request, shared by the connection threads
+      template <DataSeriesElement ElementT>
+      struct FetchQueue
+      {
+         std::mutex mutex{};
+         std::condition_variable cv{};
+         std::deque<AccountJob<ElementT>*> ready{};   // guarded by mutex
+         size_t active{};                             // guarded by mutex, accounts that still have requests to send
+         size_t requests{};                           // guarded by mutex
+
+         // take the first account in line that's allowed to send a request, waiting if none are. Returns
+         // nullptr once every account has finished.
+         AccountJob<ElementT>* nextReadyJob()
+         {
+            std::unique_lock lock{ mutex };
+            while (active > 0)
+            {
+               auto wait = RequestScheduler::clock::duration::max();
+               for (auto it = ready.begin(); it != ready.end(); ++it)
+               {
+                  auto job_wait = (*it)->timeUntilReady();
+                  if (job_wait <= RequestScheduler::clock::duration::zero())
+                  {
+                     auto* job = *it;
+                     ready.erase(it);
+                     ++requests;
+                     return job;
+                  }
+                  wait = std::min(wait, job_wait);
+               }
+
+               // if nobody is waiting for their turn, the remaining accounts all have a request in flight and
+               // we'll be woken when one of them finishes.
+               if (ready.empty())
+                  cv.wait(lock);
+               else
+                  cv.wait_for(lock, wait);
+            }
+            return nullptr;
+         }
+
+         // put an account back in line after its request, or retire it if it has no more to send.
+         void requeue(AccountJob<ElementT>* job, bool more)
+         {
+            {
+               std::lock_guard lock{ mutex };
+               if (more)
+                  ready.push_back(job);
+               else
+                  --active;
+            }
+            cv.notify_all();
+         }
+      };
+
+      MultiFetchOptions m_options{};
+      ThreadPool& m_pool;
+      std::vector<Account> m_accounts{};
+   };
+
+
+   /// <summary>
+   ///   fetcher for accounts accessed through the REST API with personal access tokens. Each RestDataProvider
+   ///   creates its own RequestScheduler by default, which gives each token its own rate budget.
+   /// </summary>
+   using RestAccountFetcher = MultiAccountFetcher<RestDataProvider<TokenAuth>>;
+
+} // namespace oura_charts
@@ -0,0 +1,228 @@
+//---------------------------------------------------------------------------------------------------------------------
+// RangePrefetcher.h
+//
+// Declaration for class RangePrefetcher, which fetches date ranges the user is likely to look at next into a
+// ResponseCache in the background.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "oura_charts/oura_charts.h"
+#include "oura_charts/chrono_helpers.h"
+#include "oura_charts/DataSeries.h"
+#include "oura_charts/ResponseCache.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace oura_charts::constants
+{
+   // default amount of response data a RangePrefetcher will add to the cache for one call to prefetch().
+   inline constexpr size_t PREFETCH_DEFAULT_MAX_BYTES = 8ull * 1024 * 1024;
+
+   inline constexpr const char* METRIC_PREFETCH_PAGES = "prefetch.pages";
+   inline constexpr const char* METRIC_PREFETCH_BYTES = "prefetch.bytes";
+   inline constexpr const char* METRIC_PREFETCH_CANCELLED = "prefetch.cancelled";
+
+} // namespace oura_charts::constants
+
+
+namespace oura_charts
+{
+   /// <summary>
+   ///   an inclusive range of calendar dates
+   /// </summary>
+   struct DateRange
+   {
+      year_month_day from{};
+      year_month_day thru{};
+
+      bool operator==(const DateRange&) const = default;
+   };
+
+
+   /// <summary>
+   ///   returns the ranges immediately before and after 'range', which is what "previous" and "next" would show.
+   ///   A range of whole calendar months moves by the same number of months, anything else moves by the same
+   ///   number of days.
+   /// </summary>
+   [[nodiscard]] std::pair<DateRange, DateRange> adjacentRanges(const DateRange& range);
+
+
+   /// <summary>
+   ///   settings for RangePrefetcher
+   /// </summary>
+   struct PrefetchOptions
+   {
+      // most response data one call to prefetch() will fetch, so speculative requests can't push everything
+      // else out of the cache. The page that crosses the limit is still fetched.
+      size_t max_bytes{ constants::PREFETCH_DEFAULT_MAX_BYTES };
+   };
+
+
+   /// <summary>
+   ///   counts of what a RangePrefetcher has done since it was created.
+   /// </summary>
+   struct PrefetchStats
+   {
+      size_t ranges{};        // ranges fetched completely
+      size_t pages{};         // pages requested
+      size_t bytes{};         // total size of the pages requested
+      size_t cancelled{};     // ranges dropped (before or part way through) because of a later prefetch() or cancel()
+      size_t over_budget{};   // ranges dropped because max_bytes was reached
+      size_t failed{};        // ranges that stopped because of an error
+   };
+
+
+   /// <summary>
+   ///   Fetches date ranges in the background so that they're already cached when they're asked for, eg the
+   ///   previous and next month of whatever a chart is showing.
+   /// </summary>
+   /// <remarks>
+   ///   Requests go through a CachingDataProvider, so they land in its ResponseCache under the same keys a normal
+   ///   getDataSeries() call for the same range would use. Only each page's next_token is read, the records
+   ///   aren't parsed until someone actually asks for them.
+   ///
+   ///   Prefetching is low priority: there's a single background thread that sends one request at a time, and it
+   ///   doesn't start a request while any ForegroundScope is alive, so work the user is waiting for doesn't have to
+   ///   share the connection or rate limit with it. Each call to prefetch() replaces whatever hadn't been fetched
+   ///   yet (including the rest of a partly fetched range), since the user has moved on and those ranges are no
+   ///   longer the likely next ones. Errors are logged and otherwise ignored.
+   ///
+   ///   All methods are thread-safe.
+   /// </remarks>
+   class RangePrefetcher
+   {
+   public:
+      using JsonResult = expected<std::string, oura_exception>;
+      using FetchFunc = std::function<JsonResult(std::string_view path, const detail::SortedPropertyMap& params)>;
+
+      /// <summary>
+      ///   create a prefetcher that fills the cache of the given provider.
+      /// </summary>
+      template <DataProvider ProviderT>
+      explicit RangePrefetcher(CachingDataProvider<ProviderT> provider, PrefetchOptions options = {}) :
+         RangePrefetcher{ [provider = std::move(provider)] (std::string_view path, const detail::SortedPropertyMap& params)
+                          {
+                             return provider.getJsonData(path, detail::SortedPropertyMap{ params });
+                          },
+                          options }
+      {}
+
+      /// <summary>
+      ///   create a prefetcher that uses 'fetch' to request each page. Since the responses are discarded, fetch
+      ///   should be storing them somewhere.
+      /// </summary>
+      explicit RangePrefetcher(FetchFunc fetch, PrefetchOptions options = {});
+
+      /// <summary>
+      ///   destructor cancels any prefetching that's in progress, but waits for a request that's already been sent.
+      /// </summary>
+      ~RangePrefetcher();
+
+      /// <summary>
+      ///   start fetching the given ranges for ElementT, replacing any that are still pending from a previous call.
+      /// </summary>
+      template <DataSeriesElement ElementT>
+      void prefetch(std::initializer_list<DateRange> ranges)
+      {
+         std::vector<Request> requests{};
+         requests.reserve(ranges.size());
+         for (const auto& range : ranges)
+         {
+            requests.emplace_back(std::string{ ElementT::REST_PATH }, detail::dateRangeParams<ElementT>(range.from, range.thru));
+         }
+         enqueue(std::move(requests));
+      }
+
+      /// <summary>
+      ///   drop anything that hasn't been fetched yet. A request that's already been sent will still complete.
+      /// </summary>
+      void cancel();
+
+      /// <summary>
+      ///   block until there's nothing left to prefetch.
+      /// </summary>
+      void waitIdle();
+
+      [[nodiscard]] PrefetchStats stats() const;
+      [[nodiscard]] const PrefetchOptions& options() const noexcept { return m_options; }
+
+      /// <summary>
+      ///   while one of these is alive the prefetcher won't send any requests. Create one around fetches the user
+      ///   is waiting for.
+      /// </summary>
+      class ForegroundScope
+      {
+      public:
+         explicit ForegroundScope(RangePrefetcher& prefetcher);
+         ~ForegroundScope();
+
+         ForegroundScope(ForegroundScope&& other) noexcept : m_prefetcher{ std::exchange(other.m_prefetcher, nullptr) } {}
+         ForegroundScope(const ForegroundScope&) = delete;
+         ForegroundScope& operator=(const ForegroundScope&) = delete;
+         ForegroundScope& operator=(ForegroundScope&&) = delete;
+
+      private:
+         RangePrefetcher* m_prefetcher;
+      };
+
+      [[nodiscard]] ForegroundScope foreground() { return ForegroundScope{ *this }; }
+
+      // object is not copyable or movable, since the worker thread holds a pointer to it.
+      RangePrefetcher(const RangePrefetcher&) = delete;
+      RangePrefetcher(RangePrefetcher&&) = delete;
+      RangePrefetcher& operator=(const RangePrefetcher&) = delete;
+      RangePrefetcher& operator=(RangePrefetcher&&) = delete;
+
+   private:
+      struct Request
+      {
+         std::string path{};
+         detail::SortedPropertyMap params{};
+      };
+
+      enum class Outcome
+      {
+         Completed,
+         Cancelled,
+         OverBudget,
+         Failed
+      };
+
+      FetchFunc m_fetch;
+      const PrefetchOptions m_options;
+
+      mutable std::mutex m_mutex{};
+      std::condition_variable_any m_wakeup{};   // worker waits on this for work, or for the foreground to finish
+      std::condition_variable m_idle{};         // waitIdle() waits on this
+      std::deque<Request> m_queue{};            // guarded by m_mutex
+      uint64_t m_generation{};                  // guarded by m_mutex, incremented by each prefetch()/cancel()
+      size_t m_generation_bytes{};              // guarded by m_mutex, bytes fetched for the current generation
+      size_t m_foreground{};                    // guarded by m_mutex, number of live ForegroundScopes
+      bool m_busy{};                            // guarded by m_mutex, worker is fetching a range
+      PrefetchStats m_stats{};                  // guarded by m_mutex
+
+      // declared last so the thread starts after everything it uses has been initialized.
+      std::jthread m_worker;
+
+      void enqueue(std::vector<Request> requests);
+      void run(std::stop_token stop);
+
+      // must be called with lock held, which is released while each page is requested.
+      Outcome fetchRange(std::unique_lock<std::mutex>& lock, std::stop_token stop, Request& request, uint64_t generation);
+   };
+
+} // namespace oura_charts
@@ -0,0 +1,250 @@
+//---------------------------------------------------------------------------------------------------------------------
+// ReplayDataProvider.h
+//
+// Declaration for RecordingDataProvider<>, which saves the responses from another data provider to disk, and
+// ReplayDataProvider, which serves a saved recording so the same traffic can be replayed offline.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "oura_charts/oura_charts.h"
+#include "oura_charts/detail/instrumentation.h"
+#include "oura_charts/detail/logging.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+
+namespace oura_charts::constants
+{
+   // name of the index file in a recording folder, which has one line of JSON per recorded response.
+   inline constexpr const char* RECORDING_INDEX_FILE = "requests.jsonl";
+
+   inline constexpr const char* METRIC_RECORDING_RESPONSES = "recording.responses";
+   inline constexpr const char* METRIC_REPLAY_REQUESTS = "replay.requests";
+   inline constexpr const char* METRIC_REPLAY_MISSES = "replay.misses";
+
+} // namespace oura_charts::constants
+
+
+namespace oura_charts
+{
+   namespace fs = std::filesystem;
+
+
+   /// <summary>
+   ///   Saves responses to a recording folder: each body goes in its own file exactly as it was received, and a
+   ///   line describing the request (path, params, latency and body file) is appended to the folder's index.
+   /// </summary>
+   /// <remarks>
+   ///   Creating a writer starts a new recording, replacing the index and responses of any previous recording in
+   ///   the folder.
+   ///   Each response is flushed to disk as soon as it's written, so an interrupted session still leaves a
+   ///   usable recording. All methods are thread-safe.
+   /// </remarks>
+   class RecordingWriter
+   {
+   public:
+      using ParamMap = std::map<std::string, std::string>;
+
+      /// <summary>
+      ///   create the folder if necessary and start a new recording in it. Throws if it can't be written to.
+      /// </summary>
+      explicit RecordingWriter(const fs::path& folder) noexcept(false);
+
+      /// <summary>
+      ///   save a response. Throws if it can't be written.
+      /// </summary>
+      void write(std::string_view path, const ParamMap& params, std::string_view body, std::chrono::microseconds latency) noexcept(false);
+
+      // number of responses written so far.
+      [[nodiscard]] size_t count() const;
+
+      [[nodiscard]] const fs::path& folder() const noexcept { return m_folder; }
+
+      // object is not copyable or movable, since it's shared between copies of a RecordingDataProvider.
+      RecordingWriter(const RecordingWriter&) = delete;
+      RecordingWriter(RecordingWriter&&) = delete;
+      RecordingWriter& operator=(const RecordingWriter&) = delete;
+      RecordingWriter& operator=(RecordingWriter&&) = delete;
+      ~RecordingWriter() = default;
+
+   private:
+      fs::path m_folder;
+      mutable std::mutex m_mutex{};
+      std::ofstream m_index{};   // guarded by m_mutex
+      size_t m_count{};          // guarded by m_mutex
+   };
+
+
+   /// <summary>
+   ///   Decorator that passes requests through to another data provider and saves every successful response to
+   ///   a recording folder, so it can be replayed later with ReplayDataProvider.
+   /// </summary>
+   /// <remarks>
+   ///   Wrap a RestDataProvider in one of these to capture real traffic once, then replay it as often as needed to
+   ///   measure the parsing and aggregation code against production payloads, without the network or rate limits
+   ///   getting in the way. Failed requests aren't recorded. A response that can't be saved is logged, and still
+   ///   returned to the caller.
+   ///
+   ///   Copies share the same recording, and it's safe to make requests from multiple threads if the wrapped
+   ///   provider is.
+   /// </remarks>
+   template <DataProvider ProviderT>
+   class RecordingDataProvider
+   {
+   public:
+      using JsonResult = expected<std::string, oura_exception>;
+
+      /// <summary>
+      ///   create a provider that records the responses from 'provider' into 'folder'. Throws if the recording
+      ///   can't be created.
+      /// </summary>
+      RecordingDataProvider(ProviderT provider, const fs::path& folder) noexcept(false) :
+         m_provider{ std::move(provider) },
+         m_writer{ std::make_shared<RecordingWriter>(folder) }
+      {}
+
+      [[nodiscard]] JsonResult getJsonData(std::string_view path) const noexcept
+      {
+         return record(path, RecordingWriter::ParamMap{}, [this, path] { return m_provider.getJsonData(path); });
+      }
+
+      template<KeyValueRange MapT>
+      [[nodiscard]] JsonResult getJsonData(std::string_view path, MapT&& param_map) const noexcept
+      {
+         RecordingWriter::ParamMap params{};
+         for (auto&& [name, value] : param_map)
+         {
+            params.emplace(std::string_view{ name }, std::string_view{ value });
+         }
+         return record(path, params, [this, path, &params] { return m_provider.getJsonData(path, RecordingWriter::ParamMap{ params }); });
+      }
+
+      [[nodiscard]] const ProviderT& provider() const noexcept { return m_provider; }
+      [[nodiscard]] const std::shared_ptr<RecordingWriter>& writer() const noexcept { return m_writer; }
+
+   private:
+      ProviderT m_provider;
+      std::shared_ptr<RecordingWriter> m_writer;
+
+      template <typename FetchT>
+      [[nodiscard]] JsonResult record(std::string_view path, const RecordingWriter::ParamMap& params, FetchT&& fetch) const noexcept
+      {
+         static auto& response_count = instrumentation::counter(constants::METRIC_RECORDING_RESPONSES);
+
+         const auto start = std::chrono::steady_clock::now();
+         JsonResult json_res = fetch();
+         const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+         if (!json_res)
+            return json_res;
+
+         try
+         {
+            m_writer->write(path, params, json_res.value(), latency);
+            response_count.add();
+         }
+         catch (oura_exception& e)
+         {
+            logging::exception("RecordingDataProvider - unable to record response", e);
+         }
+         catch (std::exception& e)
+         {
+            logging::exception("RecordingDataProvider - unable to record response", oura_exception{ e.what() });
+         }
+         return json_res;
+      }
+   };
+
+
+   /// <summary>
+   ///   how ReplayDataProvider paces its responses.
+   /// </summary>
+   enum class ReplayTiming
+   {
+      MemorySpeed,      // return each response immediately
+      RecordedLatency   // wait as long as the original request took before returning its response
+   };
+
+
+   /// <summary>
+   ///   settings for ReplayDataProvider
+   /// </summary>
+   struct ReplayOptions
+   {
+      ReplayTiming timing{ ReplayTiming::MemorySpeed };
+
+      // if true a request only matches a response recorded with exactly the same params. If false only the path
+      // and next_token have to match (the same way TestDataProvider looks up data), so a recording can be replayed
+      // by code that asks for different dates, eg a range relative to the current date.
+      bool match_params{ true };
+   };
+
+
+   /// <summary>
+   ///   Data provider that serves the responses saved by a RecordingDataProvider, so the same traffic can be
+   ///   replayed offline and reproducibly.
+   /// </summary>
+   /// <remarks>
+   ///   The whole recording is loaded into memory up front, so by default requests are served at memory speed and
+   ///   benchmarks only measure the code that processes the responses. ReplayTiming::RecordedLatency adds the
+   ///   original network time back in, for measuring end-to-end behavior. A request that wasn't recorded gets an
+   ///   error. If the same request was recorded more than once, the last response is used.
+   ///
+   ///   Copies share the loaded recording, and all methods are thread-safe.
+   /// </remarks>
+   class ReplayDataProvider
+   {
+   public:
+      using JsonResult = expected<std::string, oura_exception>;
+      using ParamMap = std::map<std::string, std::string>;
+
+      /// <summary>
+      ///   load the recording in 'folder'. Throws if it can't be read.
+      /// </summary>
+      explicit ReplayDataProvider(const fs::path& folder, ReplayOptions options = {}) noexcept(false);
+
+      [[nodiscard]] JsonResult getJsonData(std::string_view path) const noexcept
+      {
+         return replay(path, ParamMap{});
+      }
+
+      template<KeyValueRange MapT>
+      [[nodiscard]] JsonResult getJsonData(std::string_view path, MapT&& param_map) const noexcept
+      {
+         ParamMap params{};
+         for (auto&& [name, value] : param_map)
+         {
+            params.emplace(std::string_view{ name }, std::string_view{ value });
+         }
+         return replay(path, params);
+      }
+
+      // number of distinct responses in the recording.
+      [[nodiscard]] size_t size() const noexcept { return m_responses->size(); }
+
+      [[nodiscard]] const ReplayOptions& options() const noexcept { return m_options; }
+
+   private:
+      struct Response
+      {
+         std::string body{};
+         std::chrono::microseconds latency{};
+      };
+      using ResponseMap = std::map<std::string, Response, std::less<>>;
+
+      std::shared_ptr<const ResponseMap> m_responses;
+      ReplayOptions m_options;
+
+      [[nodiscard]] std::string makeKey(std::string_view path, const ParamMap& params) const;
+      [[nodiscard]] JsonResult replay(std::string_view path, const ParamMap& params) const noexcept;
+   };
+
+} // namespace oura_charts
@@ -0,0 +1,154 @@
+//---------------------------------------------------------------------------------------------------------------------
+// RequestScheduler.h
+//
+// Declaration for class RequestScheduler, which paces and retries REST requests so we stay under the server's rate
+// limit and recover from throttling/transient errors.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "oura_charts/oura_charts.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string_view>
+
+
+namespace oura_charts::constants
+{
+   // The Oura API allows 5000 requests per 5 minute period.
+   inline constexpr double REST_DEFAULT_REQUESTS_PER_SECOND = 5000.0 / 300.0;
+   inline constexpr double REST_DEFAULT_BURST = 10.0;
+
+   inline constexpr int REST_DEFAULT_MAX_ATTEMPTS = 5;
+   inline constexpr std::chrono::milliseconds REST_DEFAULT_INITIAL_BACKOFF{ 500 };
+   inline constexpr std::chrono::milliseconds REST_DEFAULT_MAX_BACKOFF{ 30'000 };
+   inline constexpr double REST_DEFAULT_BACKOFF_MULTIPLIER = 2.0;
+   inline constexpr double REST_DEFAULT_BACKOFF_JITTER = 0.5;
+
+   inline constexpr const char* REST_HEADER_RETRY_AFTER = "Retry-After";
+
+   inline constexpr const char* METRIC_REST_RETRIES = "rest.retries";
+   inline constexpr const char* METRIC_REST_THROTTLED = "rest.throttled";
+   inline constexpr const char* METRIC_REST_RATE_WAIT = "rest.rate_wait";
+
+} // namespace oura_charts::constants
+
+
+namespace oura_charts
+{
+   /// <summary>
+   ///   token bucket settings. requests_per_second is the sustained rate, burst is how many requests can
+   ///   be sent back-to-back after a quiet period.
+   /// </summary>
+   struct RateLimit
+   {
+      double requests_per_second{ constants::REST_DEFAULT_REQUESTS_PER_SECOND };
+      double burst{ constants::REST_DEFAULT_BURST };
+   };
+
+
+   /// <summary>
+   ///   settings for retrying failed requests. The delay before retry N is
+   ///   min(max_backoff, initial_backoff * multiplier^(N-1)), reduced by a random amount up to 'jitter'
+   ///   (0.0 - 1.0) of itself so that multiple clients don't retry in lock-step.
+   /// </summary>
+   struct RetryPolicy
+   {
+      int max_attempts{ constants::REST_DEFAULT_MAX_ATTEMPTS };
+      std::chrono::milliseconds initial_backoff{ constants::REST_DEFAULT_INITIAL_BACKOFF };
+      std::chrono::milliseconds max_backoff{ constants::REST_DEFAULT_MAX_BACKOFF };
+      double multiplier{ constants::REST_DEFAULT_BACKOFF_MULTIPLIER };
+      double jitter{ constants::REST_DEFAULT_BACKOFF_JITTER };
+   };
+
+
+   /// <summary>
+   ///   Paces outgoing REST requests with a token bucket, and decides whether/when a failed request
+   ///   should be retried.
+   /// </summary>
+   /// <remarks>
+   ///   The rate adapts to the server: a 429 response halves the current rate and pauses all requests
+   ///   until the Retry-After time has passed, and each successful response raises the rate back towards
+   ///   the configured limit. That keeps throughput close to the limit without repeatedly hitting it.
+   ///
+   ///   One scheduler should be shared by everything that uses the same access token, since that's what
+   ///   the server's rate limit applies to. All methods are thread-safe.
+   /// </remarks>
+   class RequestScheduler
+   {
+   public:
+      using clock = std::chrono::steady_clock;
+
+      explicit RequestScheduler(RateLimit limit = {}, RetryPolicy policy = {});
+
+      /// <summary>
+      ///   Blocks until the caller is allowed to send a request.
+      /// </summary>
+      void acquire();
+
+      /// <summary>
+      ///   how long until acquire() would return without blocking, or zero if a request can be sent now.
+      ///   Doesn't use up any of the budget, so callers juggling several schedulers can pick one that's ready.
+      /// </summary>
+      [[nodiscard]] clock::duration timeUntilReady();
+
+      /// <summary>
+      ///   Report the result of a request, and find out whether it should be retried.
+      /// </summary>
+      /// <param name="status_code">HTTP status of the response, or 0 if the request failed without a response.</param>
+      /// <param name="retry_after">value of the Retry-After header, if any.</param>
+      /// <param name="attempt">1-based count of attempts made so far for this request.</param>
+      /// <returns>
+      ///   how long to wait before retrying, or nullopt if the request succeeded, failed in a way that
+      ///   retrying won't fix, or has used up its attempts.
+      /// </returns>
+      [[nodiscard]] std::optional<std::chrono::milliseconds> completeRequest(int64_t status_code, std::string_view retry_after, int attempt);
+
+      /// <summary>
+      ///   returns the backoff delay for the specified (1-based) retry attempt, including jitter.
+      /// </summary>
+      [[nodiscard]] std::chrono::milliseconds backoffDelay(int attempt);
+
+      /// <summary>
+      ///   the current (adaptive) request rate, which will never be higher than the configured limit.
+      /// </summary>
+      [[nodiscard]] double currentRate() const;
+
+      const RateLimit& rateLimit() const noexcept     { return m_limit;  }
+      const RetryPolicy& retryPolicy() const noexcept { return m_policy; }
+
+      /// <summary>
+      ///   returns true for HTTP status codes where a retry might succeed: throttling, server errors
+      ///   that are typically transient, and requests that never got a response.
+      /// </summary>
+      [[nodiscard]] static bool isRetryable(int64_t status_code) noexcept;
+
+      /// <summary>
+      ///   parse a Retry-After header value. Only the delay-seconds form is supported, HTTP-date values
+      ///   return nullopt and the normal backoff delay is used instead.
+      /// </summary>
+      [[nodiscard]] static std::optional<std::chrono::seconds> parseRetryAfter(std::string_view retry_after) noexcept;
+
+   private:
+      const RateLimit m_limit;
+      const RetryPolicy m_policy;
+
+      mutable std::mutex m_mutex{};
+      double m_rate{};
+      double m_tokens{};
+      clock::time_point m_last_refill{};
+      clock::time_point m_blocked_until{};
+      std::minstd_rand m_rng;
+
+      // must be called with lock held
+      void refill(clock::time_point now);
+      clock::duration waitTimeLocked(clock::time_point now) const;
+      std::chrono::milliseconds backoffDelayLocked(int attempt);
+   };
+
+} // namespace oura_charts
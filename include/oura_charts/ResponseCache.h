@@ -0,0 +1,252 @@
+//---------------------------------------------------------------------------------------------------------------------
+// ResponseCache.h
+//
+// Declaration for class ResponseCache, an in-memory LRU cache of JSON responses, and CachingDataProvider<> which
+// adds a ResponseCache to any data provider.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "oura_charts/oura_charts.h"
+#include <chrono>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+
+namespace oura_charts::constants
+{
+   inline constexpr size_t RESPONSE_CACHE_DEFAULT_MAX_ENTRIES = 256;
+   inline constexpr size_t RESPONSE_CACHE_DEFAULT_MAX_BYTES = 64ull * 1024 * 1024;
+   inline constexpr std::chrono::seconds RESPONSE_CACHE_DEFAULT_TTL{ 300 };
+
+   inline constexpr const char* METRIC_CACHE_HITS = "cache.hits";
+   inline constexpr const char* METRIC_CACHE_MISSES = "cache.misses";
+   inline constexpr const char* METRIC_CACHE_REVALIDATED = "cache.revalidated";
+   inline constexpr const char* METRIC_CACHE_COALESCED = "cache.coalesced";
+   inline constexpr const char* METRIC_CACHE_EVICTIONS = "cache.evictions";
+
+} // namespace oura_charts::constants
+
+
+namespace oura_charts
+{
+   /// <summary>
+   ///   settings for ResponseCache. A ttl of zero means every lookup revalidates with the server.
+   /// </summary>
+   struct ResponseCacheOptions
+   {
+      size_t max_entries{ constants::RESPONSE_CACHE_DEFAULT_MAX_ENTRIES };
+      size_t max_bytes{ constants::RESPONSE_CACHE_DEFAULT_MAX_BYTES };
+      std::chrono::milliseconds ttl{ constants::RESPONSE_CACHE_DEFAULT_TTL };
+   };
+
+
+   /// <summary>
+   ///   counts of how lookups were handled since the cache was created.
+   /// </summary>
+   struct ResponseCacheStats
+   {
+      size_t hits{};          // served from memory without contacting the server
+      size_t misses{};        // had to ask the server
+      size_t revalidated{};   // asked the server, which said the cached response was still current
+      size_t coalesced{};     // waited for an identical request that was already in flight
+      size_t evictions{};     // removed to stay under max_entries/max_bytes
+   };
+
+
+   /// <summary>
+   ///   In-memory LRU cache of JSON responses, keyed by request path and params.
+   /// </summary>
+   /// <remarks>
+   ///   A response is served from memory until its ttl runs out. After that the next lookup sends a conditional
+   ///   request with the ETag/Last-Modified values from the cached response, and if the server says it hasn't
+   ///   changed the cached copy is used again (and its ttl restarted) without downloading the body.
+   ///
+   ///   Lookups for a key that's already being fetched wait for that request instead of sending their own, so
+   ///   any number of concurrent identical requests result in one call to the server. Errors aren't cached.
+   ///
+   ///   Responses from different accounts must not share a cache, since the key doesn't include the credentials.
+   ///   All methods are thread-safe.
+   /// </remarks>
+   class ResponseCache
+   {
+   public:
+      using clock = std::chrono::steady_clock;
+      using JsonResult = expected<std::string, oura_exception>;
+      using FetchResult = expected<ConditionalResponse, oura_exception>;
+      using FetchFunc = std::function<FetchResult(const ResponseValidators&)>;
+
+      explicit ResponseCache(ResponseCacheOptions options = {});
+
+      /// <summary>
+      ///   Return the response for the key, calling fetch to get (or revalidate) it if there isn't a fresh copy
+      ///   in the cache. fetch is passed the validators from the cached response if there is one, and may be
+      ///   called on another thread's behalf if it's waiting for the same key.
+      /// </summary>
+      [[nodiscard]] JsonResult get(std::string_view key, const FetchFunc& fetch);
+
+      /// <summary>
+      ///   remove the entry for a key, or all entries.
+      /// </summary>
+      /// <remarks>
+      ///   clear() also forgets any fetches that are in progress, so their responses aren't stored when they
+      ///   arrive and later lookups don't wait for them. Use it when the credentials change, so nothing
+      ///   requested with the old ones ends up in the cache.
+      /// </remarks>
+      void invalidate(std::string_view key);
+      void clear();
+
+      [[nodiscard]] size_t size() const;
+      [[nodiscard]] size_t sizeBytes() const;
+      [[nodiscard]] ResponseCacheStats stats() const;
+      [[nodiscard]] const ResponseCacheOptions& options() const noexcept { return m_options; }
+
+      /// <summary>
+      ///   build a cache key from a path and a set of params. Params are included in iteration order, so
+      ///   an ordered map gives the same key regardless of the order they were added.
+      /// </summary>
+      template <KeyValueRange MapT>
+      [[nodiscard]] static std::string makeKey(std::string_view path, const MapT& param_map)
+      {
+         std::string key{ path };
+         char separator = '?';
+         for (auto&& [name, value] : param_map)
+         {
+            key += separator;
+            key.append(std::string_view{ name }).append("=").append(std::string_view{ value });
+            separator = '&';
+         }
+         return key;
+      }
+
+   private:
+      struct Entry
+      {
+         std::string key{};
+         std::string json{};
+         ResponseValidators validators{};
+         clock::time_point expires{};
+      };
+      using EntryList = std::list<Entry>;   // most recently used first
+
+      struct InFlight
+      {
+         std::shared_future<JsonResult> result{};
+         uint64_t generation{};   // value of m_generation when the fetch started
+      };
+
+      const ResponseCacheOptions m_options;
+
+      mutable std::mutex m_mutex{};
+      EntryList m_entries{};                                                  // guarded by m_mutex
+      std::map<std::string, EntryList::iterator, std::less<>> m_index{};      // guarded by m_mutex
+      std::map<std::string, InFlight, std::less<>> m_in_flight{};             // guarded by m_mutex
+      size_t m_bytes{};                                                       // guarded by m_mutex
+      uint64_t m_generation{};                                                // guarded by m_mutex, incremented by clear()
+      ResponseCacheStats m_stats{};                                           // guarded by m_mutex
+
+      // must be called with lock held
+      void storeLocked(std::string_view key, std::string json, ResponseValidators validators, clock::time_point expires);
+      void eraseLocked(EntryList::iterator it);
+      void evictLocked();
+   };
+
+
+   /// <summary>
+   ///   Data provider that serves requests from a ResponseCache, using the wrapped provider to fetch anything that
+   ///   isn't cached. If the wrapped provider supports conditional requests (see ConditionalDataProvider), expired
+   ///   entries are revalidated instead of being downloaded again.
+   /// </summary>
+   /// <remarks>
+   ///   The cache is shared (and can outlive the provider), so creating a new CachingDataProvider for each
+   ///   request is fine as long as they're all given the same cache.
+   /// </remarks>
+   template <DataProvider ProviderT>
+   class CachingDataProvider
+   {
+   public:
+      using JsonResult = ResponseCache::JsonResult;
+      using StreamResult = expected<void, oura_exception>;
+
+      explicit CachingDataProvider(ProviderT provider, std::shared_ptr<ResponseCache> cache = {}) :
+         m_provider{ std::move(provider) },
+         m_cache{ cache ? std::move(cache) : std::make_shared<ResponseCache>() }
+      {}
+
+      [[nodiscard]] JsonResult getJsonData(std::string_view path) const noexcept
+      {
+         return getCached(path, std::map<std::string, std::string>{});
+      }
+
+      template<KeyValueRange MapT>
+      [[nodiscard]] JsonResult getJsonData(std::string_view path, MapT&& param_map) const noexcept
+      {
+         return getCached(path, param_map);
+      }
+
+      /// <summary>
+      ///   streaming interface for code that wants it (eg streamDataSeries()). Responses come from the cache, so
+      ///   they're passed to the callback in a single chunk.
+      /// </summary>
+      template<KeyValueRange MapT>
+      [[nodiscard]] StreamResult streamJsonData(std::string_view path, const MapT& param_map, const JsonChunkCallback& on_chunk) const noexcept
+      {
+         auto json_res = getCached(path, param_map);
+         if (!json_res)
+            return unexpected{ std::move(json_res.error()) };
+
+         if (!on_chunk(json_res.value()))
+            return unexpected{ oura_exception{ "CachingDataProvider - transfer cancelled by callback", ErrorCategory::REST } };
+
+         return {};
+      }
+
+      const ProviderT& provider() const noexcept { return m_provider; }
+      const std::shared_ptr<ResponseCache>& cache() const noexcept { return m_cache; }
+
+   private:
+      ProviderT m_provider;
+      std::shared_ptr<ResponseCache> m_cache{};
+
+      template<KeyValueRange MapT>
+      [[nodiscard]] JsonResult getCached(std::string_view path, const MapT& param_map) const noexcept
+      {
+         try
+         {
+            return m_cache->get(ResponseCache::makeKey(path, param_map), [this, path, &param_map] (const ResponseValidators& validators)
+                                -> ResponseCache::FetchResult
+                                {
+                                   if constexpr (ConditionalDataProvider<ProviderT>)
+                                   {
+                                      return m_provider.getJsonDataIfModified(path, param_map, validators);
+                                   }
+                                   else
+                                   {
+                                      auto json_res = m_provider.getJsonData(path, std::map<std::string, std::string>{ rg::begin(param_map), rg::end(param_map) });
+                                      if (!json_res)
+                                         return unexpected{ std::move(json_res.error()) };
+
+                                      return ConditionalResponse{ .json = std::move(json_res.value()) };
+                                   }
+                                });
+         }
+         catch (oura_exception& e)
+         {
+            return unexpected{ std::move(e) };
+         }
+         catch (std::exception& e)
+         {
+            return unexpected{ oura_exception{ e.what() } };
+         }
+      }
+   };
+
+} // namespace oura_charts
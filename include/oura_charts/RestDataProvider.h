@@ -9,8 +9,14 @@
 #pragma once
 
 #include "oura_charts/oura_charts.h"
+#include "oura_charts/RequestScheduler.h"
+#include "oura_charts/detail/instrumentation.h"
 #include "oura_charts/detail/logging.h"
 #include <cpr/cpr.h>
+#include <cctype>
+#include <charconv>
+#include <memory>
+#include <thread>
 
 namespace oura_charts
 {
@@ -31,6 +37,12 @@ namespace oura_charts
       // unexpected value is an exception describing what went wrong.
       using JsonResult = expected<std::string, oura_exception>;
 
+      // type returned by streamJsonData(), which has no value since the JSON goes to the callback.
+      using StreamResult = expected<void, oura_exception>;
+
+      // type returned by getJsonDataIfModified()
+      using ConditionalResult = expected<ConditionalResponse, oura_exception>;
+
       /// <summary>
       ///   Retrieve the JSON data for the specified path with no parameters
       /// </summary>
@@ -46,7 +58,56 @@ namespace oura_charts
       template<KeyValueRange MapT>
       [[nodiscard]] JsonResult getJsonData(std::string_view path, MapT&& param_map) const noexcept
       {
-         return doRestGet(path, mapToParams(std::forward<MapT>(param_map)));
+         return doRestGet(path, mapToParams(param_map));
+      }
+
+      /// <summary>
+      ///   Retrieve the JSON data for the specified path, unless it hasn't changed since the response the
+      ///   validators came from. The validators are sent as If-None-Match/If-Modified-Since headers, and a 304
+      ///   response is returned as a ConditionalResponse with not_modified set.
+      /// </summary>
+      template<KeyValueRange MapT>
+      [[nodiscard]] ConditionalResult getJsonDataIfModified(std::string_view path, const MapT& param_map, const ResponseValidators& validators) const noexcept
+      {
+         cpr::Header header{};
+         if (!validators.etag.empty())
+            header[constants::REST_HEADER_IF_NONE_MATCH] = validators.etag;
+         if (!validators.last_modified.empty())
+            header[constants::REST_HEADER_IF_MODIFIED_SINCE] = validators.last_modified;
+
+         auto response = sendRequest(path, header, mapToParams(param_map));
+         if (response.status_code == HTTP_NOT_MODIFIED and response.error.code == cpr::ErrorCode::OK)
+            return ConditionalResponse{ .not_modified = true, .validators = validators };
+
+         auto json_res = getJsonFromResponse(response);
+         if (!json_res)
+            return unexpected{ std::move(json_res.error()) };
+
+         auto header_value = [&response] (const char* name)
+            {
+               auto it = response.header.find(name);
+               return it == response.header.end() ? std::string{} : it->second;
+            };
+         return ConditionalResponse{ .json = std::move(json_res.value()),
+                                     .validators = { .etag = header_value(constants::REST_HEADER_ETAG),
+                                                     .last_modified = header_value(constants::REST_HEADER_LAST_MODIFIED) } };
+      }
+
+      /// <summary>
+      ///   Retrieve the JSON data for the specified path, passing each chunk of the response body to
+      ///   on_chunk as it's received rather than buffering the whole response.
+      /// </summary>
+      /// <remarks>
+      ///   Requests are retried the same way as getJsonData(), as long as none of the body has been passed to
+      ///   on_chunk yet. If a transfer fails part way through the body the page fails instead, since a retry
+      ///   isn't guaranteed to get the same bytes back (eg the page could be regenerated with a different
+      ///   next_token) and the callback has already consumed the start of it. Bodies of error responses
+      ///   aren't passed to the callback.
+      /// </remarks>
+      template<KeyValueRange MapT>
+      [[nodiscard]] StreamResult streamJsonData(std::string_view path, const MapT& param_map, const JsonChunkCallback& on_chunk) const noexcept
+      {
+         return doRestStream(path, on_chunk, mapToParams(param_map));
       }
 
       // The base URL that is used in combination with the 'path' parameter of the
@@ -54,40 +115,229 @@ namespace oura_charts
       const std::string& baseURL() const { return m_base_url; }
 
 
+      // Whether to ask the server for compressed (gzip, deflate, br) responses. The body is decompressed
+      // by libcurl as it arrives. Defaults to enabled, which only advertises encodings libcurl was built with.
+      bool compressionEnabled() const noexcept       { return m_compression; }
+      void enableCompression(bool enable) noexcept   { m_compression = enable; }
+
+      // The scheduler used to pace and retry requests. Other providers using the same access token
+      // should share it, since the server's rate limit is per-token.
+      const std::shared_ptr<RequestScheduler>& scheduler() const { return m_scheduler; }
+
+
       /// <summary>
       ///   constructor, takes an Auth object and a base URL that should be used
-      ///   to build paths for REST endpoints.
+      ///   to build paths for REST endpoints. If no scheduler is specified, one is
+      ///   created with the default rate limit and retry policy.
       /// </summary>
-      RestDataProvider(Auth auth, std::string base_url) : m_auth{ auth },  m_base_url{ std::move(base_url) }
+      RestDataProvider(Auth auth, std::string base_url, std::shared_ptr<RequestScheduler> scheduler = {}) :
+         m_auth{ auth },
+         m_base_url{ std::move(base_url) },
+         m_scheduler{ scheduler ? std::move(scheduler) : std::make_shared<RequestScheduler>() }
       {
       }
 
    private:
+      static constexpr int64_t HTTP_NOT_MODIFIED = 304;
+
       Auth m_auth{};
       std::string m_base_url{};
+      std::shared_ptr<RequestScheduler> m_scheduler{};
+      bool m_compression{ true };
 
 
       // Assembles the REST GET request and sends it to the server, returning any JSON
       // (or error information) that is received in response.
+      //
+      // Throttled (429) and transient failures are retried here according to the scheduler's
+      // policy, so a multi-page fetch carries on from the page that failed instead of starting over.
       template <typename... Ts>
       [[nodiscard]] JsonResult doRestGet(std::string_view path, Ts... ts) const noexcept
       {
-         cpr::Header header{
-            { constants::REST_HEADER_XCLIENT, constants::REST_HEADER_XCLIENT_VALUE }
-         };
+         return getJsonFromResponse(sendRequest(path, ts...));
+      }
+
+
+      // sends the GET request, retrying as needed, and returns the final response.
+      template <typename... Ts>
+      [[nodiscard]] cpr::Response sendRequest(std::string_view path, Ts... ts) const noexcept
+      {
+         static auto& request_timer = instrumentation::timer(constants::METRIC_REST_GET);
+         static auto& response_bytes = instrumentation::histogram(constants::METRIC_REST_RESPONSE_BYTES, instrumentation::MetricUnit::Bytes);
+         static auto& wire_bytes = instrumentation::histogram(constants::METRIC_REST_WIRE_BYTES, instrumentation::MetricUnit::Bytes);
+
+         const auto encoding = acceptEncoding();
+         cpr::Response response{};
+         for (int attempt = 1; ; ++attempt)
+         {
+            m_scheduler->acquire();
+            {
+               // Send the request to server and check that we get a valid response.
+               instrumentation::ScopedTimer timer{ request_timer };
+               response = cpr::Get(m_auth.getAuthorization(), pathToUrl(path), encoding, ts...);
+            }
+
+            // downloaded_bytes is what came over the wire, before decompression.
+            response_bytes.record(response.text.size());
+            wire_bytes.record(static_cast<uint64_t>(response.downloaded_bytes));
+
+            auto retry_it = response.header.find(constants::REST_HEADER_RETRY_AFTER);
+            std::string_view retry_after = (retry_it == response.header.end()) ? std::string_view{} : std::string_view{ retry_it->second };
+            auto retry_delay = m_scheduler->completeRequest(effectiveStatus(response), retry_after, attempt);
+            if (!retry_delay)
+               break;
+
+            std::this_thread::sleep_for(*retry_delay);
+         }
+         return response;
+      }
+
+
+      // per-attempt state for doRestStream()
+      struct StreamState
+      {
+         int64_t status_code{};
+         std::string retry_after{};
+         std::string error_text{};
+         size_t received{};
+         bool cancelled{};
+      };
+
+
+      // Same as doRestGet(), except the response body is passed to on_chunk as it arrives instead of
+      // being returned.
+      template <typename... Ts>
+      [[nodiscard]] StreamResult doRestStream(std::string_view path, const JsonChunkCallback& on_chunk, Ts... ts) const noexcept
+      {
+         static auto& request_timer = instrumentation::timer(constants::METRIC_REST_GET);
+         static auto& response_bytes = instrumentation::histogram(constants::METRIC_REST_RESPONSE_BYTES, instrumentation::MetricUnit::Bytes);
+         static auto& wire_bytes = instrumentation::histogram(constants::METRIC_REST_WIRE_BYTES, instrumentation::MetricUnit::Bytes);
+
+         const auto encoding = acceptEncoding();
+         cpr::Response response{};
+         StreamState state{};
+         for (int attempt = 1; ; ++attempt)
+         {
+            state = StreamState{};
+
+            // we need the status before the body arrives, so we know whether to pass it along.
+            cpr::HeaderCallback on_header{ [&state] (auto header, intptr_t) -> bool
+               {
+                  parseHeaderLine(header, state);
+                  return true;
+               } };
+
+            cpr::WriteCallback on_write{ [&] (auto data, intptr_t) -> bool
+               {
+                  std::string_view chunk{ data };
+                  if (!cpr::status::is_success(state.status_code))
+                  {
+                     state.error_text.append(chunk);
+                     return true;
+                  }
+
+                  state.received += chunk.size();
+                  state.cancelled = !on_chunk(chunk);
+                  return !state.cancelled;
+               } };
+
+            m_scheduler->acquire();
+            {
+               instrumentation::ScopedTimer timer{ request_timer };
+               response = cpr::Get(m_auth.getAuthorization(), pathToUrl(path), encoding, on_header, on_write, ts...);
+            }
+            response_bytes.record(state.received + state.error_text.size());
+            wire_bytes.record(static_cast<uint64_t>(response.downloaded_bytes));
+
+            if (state.cancelled)
+               return unexpected{ oura_exception{ "RestDataProvider - transfer cancelled by callback", ErrorCategory::REST } };
+
+            auto retry_delay = m_scheduler->completeRequest(effectiveStatus(response), state.retry_after, attempt);
+            if (!retry_delay)
+               break;
 
-         // Send the request to server and check that we get a valid response.
-         cpr::Response response = cpr::Get(m_auth.getAuthorization(), pathToUrl(path), ts...);
-         return getJsonFromResponse(response);
+            // part of the body has already been consumed, so the page can't be restarted.
+            if (state.received > 0)
+            {
+               const auto received = state.received;
+               oura_exception ex{ ErrorCategory::REST, "RestDataProvider - transfer failed after {} bytes of the response were received", received };
+               logging::exception("RestDataProvider", ex);
+               return unexpected{ std::move(ex) };
+            }
+
+            std::this_thread::sleep_for(*retry_delay);
+         }
+
+         if (response.error.code != cpr::ErrorCode::OK)
+         {
+            oura_exception ex{ response.error };
+            logging::exception("RestDataProvider", ex);
+            return unexpected{ std::move(ex) };
+         }
+         if (!cpr::status::is_success(response.status_code))
+         {
+            response.text = std::move(state.error_text);
+            return unexpected{ getJsonFromResponse(response).error() };
+         }
+         return {};
+      }
+
+
+      // a transfer that fails part way through still has the status code from the headers, but we want
+      // the scheduler to treat it as a failed request (status 0).
+      [[nodiscard]] static int64_t effectiveStatus(const cpr::Response& response) noexcept
+      {
+         return response.error.code == cpr::ErrorCode::OK ? response.status_code : 0;
+      }
+
+
+      // pick the status code and Retry-After value out of the response headers, one line at a time.
+      static void parseHeaderLine(std::string_view line, StreamState& state)
+      {
+         constexpr std::string_view status_prefix{ "HTTP/" };
+         constexpr std::string_view retry_after_name{ constants::REST_HEADER_RETRY_AFTER };
+
+         auto toLower = [] (char ch) { return std::tolower(static_cast<unsigned char>(ch)); };
+         auto trim = [] (std::string_view text)
+            {
+               auto first = text.find_first_not_of(" \t\r\n");
+               auto last = text.find_last_not_of(" \t\r\n");
+               return first == std::string_view::npos ? std::string_view{} : text.substr(first, last - first + 1);
+            };
+
+         if (line.starts_with(status_prefix))
+         {
+            // "HTTP/1.1 200 OK", there may be more than one of these (eg 100 Continue) so last one wins.
+            auto code_pos = line.find(' ');
+            int64_t code{};
+            if (code_pos != std::string_view::npos)
+               std::from_chars(line.data() + code_pos + 1, line.data() + line.size(), code);
+
+            state.status_code = code;
+            state.retry_after.clear();
+         }
+         else if (line.size() > retry_after_name.size() && line[retry_after_name.size()] == ':' &&
+                  rg::equal(line.substr(0, retry_after_name.size()), retry_after_name, {}, toLower, toLower))
+         {
+            state.retry_after = trim(line.substr(retry_after_name.size() + 1));
+         }
+      }
+
+
+      // an empty AcceptEncoding tells libcurl to advertise every encoding it supports.
+      [[nodiscard]] cpr::AcceptEncoding acceptEncoding() const
+      {
+         return m_compression ? cpr::AcceptEncoding{} : cpr::AcceptEncoding{ { cpr::AcceptEncodingMethods::disabled } };
       }
 
 
       // extract the expected json (or unexepected error) from a REST response
       [[nodiscard]] static JsonResult getJsonFromResponse(const cpr::Response& response) noexcept
       {
-         if (cpr::status::is_success(response.status_code))
+         if (cpr::status::is_success(response.status_code) && response.error.code == cpr::ErrorCode::OK)
          {
-            logging::trace("RestDataProvider - received the following JSON:\r\n{}", response.text);
+            // Don't dump the whole body, it can be megabytes and would be formatted on the fetch thread.
+            logging::trace("RestDataProvider - received JSON response: {}", logging::TextSummary{ response.text });
             return response.text;
          }
          else if (response.error.code != cpr::ErrorCode::OK)
@@ -113,13 +363,13 @@ namespace oura_charts
 
 
       template<KeyValueRange MapT>
-      [[nodiscard]] static cpr::Parameters mapToParams(MapT&& param_map)
+      [[nodiscard]] static cpr::Parameters mapToParams(const MapT& param_map)
       {
          // get the parameters into object for the REST call.
          cpr::Parameters params{};
          for (auto&& elem : param_map)
          {
-            logging::info("RestDataProvider - adding parameter '{}' = {}", elem.first, elem.second);
+            logging::debug("RestDataProvider - adding parameter '{}' = {}", elem.first, elem.second);
             params.Add({ elem.first, elem.second });
          };
          return params;
@@ -10,6 +10,7 @@
 
 #include "oura_charts/oura_charts.h"
 #include "DataSeries.h"
+#include "oura_charts/FieldDescriptor.h"
 #include "oura_charts/detail/json_structs.h"
 
 namespace oura_charts
@@ -29,15 +30,21 @@ namespace oura_charts
       using StorageType = detail::sleep_data;
       using SleepType = StorageType::SleepType;
       using ReadinessContributors = StorageType::ReadinessContributors;
+      using ReadinessContributorArray = StorageType::ReadinessContributorArray;
 
       static inline constexpr std::string_view REST_PATH = constants::REST_PATH_SLEEP_SESSION;
 
       const std::string& sleepId() const           {  return m_data.id;                   }
+      const std::string& id() const                {  return m_data.id;                   }
       SleepType sleepType() const                  {  return m_data.type;                 }
       const chrono::year_month_day& sessionDate() const   {  return m_data.day;                  }
+      DayNumber dayNumber() const                         {  return m_day;                       }
       const local_seconds& bedtimeStart() const           {  return m_data.bedtime_start;        }
       const local_seconds& bedtimeEnd() const             {  return m_data.bedtime_end;          }
 
+      // sessions are ordered by when they started.
+      const local_seconds& timestamp() const              {  return m_data.bedtime_start;        }
+
       const nullable_double& avgBreathingRate() const     {  return m_data.average_breath;       }
       const nullable_double& avgHeartRate() const         {  return m_data.average_heart_rate;   }
       const nullable_double& avgHRV() const               {  return m_data.average_hrv;          }
@@ -53,10 +60,21 @@ namespace oura_charts
                                                
       const std::optional<uint32_t>& restlessPeriods() const       {  return m_data.restless_periods;     }
 
+      int readinessScore() const                                       {  return m_data.readiness.score;                       }
+      const ReadinessContributorArray& readinessContributors() const   {  return m_data.readiness.contributors;                }
+      const nullable_double& temperatureDeviation() const              {  return m_data.readiness.temperature_deviation;       }
+      const nullable_double& temperatureTrendDeviation() const         {  return m_data.readiness.temperature_trend_deviation; }
+
       /// <summary>
       ///   constructor accepts data by value, pass && to move instead of copy
       /// </summary>
       explicit SleepSession(StorageType data) noexcept : m_data(std::move(data)) {}
+
+      /// <summary>
+      ///   constructor for SleepSessionSummary, the values that aren't in the summary will be empty.
+      /// </summary>
+      explicit SleepSession(detail::sleep_summary_data data) noexcept : m_data(detail::toSleepData(std::move(data))) {}
+
       SleepSession(const SleepSession&) = default;
       SleepSession(SleepSession&&) = default;
       ~SleepSession() = default;
@@ -65,12 +83,22 @@ namespace oura_charts
 
    private:
       StorageType m_data;
+      DayNumber m_day{ toDayNumber(m_data.day) };
    };
 
    using SleepType = SleepSession::SleepType;
    using ReadinessContributors = SleepSession::ReadinessContributors;
+   using ReadinessContributorArray = SleepSession::ReadinessContributorArray;
+   using ReadinessContributorAvgCalc = EnumArrayAvgCalc<ReadinessContributorArray>;
    using SleepSessionSeries = DataSeries<SleepSession>;
 
+   /// <summary>
+   ///   SleepSession that only parses the summary values from the REST data, which is a lot faster than parsing
+   ///   the full session when you don't need the readiness contributors. See ProjectedElement
+   /// </summary>
+   using SleepSessionSummary = ProjectedElement<SleepSession, detail::sleep_summary_data>;
+   using SleepSessionSummarySeries = DataSeries<SleepSessionSummary>;
+
 
    /// <summary>
    ///   predicate to allow filtering SleepSessions by sleep type.
@@ -97,11 +125,11 @@ namespace oura_charts
    //
    // These lambda's can be used as projections for converting sessionDate() to various calandar types.
    //
-   inline constexpr auto sessionYearMonthDay = selectAsYearMonthDay<&SleepSession::sessionDate>;
-   inline constexpr auto sessionYear         = selectAsYear<&SleepSession::sessionDate>;
-   inline constexpr auto sessionYearMonth    = selectAsYearMonth<&SleepSession::sessionDate>;
-   inline constexpr auto sessionMonth        = selectAsMonth<&SleepSession::sessionDate>;
-   inline constexpr auto sessionWeekday      = selectAsWeekday<&SleepSession::sessionDate>;
+   inline constexpr auto sessionYearMonthDay = selectDayNumberAsYearMonthDay<&SleepSession::dayNumber>;
+   inline constexpr auto sessionYear         = selectDayNumberAsYear<&SleepSession::dayNumber>;
+   inline constexpr auto sessionYearMonth    = selectDayNumberAsYearMonth<&SleepSession::dayNumber>;
+   inline constexpr auto sessionMonth        = selectDayNumberAsMonth<&SleepSession::dayNumber>;
+   inline constexpr auto sessionWeekday      = selectDayNumberAsWeekday<&SleepSession::dayNumber>;
 
     
    //
@@ -113,6 +141,57 @@ namespace oura_charts
    using SleepByYear      = MapByYear<SleepSession>;
 
 
+   //
+   // field descriptors, for use with extractColumn(), aggregateColumn(), writeCsv(), etc. The readiness
+   // contributors aren't a single value, so they don't have one.
+   //
+   inline constexpr FieldDescriptor<&SleepSession::id>                        sessionIdField                    { "id" };
+   inline constexpr FieldDescriptor<&SleepSession::sleepType>                 sessionSleepTypeField             { "sleep_type" };
+   inline constexpr FieldDescriptor<&SleepSession::sessionDate>               sessionDateField                  { "date" };
+   inline constexpr FieldDescriptor<&SleepSession::bedtimeStart>              sessionBedtimeStartField          { "bedtime_start" };
+   inline constexpr FieldDescriptor<&SleepSession::bedtimeEnd>                sessionBedtimeEndField            { "bedtime_end" };
+   inline constexpr FieldDescriptor<&SleepSession::avgBreathingRate>          sessionAvgBreathingRateField      { "avg_breathing_rate", "breaths/min" };
+   inline constexpr FieldDescriptor<&SleepSession::avgHeartRate>              sessionAvgHeartRateField          { "avg_heart_rate", "bpm" };
+   inline constexpr FieldDescriptor<&SleepSession::avgHRV>                    sessionAvgHRVField                { "avg_hrv", "ms" };
+   inline constexpr FieldDescriptor<&SleepSession::restingHeartRate>          sessionRestingHeartRateField      { "resting_heart_rate", "bpm" };
+   inline constexpr FieldDescriptor<&SleepSession::latency>                   sessionLatencyField               { "latency", "s" };
+   inline constexpr FieldDescriptor<&SleepSession::timeAwake>                 sessionTimeAwakeField             { "time_awake", "s" };
+   inline constexpr FieldDescriptor<&SleepSession::sleepTimeDeep>             sessionSleepTimeDeepField         { "sleep_time_deep", "s" };
+   inline constexpr FieldDescriptor<&SleepSession::sleepTimeLight>            sessionSleepTimeLightField        { "sleep_time_light", "s" };
+   inline constexpr FieldDescriptor<&SleepSession::sleepTimeREM>              sessionSleepTimeREMField          { "sleep_time_rem", "s" };
+   inline constexpr FieldDescriptor<&SleepSession::sleepTimeTotal>            sessionSleepTimeTotalField        { "sleep_time_total", "s" };
+   inline constexpr FieldDescriptor<&SleepSession::timeInBed>                 sessionTimeInBedField             { "time_in_bed", "s" };
+   inline constexpr FieldDescriptor<&SleepSession::restlessPeriods>           sessionRestlessPeriodsField       { "restless_periods" };
+   inline constexpr FieldDescriptor<&SleepSession::readinessScore>            sessionReadinessScoreField        { "readiness_score" };
+   inline constexpr FieldDescriptor<&SleepSession::temperatureDeviation>      sessionTemperatureDeviationField  { "temperature_deviation", "celsius" };
+   inline constexpr FieldDescriptor<&SleepSession::temperatureTrendDeviation> sessionTemperatureTrendField      { "temperature_trend_deviation", "celsius" };
+
+   template <>
+   struct ElementFields<SleepSession>
+   {
+      static inline constexpr auto value = std::tuple{ sessionIdField,
+                                                       sessionSleepTypeField,
+                                                       sessionDateField,
+                                                       sessionBedtimeStartField,
+                                                       sessionBedtimeEndField,
+                                                       sessionAvgBreathingRateField,
+                                                       sessionAvgHeartRateField,
+                                                       sessionAvgHRVField,
+                                                       sessionRestingHeartRateField,
+                                                       sessionLatencyField,
+                                                       sessionTimeAwakeField,
+                                                       sessionSleepTimeDeepField,
+                                                       sessionSleepTimeLightField,
+                                                       sessionSleepTimeREMField,
+                                                       sessionSleepTimeTotalField,
+                                                       sessionTimeInBedField,
+                                                       sessionRestlessPeriodsField,
+                                                       sessionReadinessScoreField,
+                                                       sessionTemperatureDeviationField,
+                                                       sessionTemperatureTrendField };
+   };
+
+
    /// <summary>
    ///   concept for a map that can hold SleepSession objects.
    /// </summary>
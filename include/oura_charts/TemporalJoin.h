@@ -0,0 +1,151 @@
+//---------------------------------------------------------------------------------------------------------------------
+// TemporalJoin.h
+//
+// sort-merge join of point-in-time data (eg heart rate samples) with the time windows of another series (eg sleep
+// sessions or days).
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "oura_charts/oura_charts.h"
+#include "oura_charts/chrono_helpers.h"
+#include "oura_charts/DataSeries.h"
+#include <cassert>
+#include <concepts>
+#include <functional>
+#include <ranges>
+#include <vector>
+
+
+namespace oura_charts
+{
+   /// <summary>
+   ///   half-open time interval [begin, end)
+   /// </summary>
+   struct TimeWindow
+   {
+      local_seconds begin{};
+      local_seconds end{};
+
+      [[nodiscard]] constexpr bool contains(local_seconds t) const noexcept { return t >= begin && t < end; }
+
+      constexpr bool operator==(const TimeWindow&) const = default;
+   };
+
+
+   /// <summary>
+   ///   concept for a projection that returns the TimeWindow for an element.
+   /// </summary>
+   template <typename ProjT, typename WindowT>
+   concept WindowProjection = std::is_invocable_r_v<TimeWindow, ProjT&, const WindowT&>;
+
+
+   //
+   // window projections for use with joinByWindow()
+   //
+
+   // the window from the start to the end of something, eg &SleepSession::bedtimeStart / &SleepSession::bedtimeEnd
+   template <auto beginFunc, auto endFunc>
+   inline constexpr auto selectAsWindow = [] (const auto& obj) -> TimeWindow requires InvocableFor<decltype(beginFunc), decltype(obj)>
+      {
+         return TimeWindow{ std::invoke(beginFunc, obj), std::invoke(endFunc, obj) };
+      };
+
+   // the calendar day returned by a member function, eg &DailySleepScore::date
+   template <auto memFunc>
+   inline constexpr auto selectAsDayWindow = [] (const auto& obj) -> TimeWindow requires InvocableFor<decltype(memFunc), decltype(obj)>
+      {
+         local_days day{ year_month_day{ std::invoke(memFunc, obj) } };
+         return TimeWindow{ day, day + days{ 1 } };
+      };
+
+
+   /// <summary>
+   ///   One window from a temporal join, and the points that fall within it. The points are a view into the
+   ///   original series, nothing is copied.
+   /// </summary>
+   template <typename WindowT, typename PointIteratorT>
+   struct JoinedWindow
+   {
+      std::reference_wrapper<const WindowT> window;
+      rg::subrange<PointIteratorT> points;
+   };
+
+
+   /// <summary>
+   ///   Sort-merge interval join. Calls func(window, points) for each element of 'windows' (a DataSeries or any other
+   ///   range), where points is a subrange of the elements in 'points' whose timestamp is within the window returned
+   ///   by 'window_proj'.
+   /// </summary>
+   /// <remarks>
+   ///   Both series need to be in timestamp order (which they are unless you've added elements yourself, see
+   ///   DataSeries::isOrdered()). As long as the windows are in order and don't overlap, the cost is linear in the
+   ///   size of both series. Overlapping windows still get the correct points, and a window that starts before the
+   ///   previous one costs a binary search to reposition. Nothing is allocated.
+   /// </remarks>
+   template <TimestampedElement PointT, typename PointAllocT, rg::forward_range WindowRangeT,
+             WindowProjection<rg::range_value_t<WindowRangeT>> WindowProjT, typename FuncT>
+      requires std::invocable<FuncT&, const rg::range_value_t<WindowRangeT>&, rg::subrange<typename DataSeries<PointT, PointAllocT>::const_iterator>>
+   void forEachWindow(const DataSeries<PointT, PointAllocT>& points, const WindowRangeT& windows, WindowProjT&& window_proj, FuncT&& func)
+   {
+      assert(points.isOrdered());
+
+      auto cursor = points.cbegin();
+      local_seconds prev_begin{ local_seconds::min() };
+      for (const auto& window : windows)
+      {
+         const TimeWindow interval = std::invoke(window_proj, window);
+         if (interval.begin < prev_begin)
+         {
+            // window starts before the previous one, so our cursor is too far ahead.
+            cursor = rg::lower_bound(points.cbegin(), cursor, interval.begin, {}, elementTimestamp);
+         }
+         prev_begin = interval.begin;
+
+         // skip over points before this window. The points within the window start at the cursor position, and
+         // the cursor stays there so the next window can start its scan from the same place.
+         while (cursor != points.cend() && elementTimestamp(*cursor) < interval.begin)
+            ++cursor;
+
+         auto last = cursor;
+         while (last != points.cend() && elementTimestamp(*last) < interval.end)
+            ++last;
+
+         std::invoke(func, window, rg::subrange{ cursor, last });
+      }
+   }
+
+
+   /// <summary>
+   ///   Sort-merge interval join that returns a JoinedWindow for each element in 'windows', eg:
+   ///
+   ///      auto hr_by_session = joinByWindow(heart_rates, sessions, selectAsWindow<&SleepSession::bedtimeStart, &SleepSession::bedtimeEnd>);
+   ///      for (auto& [session, hr_samples] : hr_by_session) ...
+   /// </summary>
+   /// <remarks>
+   ///   The only allocation is the returned vector (one entry per window). The JoinedWindow's refer to the
+   ///   elements of both series, so the series must outlive the result.
+   /// </remarks>
+   template <TimestampedElement PointT, typename PointAllocT, rg::forward_range WindowRangeT,
+             WindowProjection<rg::range_value_t<WindowRangeT>> WindowProjT>
+   [[nodiscard]] auto joinByWindow(const DataSeries<PointT, PointAllocT>& points, const WindowRangeT& windows, WindowProjT&& window_proj)
+   {
+      using WindowT = rg::range_value_t<WindowRangeT>;
+      using PointIteratorT = typename DataSeries<PointT, PointAllocT>::const_iterator;
+      using JoinedWindowT = JoinedWindow<WindowT, PointIteratorT>;
+
+      std::vector<JoinedWindowT> joined{};
+      if constexpr (rg::sized_range<const WindowRangeT>)
+         joined.reserve(rg::size(windows));
+
+      forEachWindow(points, windows, std::forward<WindowProjT>(window_proj),
+                    [&joined] (const WindowT& window, rg::subrange<PointIteratorT> window_points)
+                    {
+                       joined.emplace_back(JoinedWindowT{ std::cref(window), window_points });
+                    });
+      return joined;
+   }
+
+} // namespace oura_charts
@@ -0,0 +1,207 @@
+//---------------------------------------------------------------------------------------------------------------------
+// ThreadPool.h
+//
+// Declaration for class ThreadPool, a work-stealing thread pool shared by the parts of the library that can run in
+// parallel (parsing pages, aggregating large series, etc), and class TaskGroup for waiting on a set of tasks.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "oura_charts/oura_charts.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+namespace oura_charts::constants
+{
+   // how long TaskGroup::wait() sleeps when there's nothing it can help with, before checking again.
+   inline constexpr std::chrono::milliseconds TASK_GROUP_WAIT_INTERVAL{ 1 };
+
+   inline constexpr const char* METRIC_POOL_TASKS = "pool.tasks";
+   inline constexpr const char* METRIC_POOL_STEALS = "pool.steals";
+
+} // namespace oura_charts::constants
+
+
+namespace oura_charts
+{
+   /// <summary>
+   ///   Work-stealing thread pool. Each worker has its own queue; tasks posted from a worker go on that worker's
+   ///   queue (and are run newest-first, which keeps related data in cache), while idle workers steal the oldest
+   ///   tasks from the other queues. Tasks posted from outside the pool are spread across the queues.
+   /// </summary>
+   /// <remarks>
+   ///   Most code should use ThreadPool::shared() rather than creating its own pool, so the whole library shares
+   ///   one set of threads. Use TaskGroup to run a batch of tasks and wait for them, since its wait() runs
+   ///   queued tasks on the waiting thread instead of blocking, which makes it safe to wait from inside a task.
+   ///
+   ///   All methods are thread-safe. The destructor runs any tasks that are still queued before returning.
+   /// </remarks>
+   class ThreadPool
+   {
+   public:
+      using Task = std::function<void()>;
+
+      explicit ThreadPool(size_t thread_count = defaultThreadCount());
+      ~ThreadPool();
+
+      ThreadPool(const ThreadPool&) = delete;
+      ThreadPool(ThreadPool&&) = delete;
+      ThreadPool& operator=(const ThreadPool&) = delete;
+      ThreadPool& operator=(ThreadPool&&) = delete;
+
+      /// <summary>
+      ///   queue a task to be run on the pool. The task must not throw, use submit() or a TaskGroup for
+      ///   anything that might.
+      /// </summary>
+      void post(Task task);
+
+      /// <summary>
+      ///   queue a callable to be run on the pool, and return a future for its result (or exception).
+      /// </summary>
+      template <std::invocable FuncT>
+      [[nodiscard]] auto submit(FuncT&& func) -> std::future<std::invoke_result_t<std::decay_t<FuncT>&>>
+      {
+         using ResultT = std::invoke_result_t<std::decay_t<FuncT>&>;
+
+         // std::function needs a copyable target, and packaged_task isn't.
+         auto task = std::make_shared<std::packaged_task<ResultT()>>(std::forward<FuncT>(func));
+         auto result = task->get_future();
+         post([task] { (*task)(); });
+         return result;
+      }
+
+      /// <summary>
+      ///   if there's a task in the pool's queues, remove it and run it on the calling thread. Returns false
+      ///   if there was nothing to run.
+      /// </summary>
+      bool runPendingTask();
+
+      /// <summary>
+      ///   number of worker threads in the pool.
+      /// </summary>
+      [[nodiscard]] size_t threadCount() const noexcept { return m_threads.size(); }
+
+      /// <summary>
+      ///   returns true if the calling thread is one of this pool's workers.
+      /// </summary>
+      [[nodiscard]] bool isWorkerThread() const noexcept;
+
+      /// <summary>
+      ///   the pool shared by the library. It's created the first time this is called, with the number of
+      ///   threads set by setSharedThreadCount() (or defaultThreadCount() if that wasn't called).
+      /// </summary>
+      [[nodiscard]] static ThreadPool& shared();
+
+      /// <summary>
+      ///   set the number of threads for the shared pool. This has to be called before the first call to
+      ///   shared(), and returns false (without changing anything) if the shared pool already exists.
+      /// </summary>
+      static bool setSharedThreadCount(size_t thread_count);
+
+      /// <summary>
+      ///   default number of threads, which is the number of hardware threads (or 1 if that isn't known).
+      /// </summary>
+      [[nodiscard]] static size_t defaultThreadCount() noexcept;
+
+   private:
+      struct WorkerQueue
+      {
+         std::mutex mutex{};
+         std::deque<Task> tasks{};
+      };
+
+      std::vector<std::unique_ptr<WorkerQueue>> m_queues{};
+      std::vector<std::jthread> m_threads{};
+
+      std::mutex m_wake_mutex{};
+      std::condition_variable m_wake_cv{};
+      std::atomic<size_t> m_pending{};
+      std::atomic<size_t> m_next_queue{};
+      bool m_stopping{};   // guarded by m_wake_mutex
+
+      void workerLoop(size_t queue_idx);
+      bool popTask(size_t queue_idx, Task& task);
+      bool stealTask(size_t thief_idx, Task& task);
+   };
+
+
+   /// <summary>
+   ///   A set of tasks run on a ThreadPool that can be waited on together. If any task throws, the first
+   ///   exception is rethrown by wait().
+   /// </summary>
+   /// <remarks>
+   ///   wait() runs queued pool tasks on the calling thread while it waits, so a task can create its own
+   ///   TaskGroup and wait on it without tying up a worker (or deadlocking if every worker is doing the same).
+   ///   The destructor waits for any tasks that are still running, but doesn't rethrow.
+   /// </remarks>
+   class TaskGroup
+   {
+   public:
+      explicit TaskGroup(ThreadPool& pool = ThreadPool::shared()) noexcept : m_pool{ pool }
+      {}
+
+      ~TaskGroup();
+
+      TaskGroup(const TaskGroup&) = delete;
+      TaskGroup(TaskGroup&&) = delete;
+      TaskGroup& operator=(const TaskGroup&) = delete;
+      TaskGroup& operator=(TaskGroup&&) = delete;
+
+      /// <summary>
+      ///   queue a callable to run on the pool as part of this group.
+      /// </summary>
+      template <std::invocable FuncT>
+      void run(FuncT&& func)
+      {
+         {
+            std::lock_guard lock{ m_mutex };
+            ++m_outstanding;
+         }
+         m_pool.post([this, func = std::forward<FuncT>(func)] () mutable
+                     {
+                        try
+                        {
+                           std::invoke(func);
+                        }
+                        catch (...)
+                        {
+                           std::lock_guard lock{ m_mutex };
+                           if (!m_error)
+                              m_error = std::current_exception();
+                        }
+                        taskDone();
+                     });
+      }
+
+      /// <summary>
+      ///   wait for all tasks in the group to finish, then rethrow the first exception thrown by any of them.
+      /// </summary>
+      void wait();
+
+      ThreadPool& pool() noexcept { return m_pool; }
+
+   private:
+      ThreadPool& m_pool;
+      std::mutex m_mutex{};
+      std::condition_variable m_done_cv{};
+      size_t m_outstanding{};        // guarded by m_mutex
+      std::exception_ptr m_error{};  // guarded by m_mutex
+
+      void taskDone();
+      void waitForTasks() noexcept;
+   };
+
+} // namespace oura_charts
@@ -14,6 +14,7 @@
 #include <fmt/chrono.h>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <ranges>
 #include <spanstream>
@@ -140,6 +141,68 @@ namespace oura_charts
    }
 
 
+   /// <summary>
+   ///   Number of days since 1970-01-01, which is the same value as sys_days::time_since_epoch().count(). The
+   ///   element classes cache this when they're created, so the calendar projections (selectDayNumberAsWeekday,
+   ///   etc) can be computed with integer arithmetic instead of building chrono calendar types from a timestamp
+   ///   every time they're called.
+   /// </summary>
+   using DayNumber = int32_t;
+
+
+   /// <summary>
+   ///   get the DayNumber for a time_point, ignoring the time of day.
+   /// </summary>
+   template <typename ClockT, typename DurationT>
+   [[nodiscard]] inline constexpr DayNumber toDayNumber(chrono::time_point<ClockT, DurationT> tp) noexcept
+   {
+      return static_cast<DayNumber>(floor<days>(tp).time_since_epoch().count());
+   }
+
+
+   /// <summary>
+   ///   get the DayNumber for a calendar date
+   /// </summary>
+   [[nodiscard]] inline constexpr DayNumber toDayNumber(year_month_day ymd) noexcept
+   {
+      return static_cast<DayNumber>(sys_days{ ymd }.time_since_epoch().count());
+   }
+
+
+   /// <summary>
+   ///   get the day of the week for a DayNumber.
+   /// </summary>
+   [[nodiscard]] inline constexpr weekday dayNumberToWeekday(DayNumber day_num) noexcept
+   {
+      // 1970-01-01 was a Thursday (c_encoding() == 4), the second case keeps the remainder positive for dates before that.
+      return weekday{ static_cast<unsigned>(day_num >= -4 ? (day_num + 4) % 7 : (day_num + 5) % 7 + 6) };
+   }
+
+
+   /// <summary>
+   ///   get the calendar date for a DayNumber.
+   /// </summary>
+   /// <remarks>
+   ///   this is the days-to-civil algorithm from Howard Hinnant's date library, which only uses integer
+   ///   arithmetic (no tables or branches on the month).
+   /// </remarks>
+   [[nodiscard]] inline constexpr year_month_day dayNumberToYearMonthDay(DayNumber day_num) noexcept
+   {
+      // shift the epoch to 0000-03-01 so the leap day is at the end of the year, then split into 400 year eras.
+      const int32_t shifted      = day_num + 719468;
+      const int32_t era          = (shifted >= 0 ? shifted : shifted - 146096) / 146097;
+      const auto    day_of_era   = static_cast<uint32_t>(shifted - era * 146097);                                     // [0, 146096]
+      const auto    year_of_era  = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365; // [0, 399]
+      const auto    day_of_year  = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);            // [0, 365]
+      const auto    month_index  = (5 * day_of_year + 2) / 153;                                                       // [0, 11], March == 0
+      const auto    day_of_month = day_of_year - (153 * month_index + 2) / 5 + 1;                                     // [1, 31]
+      const auto    month_num    = month_index < 10 ? month_index + 3 : month_index - 9;                              // [1, 12]
+      const auto    year_num     = static_cast<int32_t>(year_of_era) + era * 400 + (month_num <= 2 ? 1 : 0);
+
+      return year_month_day{ chrono::year{ year_num }, chrono::month{ month_num }, chrono::day{ day_of_month } };
+   }
+
+
    /// <summary>
    ///   For a given time_point, return a duration that represents only the time of day (no date).
    /// </summary>
@@ -335,7 +398,7 @@ namespace oura_charts
    template <auto memFunc>
    inline constexpr auto selectAsYearMonth = [](const auto& obj) -> year_month requires InvocableFor<decltype(memFunc), decltype(obj)>
       {
-         return year_month{ std::invoke(memFunc, obj) };
+         return stripDay(year_month_day{ std::invoke(memFunc, obj) });
       };
 
    template <auto memFunc>
@@ -352,6 +415,42 @@ namespace oura_charts
 
 
 
+   //
+   // Same as the selectAs projections above, but for member functions that return a cached DayNumber (which is
+   // faster than building the calendar types from a year_month_day or time_point every time).
+   //
+   template <auto dayNumFunc>
+   inline constexpr auto selectDayNumberAsYearMonthDay = [] (const auto& obj) -> year_month_day requires InvocableFor<decltype(dayNumFunc), decltype(obj)>
+      {
+         return dayNumberToYearMonthDay(std::invoke(dayNumFunc, obj));
+      };
+
+   template <auto dayNumFunc>
+   inline constexpr auto selectDayNumberAsYear = [] (const auto& obj) -> year requires InvocableFor<decltype(dayNumFunc), decltype(obj)>
+      {
+         return dayNumberToYearMonthDay(std::invoke(dayNumFunc, obj)).year();
+      };
+
+   template <auto dayNumFunc>
+   inline constexpr auto selectDayNumberAsYearMonth = [] (const auto& obj) -> year_month requires InvocableFor<decltype(dayNumFunc), decltype(obj)>
+      {
+         return stripDay(dayNumberToYearMonthDay(std::invoke(dayNumFunc, obj)));
+      };
+
+   template <auto dayNumFunc>
+   inline constexpr auto selectDayNumberAsMonth = [] (const auto& obj) -> month requires InvocableFor<decltype(dayNumFunc), decltype(obj)>
+      {
+         return dayNumberToYearMonthDay(std::invoke(dayNumFunc, obj)).month();
+      };
+
+   template <auto dayNumFunc>
+   inline constexpr auto selectDayNumberAsWeekday = [] (const auto& obj) -> weekday requires InvocableFor<decltype(dayNumFunc), decltype(obj)>
+      {
+         return dayNumberToWeekday(std::invoke(dayNumFunc, obj));
+      };
+
+
+
    /// <summary>
    ///   AvgCalc<> specialization for chrono duration types
    ///  
@@ -415,6 +514,13 @@ namespace oura_charts
          return m_sum.hasResult();
       }
 
+      // combine the values from another calculation into this one.
+      void merge(const AvgCalc& other) noexcept
+      {
+         m_sum.merge(other.m_sum);
+         m_count += other.m_count;
+      }
+
    private:
       SumCalc<Rep, double> m_sum{};
       size_t m_count{};
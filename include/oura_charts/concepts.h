@@ -11,8 +11,10 @@
 #include <fmt/format.h>
 #include <concepts>
 #include <functional>
+#include <map>
 #include <optional>
 #include <ranges>
+#include <string>
 #include <string_view>
 
 namespace oura_charts
@@ -104,6 +106,60 @@ namespace oura_charts
    };
 
 
+   /// <summary>
+   ///   callback that receives JSON text from a streaming data provider as it arrives. Return false to stop
+   ///   the transfer.
+   /// </summary>
+   using JsonChunkCallback = std::function<bool(std::string_view)>;
+
+
+   /// <summary>
+   ///   concept for a data provider that can also deliver JSON incrementally, passing each chunk of text to a
+   ///   callback as it's received instead of returning it all at once.
+   /// </summary>
+   template <typename Provider>
+   concept StreamingDataProvider = DataProvider<Provider> &&
+                                   requires (Provider dp, Provider::StreamResult sr, std::map<std::string, std::string> params, JsonChunkCallback cb)
+   {
+      sr = dp.streamJsonData("", params, cb);
+   };
+
+
+   /// <summary>
+   ///   validators from a previous response, sent with a conditional request (If-None-Match/If-Modified-Since)
+   ///   so the server can skip sending the body if it hasn't changed. Empty values aren't sent.
+   /// </summary>
+   struct ResponseValidators
+   {
+      std::string etag{};
+      std::string last_modified{};
+   };
+
+
+   /// <summary>
+   ///   response to a conditional request. If not_modified is true the server confirmed the previous response
+   ///   is still current, and json is empty.
+   /// </summary>
+   struct ConditionalResponse
+   {
+      bool not_modified{};
+      std::string json{};
+      ResponseValidators validators{};
+   };
+
+
+   /// <summary>
+   ///   concept for a data provider that supports conditional requests, returning an empty "not modified"
+   ///   response instead of the JSON if it hasn't changed since the response the validators came from.
+   /// </summary>
+   template <typename Provider>
+   concept ConditionalDataProvider = DataProvider<Provider> &&
+                                     requires (Provider dp, Provider::ConditionalResult cr, std::map<std::string, std::string> params, ResponseValidators validators)
+   {
+      cr = dp.getJsonDataIfModified("", params, validators);
+   };
+
+
    /// <summary>
    ///   concept for type that can represent a null value (in other worsds, std::optional<>) 
    /// </summary>
@@ -22,6 +22,10 @@ namespace oura_charts::constants
 
    inline constexpr const char* REST_HEADER_XCLIENT = "X-Client";
    inline constexpr const char* REST_HEADER_XCLIENT_VALUE = "cpr";
+   inline constexpr const char* REST_HEADER_ETAG = "ETag";
+   inline constexpr const char* REST_HEADER_LAST_MODIFIED = "Last-Modified";
+   inline constexpr const char* REST_HEADER_IF_NONE_MATCH = "If-None-Match";
+   inline constexpr const char* REST_HEADER_IF_MODIFIED_SINCE = "If-Modified-Since";
 
    inline constexpr const char* REST_PARAM_AUTH_TOKEN_PREFIX = "Bearer ";
    inline constexpr const char* REST_PARAM_START_DATETIME = "start_datetime";
@@ -0,0 +1,232 @@
+//---------------------------------------------------------------------------------------------------------------------
+// instrumentation.h
+//
+// lightweight counters, histograms and scoped timers for measuring where time goes in the data pipeline.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "oura_charts/oura_charts.h"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/// <summary>
+///    instrumentation-related constants. Metric names are dotted so they sort/group sensibly in output.
+/// </summary>
+namespace oura_charts::constants
+{
+   inline constexpr const char* METRIC_REST_GET = "rest.get";
+   inline constexpr const char* METRIC_REST_RESPONSE_BYTES = "rest.response_bytes";
+   inline constexpr const char* METRIC_REST_WIRE_BYTES = "rest.wire_bytes";
+   inline constexpr const char* METRIC_JSON_PARSE = "json.parse";
+   inline constexpr const char* METRIC_JSON_PARSE_BYTES = "json.parse_bytes";
+   inline constexpr const char* METRIC_SERIES_FETCH = "series.fetch";
+   inline constexpr const char* METRIC_SERIES_PAGES = "series.pages";
+   inline constexpr const char* METRIC_SERIES_RECORDS_PER_PAGE = "series.records_per_page";
+   inline constexpr const char* METRIC_SERIES_RECORDS = "series.records";
+   inline constexpr const char* METRIC_SERIES_GROUP = "series.group";
+   inline constexpr const char* METRIC_SERIES_GROUPED_RECORDS = "series.grouped_records";
+
+} // namespace oura_charts::constants
+
+
+/// <summary>
+///   Namespace that contains the instrumentation layer. If OURACHARTS_INSTRUMENTATION is not defined
+///   (or defined as 0) at compile time, all of the recording functions compile to no-ops.
+/// </summary>
+namespace oura_charts::instrumentation
+{
+#if defined(OURACHARTS_INSTRUMENTATION) && OURACHARTS_INSTRUMENTATION
+   inline constexpr bool ENABLED = true;
+#else
+   inline constexpr bool ENABLED = false;
+#endif
+
+   /// <summary>
+   ///   unit of the values recorded for a metric, used for display purposes.
+   /// </summary>
+   enum class MetricUnit
+   {
+      Count,
+      Bytes,
+      Nanoseconds
+   };
+
+
+   /// <summary>
+   ///   monotonic counter that can be safely incremented from multiple threads.
+   /// </summary>
+   class Counter
+   {
+   public:
+      void add(uint64_t val = 1) noexcept
+      {
+         if constexpr (ENABLED)
+            m_value.fetch_add(val, std::memory_order_relaxed);
+      }
+
+      uint64_t value() const noexcept
+      {
+         return m_value.load(std::memory_order_relaxed);
+      }
+
+      void reset() noexcept
+      {
+         m_value.store(0, std::memory_order_relaxed);
+      }
+
+   private:
+      std::atomic<uint64_t> m_value{};
+   };
+
+
+   /// <summary>
+   ///   thread-safe histogram that tracks count/sum/min/max along with power-of-2 buckets, which
+   ///   is plenty of resolution for figuring out the order of magnitude of things.
+   /// </summary>
+   class Histogram
+   {
+   public:
+      static inline constexpr size_t BUCKET_COUNT = std::numeric_limits<uint64_t>::digits + 1;
+
+      void record(uint64_t val) noexcept
+      {
+         if constexpr (ENABLED)
+         {
+            m_count.fetch_add(1, std::memory_order_relaxed);
+            m_sum.fetch_add(val, std::memory_order_relaxed);
+            m_buckets[static_cast<size_t>(std::bit_width(val))].fetch_add(1, std::memory_order_relaxed);
+
+            auto cur_min = m_min.load(std::memory_order_relaxed);
+            while (val < cur_min && !m_min.compare_exchange_weak(cur_min, val, std::memory_order_relaxed)) {}
+
+            auto cur_max = m_max.load(std::memory_order_relaxed);
+            while (val > cur_max && !m_max.compare_exchange_weak(cur_max, val, std::memory_order_relaxed)) {}
+         }
+      }
+
+      uint64_t count() const noexcept   { return m_count.load(std::memory_order_relaxed); }
+      uint64_t sum() const noexcept     { return m_sum.load(std::memory_order_relaxed);   }
+      uint64_t min() const noexcept     { return count() ? m_min.load(std::memory_order_relaxed) : 0; }
+      uint64_t max() const noexcept     { return m_max.load(std::memory_order_relaxed);   }
+
+      // number of recorded values 'v' where bit_width(v) == idx, eg in the range [2^(idx-1), 2^idx)
+      uint64_t bucket(size_t idx) const noexcept { return m_buckets.at(idx).load(std::memory_order_relaxed); }
+
+      void reset() noexcept;
+
+   private:
+      std::atomic<uint64_t> m_count{};
+      std::atomic<uint64_t> m_sum{};
+      std::atomic<uint64_t> m_min{ std::numeric_limits<uint64_t>::max() };
+      std::atomic<uint64_t> m_max{};
+      std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_buckets{};
+   };
+
+
+   /// <summary>
+   ///   RAII timer that records the elapsed time (in nanoseconds) of its scope to a histogram
+   ///   when destroyed. When instrumentation is disabled the clock is never read.
+   /// </summary>
+   class ScopedTimer
+   {
+   public:
+      using clock = std::chrono::steady_clock;
+
+      explicit ScopedTimer(Histogram& hist) noexcept : m_hist{ hist }
+      {
+         if constexpr (ENABLED)
+            m_start = clock::now();
+      }
+
+      ~ScopedTimer()
+      {
+         if constexpr (ENABLED)
+         {
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - m_start);
+            m_hist.record(static_cast<uint64_t>(elapsed.count()));
+         }
+      }
+
+      ScopedTimer(const ScopedTimer&) = delete;
+      ScopedTimer(ScopedTimer&&) = delete;
+      ScopedTimer& operator=(const ScopedTimer&) = delete;
+      ScopedTimer& operator=(ScopedTimer&&) = delete;
+
+   private:
+      Histogram& m_hist;
+      clock::time_point m_start{};
+   };
+
+
+   /// <summary>
+   ///   Get the named counter, creating it if it doesn't exist yet. The returned reference is valid for the
+   ///   lifetime of the program, so call sites should look it up once and cache it (eg in a function-local static).
+   /// </summary>
+   [[nodiscard]] Counter& counter(std::string_view name);
+
+
+   /// <summary>
+   ///   Get the named histogram, creating it if it doesn't exist yet. The returned reference is valid for the
+   ///   lifetime of the program, so call sites should look it up once and cache it (eg in a function-local static).
+   /// </summary>
+   [[nodiscard]] Histogram& histogram(std::string_view name, MetricUnit unit = MetricUnit::Count);
+
+
+   /// <summary>
+   ///   Get the named timer, which is just a histogram of nanosecond values intended for use with ScopedTimer.
+   /// </summary>
+   [[nodiscard]] inline Histogram& timer(std::string_view name)
+   {
+      return histogram(name, MetricUnit::Nanoseconds);
+   }
+
+
+   /// <summary>
+   ///   point-in-time copy of a single metric's values.
+   /// </summary>
+   struct MetricSnapshot
+   {
+      std::string name{};
+      MetricUnit unit{ MetricUnit::Count };
+      uint64_t count{};
+      uint64_t sum{};
+      uint64_t min{};
+      uint64_t max{};
+
+      double average() const noexcept
+      {
+         return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0;
+      }
+   };
+
+
+   /// <summary>
+   ///   returns a snapshot of all metrics that have been recorded, sorted by name. Counters are
+   ///   reported with count == sum == value. Metrics that have no recorded values are skipped.
+   /// </summary>
+   [[nodiscard]] std::vector<MetricSnapshot> snapshot();
+
+
+   /// <summary>
+   ///   returns the snapshot() formatted as a JSON array, suitable for dumping to a file and comparing between runs.
+   /// </summary>
+   [[nodiscard]] std::string snapshotToJson();
+
+
+   /// <summary>
+   ///   reset all metrics to zero, for example at the start of a new run.
+   /// </summary>
+   void reset();
+
+} // namespace oura_charts::instrumentation
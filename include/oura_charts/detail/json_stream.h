@@ -0,0 +1,192 @@
+//---------------------------------------------------------------------------------------------------------------------
+// json_stream.h
+//
+// Incremental parsing of paged REST responses, so records can be handled as the bytes arrive instead of after the
+// whole page has been buffered.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "oura_charts/oura_charts.h"
+#include "oura_charts/detail/json_structs.h"
+#include <concepts>
+#include <string>
+#include <string_view>
+
+
+namespace oura_charts::detail
+{
+   /// <summary>
+   ///   State machine that splits the JSON for a page of REST data into its individual data[] records, as
+   ///   the text is received in arbitrarily-sized chunks.
+   /// </summary>
+   /// <remarks>
+   ///   Only the structure of the JSON is tracked here (nesting, strings and escapes). Each complete record is
+   ///   handed to a sink as a string_view, and is only copied if it spans more than one chunk. Everything outside
+   ///   the data[] array is kept so finish() can extract the next_token. That means memory use is bounded by the
+   ///   size of the largest record rather than the size of the page.
+   /// </remarks>
+   class JsonPageSplitter
+   {
+   public:
+      /// <summary>
+      ///   process the next chunk of JSON text, calling 'sink' with the JSON for each record completed in this
+      ///   chunk. Returns false if the sink returns false or the JSON isn't a valid page, in which case no more
+      ///   chunks should be fed.
+      /// </summary>
+      template <std::predicate<std::string_view> SinkT>
+      bool feed(std::string_view chunk, SinkT&& sink)
+      {
+         if (!m_error.empty())
+            return false;
+
+         m_bytes += chunk.size();
+         size_t record_start{ 0 };
+         for (size_t pos = 0; pos < chunk.size(); ++pos)
+         {
+            const char ch = chunk[pos];
+            const bool in_envelope = !m_in_data;
+
+            if (m_in_string)
+            {
+               if (m_escape)
+                  m_escape = false;
+               else if (ch == '\\')
+                  m_escape = true;
+               else if (ch == '"')
+                  m_in_string = false;
+               else if (m_depth == 1 && in_envelope)
+                  m_key.push_back(ch);
+            }
+            else if (m_in_data && !m_in_record && m_depth == DATA_DEPTH && !isDataToken(ch))
+            {
+               // checked before the string/bracket handling, otherwise a bare string in data[] would be skipped.
+               return fail("data[] array contains a value that isn't an object or array");
+            }
+            else if (ch == '"')
+            {
+               m_in_string = true;
+               if (m_depth == 1)
+                  m_key.clear();
+            }
+            else if (ch == '{' or ch == '[')
+            {
+               if (m_in_data && m_depth == DATA_DEPTH && !m_in_record)
+               {
+                  m_in_record = true;
+                  record_start = pos;
+               }
+               else if (in_envelope && m_depth == 1 && ch == '[' && m_key == constants::JSON_KEY_DATA)
+               {
+                  m_in_data = true;
+               }
+               ++m_depth;
+            }
+            else if (ch == '}' or ch == ']')
+            {
+               if (--m_depth < 0)
+                  return fail("unbalanced brackets");
+
+               if (m_in_record && m_depth == DATA_DEPTH)
+               {
+                  // record is complete, only need to copy it if it started in a previous chunk.
+                  m_in_record = false;
+                  ++m_record_count;
+                  auto record_text = chunk.substr(record_start, pos + 1 - record_start);
+                  bool keep_going{};
+                  if (m_record.empty())
+                  {
+                     keep_going = sink(record_text);
+                  }
+                  else
+                  {
+                     m_record.append(record_text);
+                     keep_going = sink(std::string_view{ m_record });
+                     m_record.clear();
+                  }
+                  if (!keep_going)
+                     return fail("record sink cancelled parsing");
+               }
+               else if (m_in_data && m_depth == 1)
+               {
+                  m_in_data = false;
+                  m_envelope.push_back(ch);
+               }
+            }
+
+            if (in_envelope)
+               m_envelope.push_back(ch);
+         }
+
+         // carry the partial record over to the next chunk
+         if (m_in_record)
+            m_record.append(chunk.substr(record_start));
+
+         return true;
+      }
+
+
+      /// <summary>
+      ///   call after the last chunk has been fed. Returns the page's next_token (nullopt if there are no more
+      ///   pages), or an error if the page JSON was incomplete or invalid.
+      /// </summary>
+      [[nodiscard]] ParseResult<nullable_string> finish()
+      {
+         if (!m_error.empty())
+            return unexpected{ oura_exception{ ErrorCategory::Parse, "JsonPageSplitter - {}", m_error } };
+
+         if (m_depth != 0 or m_in_string or m_envelope.empty())
+            return unexpected{ oura_exception{ ErrorCategory::Parse, "JsonPageSplitter - incomplete JSON page ({} bytes)", m_bytes } };
+
+         auto envelope = readJson<page_token_data>(m_envelope);
+         if (!envelope)
+            return unexpected{ std::move(envelope.error()) };
+
+         return std::move(envelope.value().next_token);
+      }
+
+
+      // number of records that have been sent to the sink.
+      size_t recordCount() const noexcept { return m_record_count; }
+
+      // number of bytes of JSON that have been fed.
+      size_t bytesProcessed() const noexcept { return m_bytes; }
+
+   private:
+      // nesting depth of the data[] array's elements: { "data": [ <here> ] }
+      static inline constexpr int DATA_DEPTH = 2;
+
+      int m_depth{};
+      bool m_in_string{};
+      bool m_escape{};
+      bool m_in_data{};
+      bool m_in_record{};
+      std::string m_key{};
+      std::string m_record{};
+      std::string m_envelope{};
+      std::string m_error{};
+      size_t m_record_count{};
+      size_t m_bytes{};
+
+      bool fail(std::string_view reason)
+      {
+         m_error = reason;
+         return false;
+      }
+
+      static constexpr bool isWhitespace(char ch) noexcept
+      {
+         return ch == ' ' or ch == '\n' or ch == '\r' or ch == '\t';
+      }
+
+      // characters that can appear between records in the data[] array: the start of an object/array record,
+      // a separator, or the end of the array.
+      static constexpr bool isDataToken(char ch) noexcept
+      {
+         return ch == '{' or ch == '[' or ch == ']' or ch == ',' or isWhitespace(ch);
+      }
+   };
+
+} // namespace oura_charts::detail
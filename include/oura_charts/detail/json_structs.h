@@ -10,10 +10,15 @@
 
 #include "oura_charts/oura_charts.h"
 #include "oura_charts/chrono_helpers.h"
+#include "oura_charts/EnumArray.h"
+#include "oura_charts/detail/instrumentation.h"
 #include <glaze/glaze.hpp>
+#include <concepts>
 #include <map>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace oura_charts::detail
@@ -51,11 +56,22 @@ namespace oura_charts::detail
    ///   whether there is more data available to fullfill the request (in case
    ///   of a very large number of data structs, paging may be used).
    /// </remarks>
-   template<typename T>
+   template<typename T, typename AllocatorT = std::allocator<T>>
    struct RestDataCollection
    {
       using value_type = T;
-      std::vector<value_type> data{};
+      using DataVector = std::vector<value_type, AllocatorT>;
+      DataVector data{};
+      nullable_string next_token{};
+   };
+
+
+   /// <summary>
+   ///   just the next_token from a page of REST data. Reading a page into this skips over the data array without
+   ///   parsing it, so the next page can be requested before the current one has been parsed.
+   /// </summary>
+   struct page_token_data
+   {
       nullable_string next_token{};
    };
 
@@ -68,6 +84,8 @@ namespace oura_charts::detail
       int bpm{};
       std::string source{};
       local_seconds timestamp{};
+
+      bool operator==(const hr_data&) const = default;
    };
 
 
@@ -96,13 +114,17 @@ namespace oura_charts::detail
          resting_heart_rate,
          sleep_balance
       };
+      static inline constexpr size_t READINESS_CONTRIBUTOR_COUNT = 8;
+      using ReadinessContributorArray = EnumArray<ReadinessContributors, int, READINESS_CONTRIBUTOR_COUNT>;
 
       struct readiness_data
       {
-         std::map<ReadinessContributors, int> contributors{};
+         ReadinessContributorArray contributors{};
          int score{};
          nullable_double temperature_deviation{};
          nullable_double temperature_trend_deviation{};
+
+         bool operator==(const readiness_data&) const = default;
       };
 
       struct interval_data
@@ -110,6 +132,8 @@ namespace oura_charts::detail
          chrono::seconds interval{};
          std::vector<nullable_double> items;
          local_seconds timeststamp{};
+
+         bool operator==(const interval_data&) const = default;
       };
 
       std::string id{};
@@ -146,6 +170,134 @@ namespace oura_charts::detail
       readiness_data readiness{};
       nullable_uint readiness_score_delta{};
       nullable_uint sleep_score_delta{};
+
+      bool operator==(const sleep_data&) const = default;
+   };
+
+
+   /// <summary>
+   ///   Subset of sleep_data with just the summary values for a sleep session. Parsing into this struct skips
+   ///   over the large members of the JSON (interval data, movement/sleep phase strings and the readiness
+   ///   contributors) instead of decoding them, see SleepSessionSummary.
+   /// </summary>
+   struct sleep_summary_data
+   {
+      using SleepType = sleep_data::SleepType;
+
+      struct readiness_data
+      {
+         int score{};
+         nullable_double temperature_deviation{};
+         nullable_double temperature_trend_deviation{};
+
+         bool operator==(const readiness_data&) const = default;
+      };
+
+      std::string id{};
+      SleepType type{};
+      int period{};
+
+      year_month_day day{};
+      local_seconds bedtime_start{};
+      local_seconds bedtime_end{};
+
+      nullable_double average_breath{};
+      nullable_double average_heart_rate{};
+      nullable_uint lowest_heart_rate{};
+      nullable_double average_hrv{};
+
+      int efficiency{};
+      chrono::seconds latency{};
+      nullable_uint restless_periods{};
+
+      chrono::seconds time_in_bed{};
+      chrono::seconds awake_time{};
+      chrono::seconds total_sleep_duration{};
+      chrono::seconds light_sleep_duration{};
+      chrono::seconds deep_sleep_duration{};
+      chrono::seconds rem_sleep_duration{};
+
+      readiness_data readiness{};
+
+      bool operator==(const sleep_summary_data&) const = default;
+   };
+
+
+   /// <summary>
+   ///   move the values from a sleep_summary_data into a sleep_data. Members that aren't in the summary are
+   ///   left empty.
+   /// </summary>
+   [[nodiscard]] inline sleep_data toSleepData(sleep_summary_data&& summary) noexcept
+   {
+      sleep_data data{};
+      data.id = std::move(summary.id);
+      data.type = summary.type;
+      data.period = summary.period;
+      data.day = summary.day;
+      data.bedtime_start = summary.bedtime_start;
+      data.bedtime_end = summary.bedtime_end;
+      data.average_breath = summary.average_breath;
+      data.average_heart_rate = summary.average_heart_rate;
+      data.lowest_heart_rate = summary.lowest_heart_rate;
+      data.average_hrv = summary.average_hrv;
+      data.efficiency = summary.efficiency;
+      data.latency = summary.latency;
+      data.restless_periods = summary.restless_periods;
+      data.time_in_bed = summary.time_in_bed;
+      data.awake_time = summary.awake_time;
+      data.total_sleep_duration = summary.total_sleep_duration;
+      data.light_sleep_duration = summary.light_sleep_duration;
+      data.deep_sleep_duration = summary.deep_sleep_duration;
+      data.rem_sleep_duration = summary.rem_sleep_duration;
+      data.readiness.score = summary.readiness.score;
+      data.readiness.temperature_deviation = summary.readiness.temperature_deviation;
+      data.readiness.temperature_trend_deviation = summary.readiness.temperature_trend_deviation;
+      return data;
+   }
+
+
+   /// <summary>
+   ///   JSON layout of sleep_data::ReadinessContributorArray. Only used on the stack while reading/writing
+   ///   the array, since the JSON is an object rather than an array.
+   /// </summary>
+   struct readiness_contributors_json
+   {
+      nullable_int activity_balance{};
+      nullable_int body_temperature{};
+      nullable_int hrv_balance{};
+      nullable_int previous_day_activity{};
+      nullable_int previous_night{};
+      nullable_int recovery_index{};
+      nullable_int resting_heart_rate{};
+      nullable_int sleep_balance{};
+
+      [[nodiscard]] sleep_data::ReadinessContributorArray toArray() const noexcept
+      {
+         using enum sleep_data::ReadinessContributors;
+         sleep_data::ReadinessContributorArray contributors{};
+         contributors.set(activity_balance, this->activity_balance);
+         contributors.set(body_temperature, this->body_temperature);
+         contributors.set(hrv_balance, this->hrv_balance);
+         contributors.set(previous_day_activity, this->previous_day_activity);
+         contributors.set(previous_night, this->previous_night);
+         contributors.set(recovery_index, this->recovery_index);
+         contributors.set(resting_heart_rate, this->resting_heart_rate);
+         contributors.set(sleep_balance, this->sleep_balance);
+         return contributors;
+      }
+
+      [[nodiscard]] static readiness_contributors_json fromArray(const sleep_data::ReadinessContributorArray& contributors) noexcept
+      {
+         using enum sleep_data::ReadinessContributors;
+         return readiness_contributors_json{ .activity_balance = contributors.get(activity_balance),
+                                             .body_temperature = contributors.get(body_temperature),
+                                             .hrv_balance = contributors.get(hrv_balance),
+                                             .previous_day_activity = contributors.get(previous_day_activity),
+                                             .previous_night = contributors.get(previous_night),
+                                             .recovery_index = contributors.get(recovery_index),
+                                             .resting_heart_rate = contributors.get(resting_heart_rate),
+                                             .sleep_balance = contributors.get(sleep_balance) };
+      }
    };
 
 
@@ -160,6 +312,8 @@ namespace oura_charts::detail
          int restfulness{};
          int timing{};
          int total_sleep{};
+
+         bool operator==(const SleepScoreContributors&) const = default;
       };
 
       std::string id{};
@@ -167,6 +321,21 @@ namespace oura_charts::detail
       int score{};
       SleepScoreContributors contributors{};
       local_seconds timestamp{};
+
+      bool operator==(const daily_sleep_data&) const = default;
+   };
+
+
+   /// <summary>
+   ///   one line of a recording's index, describing a response saved by RecordingDataProvider. The body is
+   ///   saved separately in body_file (relative to the recording folder), exactly as it was received.
+   /// </summary>
+   struct recorded_request
+   {
+      std::string path{};
+      std::map<std::string, std::string> params{};
+      int64_t latency_us{};
+      std::string body_file{};
    };
 
    /// <summary>
@@ -177,33 +346,130 @@ namespace oura_charts::detail
    using ParseResult = expected<T, oura_exception>;
 
 
+   // glaze options used when reading REST data. The API adds fields from time to time, so unknown keys are skipped
+   // rather than treated as errors.
+   inline constexpr glz::opts GLAZE_READ_OPTS{ .error_on_unknown_keys = false };
+
+
+   /// <summary>
+   ///   JSON backend that decodes the data structs with glaze.
+   /// </summary>
+   /// <remarks>
+   ///   A JSON backend is a class with a static NAME and a static read<ValueT>(buffer, value) function that decodes
+   ///   'buffer' into 'value' and returns a ParseResult. Backends are selected per call by passing one to
+   ///   readJson(), or for the whole build with DefaultJsonBackend.
+   /// </remarks>
+   struct GlazeBackend
+   {
+      static inline constexpr std::string_view NAME = "glaze";
+
+      template <typename ValueT, glz::opts Opts = GLAZE_READ_OPTS, StringViewCompatible StringT>
+      [[nodiscard]] static ParseResult<ValueT> read(StringT&& buffer, ValueT value) noexcept
+      {
+         auto&& pe = glz::read<Opts>(value, buffer);
+         if (pe)
+            return unexpected(oura_exception{ static_cast<int64_t>(pe.ec), glz::format_error(pe, buffer), ErrorCategory::Parse });
+         else
+            return value;
+      }
+   };
+
+
+   /// <summary>
+   ///   concept for a JSON backend class (see GlazeBackend)
+   /// </summary>
+   template <typename BackendT>
+   concept JsonBackend = requires { { BackendT::NAME } -> std::convertible_to<std::string_view>; };
+
+
+   /// <summary>
+   ///   concept for a JSON backend that can decode the specified type.
+   /// </summary>
+   template <typename BackendT, typename ValueT>
+   concept JsonBackendFor = JsonBackend<BackendT> and requires (std::string_view buffer, ValueT value)
+   {
+      { BackendT::template read<ValueT>(buffer, std::move(value)) } -> std::same_as<ParseResult<ValueT>>;
+   };
+
+
+   // the backend used by readJson() when one isn't specified, set by the OURACHARTS_JSON_BACKEND cmake option. Types
+   // the default backend can't decode fall back to glaze.
+#if defined(OURACHARTS_JSON_BACKEND_SIMDJSON) && OURACHARTS_JSON_BACKEND_SIMDJSON
+   struct SimdjsonBackend;
+   using DefaultJsonBackend = SimdjsonBackend;
+#else
+   using DefaultJsonBackend = GlazeBackend;
+#endif
+
+
+   /// <summary>
+   ///   read JSON text into a struct with the specified backend, and return an expected<> for the value (or error), eg:
+   ///
+   ///      auto res = readJson<RestDataCollection<hr_data>>(json, {}, SimdjsonBackend{});
+   /// </summary>
+   /// <remarks>
+   ///   'value' is the object the JSON is read into, which lets the caller supply an object that's been constructed
+   ///   with a specific allocator, or one whose capacity can be re-used.
+   /// </remarks>
+   template <typename ValueT, JsonBackend BackendT, StringViewCompatible StringT> requires JsonBackendFor<BackendT, ValueT>
+   [[nodiscard]] inline ParseResult<ValueT> readJson(StringT&& buffer, ValueT value, BackendT) noexcept
+   {
+      static auto& parse_timer = instrumentation::timer(constants::METRIC_JSON_PARSE);
+      static auto& parse_bytes = instrumentation::histogram(constants::METRIC_JSON_PARSE_BYTES, instrumentation::MetricUnit::Bytes);
+      instrumentation::ScopedTimer timer{ parse_timer };
+      parse_bytes.record(std::string_view{ buffer }.size());
+
+      return BackendT::template read<ValueT>(std::forward<StringT>(buffer), std::move(value));
+   }
+
+
    /// <summary>
    ///   wrapper for glz::read<> that returns an expected<> instead of an error code (eliminating the
    ///   need to pass the struct as a parameter or translate any parse_error's returned.
    /// </summary>
+   /// <remarks>
+   ///   this always uses glaze, regardless of the default backend, since the options are glaze-specific.
+   /// </remarks>
    template <glz::opts Opts, typename ValueT, StringViewCompatible StringT>
-   [[nodiscard]] inline ParseResult<ValueT> readJson(StringT&& buffer) noexcept
+   [[nodiscard]] inline ParseResult<ValueT> readJson(StringT&& buffer, ValueT value = ValueT{}) noexcept
    {
-      ValueT value{};
-      auto&& pe = glz::read<Opts>(value, buffer);
-      if (pe)
-         return unexpected(oura_exception{ static_cast<int64_t>(pe.ec), glz::format_error(pe, buffer), ErrorCategory::Parse });
-      else
-         return value;
+      static auto& parse_timer = instrumentation::timer(constants::METRIC_JSON_PARSE);
+      static auto& parse_bytes = instrumentation::histogram(constants::METRIC_JSON_PARSE_BYTES, instrumentation::MetricUnit::Bytes);
+      instrumentation::ScopedTimer timer{ parse_timer };
+      parse_bytes.record(std::string_view{ buffer }.size());
+
+      return GlazeBackend::read<ValueT, Opts>(std::forward<StringT>(buffer), std::move(value));
    }
 
 
    /// <summary>
-   ///   wrapper for glz::read<> that sets the "error_on_unknown_keys" compile-time option and returns
-   ///   an expected<> for the value (or error).
+   ///   read JSON text into a struct using the default backend, and return an expected<> for the value (or error).
    /// </summary>
    /// <remarks>
    ///   if you want to explicitly set glz compile-time options, use the other overload.
    /// <remarks>
    template <typename ValueT, StringViewCompatible StringT>
-   [[nodiscard]] inline ParseResult<ValueT> readJson(StringT&& buffer) noexcept
+   [[nodiscard]] inline ParseResult<ValueT> readJson(StringT&& buffer, ValueT value = ValueT{}) noexcept
    {
-      return readJson < glz::opts{ .error_on_unknown_keys = false }, ValueT > (buffer);
+      using BackendT = std::conditional_t<JsonBackendFor<DefaultJsonBackend, ValueT>, DefaultJsonBackend, GlazeBackend>;
+      return readJson<ValueT>(std::forward<StringT>(buffer), std::move(value), BackendT{});
+   }
+
+
+   /// <summary>
+   ///   get the next_token from a page of REST data without parsing the rest of it.
+   /// </summary>
+   /// <remarks>
+   ///   This doesn't record the parse metrics, since the page will still be parsed (and measured) separately.
+   /// </remarks>
+   template <StringViewCompatible StringT>
+   [[nodiscard]] inline ParseResult<nullable_string> readNextToken(StringT&& buffer) noexcept
+   {
+      auto page = GlazeBackend::read<page_token_data>(std::forward<StringT>(buffer), page_token_data{});
+      if (!page)
+         return unexpected(std::move(page.error()));
+      else
+         return std::move(page.value().next_token);
    }
 
 } // namespace oura_charts::detail
@@ -248,6 +514,29 @@ namespace glz::detail
       }
    };
 
+   template <>
+   struct from_json<oc::detail::sleep_data::ReadinessContributorArray>
+   {
+      template <auto Opts>
+      static void op(oc::detail::sleep_data::ReadinessContributorArray& value, is_context auto&& ctx, auto&&... args)
+      {
+         oc::detail::readiness_contributors_json contributors{};
+         read<json>::op<Opts>(contributors, ctx, args...);
+         if (glz::error_code::none == ctx.error)
+            value = contributors.toArray();
+      }
+   };
+
+   template <>
+   struct to_json<oc::detail::sleep_data::ReadinessContributorArray>
+   {
+      template <auto Opts>
+      static void op(const oc::detail::sleep_data::ReadinessContributorArray& value, is_context auto&& ctx, auto&&... args)
+      {
+         write<json>::op<Opts>(oc::detail::readiness_contributors_json::fromArray(value), ctx, args...);
+      }
+   };
+
    template <>
    struct from_json<oc::chrono::seconds>
    {
@@ -290,3 +579,8 @@ struct glz::meta<oura_charts::detail::sleep_data::ReadinessContributors>
          sleep_balance
    );
 };
+
+
+#if defined(OURACHARTS_SIMDJSON) && OURACHARTS_SIMDJSON
+#include "oura_charts/detail/simdjson_backend.h"
+#endif
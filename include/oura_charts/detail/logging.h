@@ -11,6 +11,7 @@
 #include "oura_charts/oura_charts.h"
 #include "oura_charts/detail/utility.h"
 #include <spdlog/spdlog.h>
+#include <spdlog/async.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/daily_file_sink.h>
 #include <spdlog/sinks/msvc_sink.h>
@@ -33,6 +34,8 @@ namespace oura_charts::logging
    namespace sinks = spdlog::sinks;
    namespace log_level = spdlog::level;
    using spdlog::logger;
+   using spdlog::async_logger;
+   using spdlog::async_overflow_policy;
    using spdlog::source_loc;
    using spdlog::level::level_enum;
    using spdlog::sinks::daily_file_sink_mt;
@@ -44,6 +47,7 @@ namespace oura_charts::logging
    using spdlog::error;
    using spdlog::warn;
    using spdlog::info;
+   using spdlog::debug;
    using spdlog::trace;
    using spdlog::critical;
    using log_ptr_t = std::shared_ptr<logger>;
@@ -65,6 +69,13 @@ namespace oura_charts::constants
    inline constexpr const char* CONFIG_DEFAULT_LOG_PATTERN_FILE = "[%Y-%m-%d %H:%M:%S.%e] [%s:%#] [%^%l%$] %v";
    inline constexpr const char* CONFIG_DEFAULT_LOG_PATTERN_DEBUGGER = "[%Y-%m-%d %H:%M:%S.%e] [%s:%#] [%^%l%$] %v";
 
+   inline constexpr size_t CONFIG_DEFAULT_LOG_ASYNC_QUEUE_SIZE = 8192;
+   inline constexpr size_t CONFIG_DEFAULT_LOG_ASYNC_THREAD_COUNT = 1;
+   inline constexpr auto CONFIG_DEFAULT_LOG_ASYNC_OVERFLOW_POLICY = oura_charts::logging::async_overflow_policy::overrun_oldest;
+
+   // max number of characters of a response body that will be included in log output.
+   inline constexpr size_t CONFIG_DEFAULT_LOG_BODY_PREVIEW_LENGTH = 256;
+
    #if !defined(NDEBUG)
       inline constexpr auto CONFIG_DEFAULT_LOGLEVEL_DAILYFILE = oura_charts::logging::level_enum::trace;
       inline constexpr auto CONFIG_DEFAULT_LOGLEVEL_CONSOLE = oura_charts::logging::level_enum::warn;
@@ -155,6 +166,52 @@ namespace oura_charts::logging
    [[nodiscard]] sinks_init_list::value_type makeDebuggerSync();
 
 
+   /// <summary>
+   ///   wrapper for logging a potentially large block of text (such as a REST response body) without
+   ///   dumping the whole thing into the log. Formatting is lazy, so the hash and preview are only computed
+   ///   if the message actually gets logged.
+   /// </summary>
+   struct TextSummary
+   {
+      std::string_view text{};
+      size_t max_preview{ constants::CONFIG_DEFAULT_LOG_BODY_PREVIEW_LENGTH };
+   };
+
+   /// <summary>
+   ///   custom format() support for TextSummary, outputs the length, hash, and a size-capped preview of the text.
+   /// </summary>
+   inline auto format_as(const TextSummary& summary)
+   {
+      const auto preview = summary.text.substr(0, summary.max_preview);
+      return fmt::format("{} bytes, hash={:016X}, text='{}'{}",
+                         summary.text.size(),
+                         detail::hashText(summary.text),
+                         preview,
+                         preview.size() < summary.text.size() ? "..." : "");
+   }
+
+
+   /// <summary>
+   ///   options for creating a logger that formats and writes messages on a background thread pool,
+   ///   instead of on the thread that does the logging.
+   /// </summary>
+   /// <remarks>
+   ///   the thread pool is shared by all async loggers, so the queue_size/thread_count of the first
+   ///   async logger created are the ones that will be used.
+   /// </remarks>
+   struct AsyncLogOptions
+   {
+      // max number of messages that can be queued before overflow_policy kicks in.
+      size_t queue_size{ constants::CONFIG_DEFAULT_LOG_ASYNC_QUEUE_SIZE };
+
+      // number of background threads used for writing to the sinks.
+      size_t thread_count{ constants::CONFIG_DEFAULT_LOG_ASYNC_THREAD_COUNT };
+
+      // what to do when the queue is full: block the caller, or drop messages.
+      async_overflow_policy overflow_policy{ constants::CONFIG_DEFAULT_LOG_ASYNC_OVERFLOW_POLICY };
+   };
+
+
    struct LogFactory
    {
       /// <summary>
@@ -192,6 +249,26 @@ namespace oura_charts::logging
       ///   filter on a sink is in addition to the max_level.
       /// </remarks>
       static log_ptr_t makeDefault(sinks_init_list sinks = { makeConsoleSink(), makeDailyFileSink() }, log_level::level_enum max_level = level_enum::trace);
+
+
+      /// <summary>
+      ///   creates a logger instance backed by the shared async thread pool that is not registered with spdlog and
+      ///   can only be used through the returned object.
+      /// </summary>
+      [[nodiscard]] static log_ptr_t makePrivateAsync(std::string_view log_name, sinks_init_list sinks, log_level::level_enum max_level, const AsyncLogOptions& options = {});
+
+
+      /// <summary>
+      ///   same as makeDefault(), except the logger doesn't block the calling thread for formatting or I/O.
+      ///   Messages are queued and written to the sinks from a background thread pool.
+      /// </summary>
+      /// <remarks>
+      ///   if the queue fills up, options.overflow_policy determines whether the caller blocks or
+      ///   messages get dropped.
+      /// </remarks>
+      static log_ptr_t makeDefaultAsync(const AsyncLogOptions& options = {},
+                                        sinks_init_list sinks = { makeConsoleSink(), makeDailyFileSink() },
+                                        log_level::level_enum max_level = level_enum::trace);
    };
 
 } //  namespace oura_charts
@@ -0,0 +1,489 @@
+//---------------------------------------------------------------------------------------------------------------------
+// simdjson_backend.h
+//
+// JSON backend that decodes the data structs with the simdjson On-Demand API. Only available when the library is
+// built with OURACHARTS_ENABLE_SIMDJSON, this header is included by json_structs.h in that case.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "oura_charts/detail/json_structs.h"
+#include <simdjson.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace oura_charts::detail
+{
+   namespace ondemand = simdjson::ondemand;
+
+
+   /// <summary>
+   ///   binds a JSON key to a data member, see simdjson_fields<>.
+   /// </summary>
+   template <typename ClassT, typename MemberT>
+   struct json_field
+   {
+      using ClassType = ClassT;
+      using MemberType = MemberT;
+
+      std::string_view name;
+      MemberT ClassT::* member;
+   };
+
+
+   /// <summary>
+   ///   Specialize this for a struct to make it decodable by SimdjsonBackend. The specialization needs a static
+   ///   constexpr 'value' member that's a std::tuple of json_field's. The keys are the same as the member names,
+   ///   which is what glaze uses, so both backends decode the same JSON the same way.
+   /// </summary>
+   template <typename T>
+   struct simdjson_fields;
+
+
+   /// <summary>
+   ///   concept for a struct that has a simdjson_fields<> specialization.
+   /// </summary>
+   template <typename T>
+   concept SimdjsonStruct = requires { std::tuple_size<std::remove_cvref_t<decltype(simdjson_fields<T>::value)>>::value; };
+
+
+   template <>
+   struct simdjson_fields<profile_data>
+   {
+      using T = profile_data;
+      static inline constexpr auto value = std::make_tuple(json_field{ "id", &T::id },
+                                                           json_field{ "email", &T::email },
+                                                           json_field{ "age", &T::age },
+                                                           json_field{ "weight", &T::weight },
+                                                           json_field{ "height", &T::height },
+                                                           json_field{ "biological_sex", &T::biological_sex });
+   };
+
+   template <typename ValueT, typename AllocatorT>
+   struct simdjson_fields<RestDataCollection<ValueT, AllocatorT>>
+   {
+      using T = RestDataCollection<ValueT, AllocatorT>;
+      static inline constexpr auto value = std::make_tuple(json_field{ "data", &T::data },
+                                                           json_field{ "next_token", &T::next_token });
+   };
+
+   template <>
+   struct simdjson_fields<page_token_data>
+   {
+      using T = page_token_data;
+      static inline constexpr auto value = std::make_tuple(json_field{ "next_token", &T::next_token });
+   };
+
+   template <>
+   struct simdjson_fields<hr_data>
+   {
+      using T = hr_data;
+      static inline constexpr auto value = std::make_tuple(json_field{ "bpm", &T::bpm },
+                                                           json_field{ "source", &T::source },
+                                                           json_field{ "timestamp", &T::timestamp });
+   };
+
+   template <>
+   struct simdjson_fields<sleep_data::readiness_data>
+   {
+      using T = sleep_data::readiness_data;
+      static inline constexpr auto value = std::make_tuple(json_field{ "contributors", &T::contributors },
+                                                           json_field{ "score", &T::score },
+                                                           json_field{ "temperature_deviation", &T::temperature_deviation },
+                                                           json_field{ "temperature_trend_deviation", &T::temperature_trend_deviation });
+   };
+
+   template <>
+   struct simdjson_fields<sleep_data::interval_data>
+   {
+      using T = sleep_data::interval_data;
+      static inline constexpr auto value = std::make_tuple(json_field{ "interval", &T::interval },
+                                                           json_field{ "items", &T::items },
+                                                           json_field{ "timeststamp", &T::timeststamp });
+   };
+
+   template <>
+   struct simdjson_fields<sleep_data>
+   {
+      using T = sleep_data;
+      static inline constexpr auto value = std::make_tuple(json_field{ "id", &T::id },
+                                                           json_field{ "type", &T::type },
+                                                           json_field{ "period", &T::period },
+                                                           json_field{ "day", &T::day },
+                                                           json_field{ "bedtime_start", &T::bedtime_start },
+                                                           json_field{ "bedtime_end", &T::bedtime_end },
+                                                           json_field{ "average_breath", &T::average_breath },
+                                                           json_field{ "heart_rate", &T::heart_rate },
+                                                           json_field{ "average_heart_rate", &T::average_heart_rate },
+                                                           json_field{ "lowest_heart_rate", &T::lowest_heart_rate },
+                                                           json_field{ "hrv", &T::hrv },
+                                                           json_field{ "average_hrv", &T::average_hrv },
+                                                           json_field{ "efficiency", &T::efficiency },
+                                                           json_field{ "latency", &T::latency },
+                                                           json_field{ "restless_periods", &T::restless_periods },
+                                                           json_field{ "movement_30_sec", &T::movement_30_sec },
+                                                           json_field{ "sleep_phase_5_min", &T::sleep_phase_5_min },
+                                                           json_field{ "time_in_bed", &T::time_in_bed },
+                                                           json_field{ "awake_time", &T::awake_time },
+                                                           json_field{ "total_sleep_duration", &T::total_sleep_duration },
+                                                           json_field{ "light_sleep_duration", &T::light_sleep_duration },
+                                                           json_field{ "deep_sleep_duration", &T::deep_sleep_duration },
+                                                           json_field{ "rem_sleep_duration", &T::rem_sleep_duration },
+                                                           json_field{ "readiness", &T::readiness },
+                                                           json_field{ "readiness_score_delta", &T::readiness_score_delta },
+                                                           json_field{ "sleep_score_delta", &T::sleep_score_delta });
+   };
+
+   template <>
+   struct simdjson_fields<sleep_summary_data::readiness_data>
+   {
+      using T = sleep_summary_data::readiness_data;
+      static inline constexpr auto value = std::make_tuple(json_field{ "score", &T::score },
+                                                           json_field{ "temperature_deviation", &T::temperature_deviation },
+                                                           json_field{ "temperature_trend_deviation", &T::temperature_trend_deviation });
+   };
+
+   template <>
+   struct simdjson_fields<sleep_summary_data>
+   {
+      using T = sleep_summary_data;
+      static inline constexpr auto value = std::make_tuple(json_field{ "id", &T::id },
+                                                           json_field{ "type", &T::type },
+                                                           json_field{ "period", &T::period },
+                                                           json_field{ "day", &T::day },
+                                                           json_field{ "bedtime_start", &T::bedtime_start },
+                                                           json_field{ "bedtime_end", &T::bedtime_end },
+                                                           json_field{ "average_breath", &T::average_breath },
+                                                           json_field{ "average_heart_rate", &T::average_heart_rate },
+                                                           json_field{ "lowest_heart_rate", &T::lowest_heart_rate },
+                                                           json_field{ "average_hrv", &T::average_hrv },
+                                                           json_field{ "efficiency", &T::efficiency },
+                                                           json_field{ "latency", &T::latency },
+                                                           json_field{ "restless_periods", &T::restless_periods },
+                                                           json_field{ "time_in_bed", &T::time_in_bed },
+                                                           json_field{ "awake_time", &T::awake_time },
+                                                           json_field{ "total_sleep_duration", &T::total_sleep_duration },
+                                                           json_field{ "light_sleep_duration", &T::light_sleep_duration },
+                                                           json_field{ "deep_sleep_duration", &T::deep_sleep_duration },
+                                                           json_field{ "rem_sleep_duration", &T::rem_sleep_duration },
+                                                           json_field{ "readiness", &T::readiness });
+   };
+
+   template <>
+   struct simdjson_fields<readiness_contributors_json>
+   {
+      using T = readiness_contributors_json;
+      static inline constexpr auto value = std::make_tuple(json_field{ "activity_balance", &T::activity_balance },
+                                                           json_field{ "body_temperature", &T::body_temperature },
+                                                           json_field{ "hrv_balance", &T::hrv_balance },
+                                                           json_field{ "previous_day_activity", &T::previous_day_activity },
+                                                           json_field{ "previous_night", &T::previous_night },
+                                                           json_field{ "recovery_index", &T::recovery_index },
+                                                           json_field{ "resting_heart_rate", &T::resting_heart_rate },
+                                                           json_field{ "sleep_balance", &T::sleep_balance });
+   };
+
+   template <>
+   struct simdjson_fields<daily_sleep_data::SleepScoreContributors>
+   {
+      using T = daily_sleep_data::SleepScoreContributors;
+      static inline constexpr auto value = std::make_tuple(json_field{ "deep_sleep", &T::deep_sleep },
+                                                           json_field{ "efficiency", &T::efficiency },
+                                                           json_field{ "latency", &T::latency },
+                                                           json_field{ "rem_sleep", &T::rem_sleep },
+                                                           json_field{ "restfulness", &T::restfulness },
+                                                           json_field{ "timing", &T::timing },
+                                                           json_field{ "total_sleep", &T::total_sleep });
+   };
+
+   template <>
+   struct simdjson_fields<daily_sleep_data>
+   {
+      using T = daily_sleep_data;
+      static inline constexpr auto value = std::make_tuple(json_field{ "id", &T::id },
+                                                           json_field{ "day", &T::day },
+                                                           json_field{ "score", &T::score },
+                                                           json_field{ "contributors", &T::contributors },
+                                                           json_field{ "timestamp", &T::timestamp });
+   };
+
+
+   namespace simdjson_decode
+   {
+      using simdjson::error_code;
+
+      template <std::integral T> requires (!std::same_as<T, bool>)
+      error_code decode(ondemand::value& val, T& out) noexcept
+      {
+         if constexpr (std::is_signed_v<T>)
+         {
+            int64_t num{};
+            if (auto ec = val.get_int64().get(num))
+               return ec;
+            if (num < std::numeric_limits<T>::min() or num > std::numeric_limits<T>::max())
+               return simdjson::NUMBER_OUT_OF_RANGE;
+
+            out = static_cast<T>(num);
+         }
+         else
+         {
+            uint64_t num{};
+            if (auto ec = val.get_uint64().get(num))
+               return ec;
+            if (num > std::numeric_limits<T>::max())
+               return simdjson::NUMBER_OUT_OF_RANGE;
+
+            out = static_cast<T>(num);
+         }
+         return simdjson::SUCCESS;
+      }
+
+      inline error_code decode(ondemand::value& val, double& out) noexcept
+      {
+         return val.get_double().get(out);
+      }
+
+      inline error_code decode(ondemand::value& val, std::string& out) noexcept
+      {
+         std::string_view str{};
+         if (auto ec = val.get_string().get(str))
+            return ec;
+
+         out.assign(str);
+         return simdjson::SUCCESS;
+      }
+
+      inline error_code decode(ondemand::value& val, local_seconds& out) noexcept
+      {
+         std::string_view str{};
+         if (auto ec = val.get_string().get(str))
+            return ec;
+
+         auto tp_res = parseIsoDateTime(str);
+         if (!tp_res)
+            return simdjson::INCORRECT_TYPE;
+
+         out = utcToLocal(tp_res.value());
+         return simdjson::SUCCESS;
+      }
+
+      inline error_code decode(ondemand::value& val, year_month_day& out) noexcept
+      {
+         std::string_view str{};
+         if (auto ec = val.get_string().get(str))
+            return ec;
+
+         auto ymd_res = parseIsoDate(str);
+         if (!ymd_res)
+            return simdjson::INCORRECT_TYPE;
+
+         out = ymd_res.value();
+         return simdjson::SUCCESS;
+      }
+
+      inline error_code decode(ondemand::value& val, chrono::seconds& out) noexcept
+      {
+         int64_t sec_count{};
+         if (auto ec = val.get_int64().get(sec_count))
+            return ec;
+
+         out = chrono::seconds{ sec_count };
+         return simdjson::SUCCESS;
+      }
+
+      inline error_code decode(ondemand::value& val, sleep_data::SleepType& out) noexcept
+      {
+         // same names as the glz::meta enumeration
+         using enum sleep_data::SleepType;
+         static constexpr std::array names{ std::pair{ std::string_view{ "rest" }, rest },
+                                            std::pair{ std::string_view{ "late_nap" }, late_nap },
+                                            std::pair{ std::string_view{ "sleep" }, sleep },
+                                            std::pair{ std::string_view{ "long_sleep" }, long_sleep } };
+
+         std::string_view str{};
+         if (auto ec = val.get_string().get(str))
+            return ec;
+
+         auto it = rg::find_if(names, [str] (const auto& name) { return name.first == str; });
+         if (it == names.end())
+            return simdjson::INCORRECT_TYPE;
+
+         out = it->second;
+         return simdjson::SUCCESS;
+      }
+
+      template <typename T>
+      error_code decode(ondemand::value& val, std::optional<T>& out) noexcept;
+
+      template <typename T, typename AllocatorT>
+      error_code decode(ondemand::value& val, std::vector<T, AllocatorT>& out) noexcept;
+
+      template <SimdjsonStruct T>
+      error_code decode(ondemand::value& val, T& out) noexcept;
+
+      inline error_code decode(ondemand::value& val, sleep_data::ReadinessContributorArray& out) noexcept;
+
+
+      template <typename T>
+      error_code decode(ondemand::value& val, std::optional<T>& out) noexcept
+      {
+         bool is_null{};
+         if (auto ec = val.is_null().get(is_null))
+            return ec;
+
+         if (is_null)
+         {
+            out.reset();
+            return simdjson::SUCCESS;
+         }
+         return decode(val, out.emplace());
+      }
+
+
+      template <typename T, typename AllocatorT>
+      error_code decode(ondemand::value& val, std::vector<T, AllocatorT>& out) noexcept
+      {
+         ondemand::array arr{};
+         if (auto ec = val.get_array().get(arr))
+            return ec;
+
+         // appends to whatever's there, so a caller-supplied vector keeps its capacity but should be empty.
+         for (auto elem_res : arr)
+         {
+            ondemand::value elem{};
+            if (auto ec = std::move(elem_res).get(elem))
+               return ec;
+            if (auto ec = decode(elem, out.emplace_back()))
+               return ec;
+         }
+         return simdjson::SUCCESS;
+      }
+
+
+      template <typename T, size_t Idx>
+      error_code decodeMember(ondemand::value& val, T& out) noexcept
+      {
+         return decode(val, out.*(std::get<Idx>(simdjson_fields<T>::value).member));
+      }
+
+
+      template <SimdjsonStruct T>
+      error_code decode(ondemand::value& val, T& out) noexcept
+      {
+         using DecoderFunc = error_code (*)(ondemand::value&, T&) noexcept;
+         constexpr auto& fields = simdjson_fields<T>::value;
+         constexpr size_t field_count = std::tuple_size_v<std::remove_cvref_t<decltype(fields)>>;
+
+         static constexpr auto names = std::apply([] (const auto&... field) { return std::array<std::string_view, field_count>{ field.name... }; }, fields);
+         static constexpr auto decoders = [] <size_t... Idx> (std::index_sequence<Idx...>)
+                                          {
+                                             return std::array<DecoderFunc, field_count>{ &decodeMember<T, Idx>... };
+                                          }(std::make_index_sequence<field_count>{});
+
+         ondemand::object obj{};
+         if (auto ec = val.get_object().get(obj))
+            return ec;
+
+         // the REST API sends fields in the same order every time, and the structs declare them in that order,
+         // so look for each key starting after the last one that matched. Unknown keys are skipped.
+         size_t next_idx{};
+         for (auto field_res : obj)
+         {
+            std::string_view key{};
+            if (auto ec = field_res.unescaped_key().get(key))
+               return ec;
+
+            for (size_t i = 0; i < field_count; ++i)
+            {
+               const size_t idx = (next_idx + i) % field_count;
+               if (names[idx] != key)
+                  continue;
+
+               ondemand::value field_val{};
+               if (auto ec = field_res.value().get(field_val))
+                  return ec;
+               if (auto ec = decoders[idx](field_val, out))
+                  return ec;
+
+               next_idx = idx + 1;
+               break;
+            }
+         }
+         return simdjson::SUCCESS;
+      }
+
+
+      inline error_code decode(ondemand::value& val, sleep_data::ReadinessContributorArray& out) noexcept
+      {
+         readiness_contributors_json contributors{};
+         if (auto ec = decode(val, contributors))
+            return ec;
+
+         out = contributors.toArray();
+         return simdjson::SUCCESS;
+      }
+
+      /// <summary>
+      ///   concept for a type that decode() has an overload for.
+      /// </summary>
+      template <typename T>
+      concept Decodable = requires (ondemand::value& val, T& out) { { decode(val, out) } -> std::same_as<error_code>; };
+
+   } // namespace simdjson_decode
+
+
+   /// <summary>
+   ///   JSON backend that decodes the data structs with the simdjson On-Demand API. See GlazeBackend for the
+   ///   backend interface.
+   /// </summary>
+   /// <remarks>
+   ///   simdjson needs SIMDJSON_PADDING bytes of readable memory past the end of the JSON, so the text is copied
+   ///   into a padded buffer first. The buffer and the parser are thread_local so their memory is re-used from one
+   ///   call to the next, which keeps the copy cheap next to the parse.
+   /// </remarks>
+   struct SimdjsonBackend
+   {
+      static inline constexpr std::string_view NAME = "simdjson";
+
+      template <typename ValueT, StringViewCompatible StringT> requires simdjson_decode::Decodable<ValueT>
+      [[nodiscard]] static ParseResult<ValueT> read(StringT&& buffer, ValueT value) noexcept
+      {
+         const std::string_view json{ buffer };
+
+         thread_local ondemand::parser parser{};
+         thread_local std::string padded{};
+         padded.reserve(json.size() + simdjson::SIMDJSON_PADDING);
+         padded.assign(json);
+
+         auto ec = [&value] () -> simdjson::error_code
+                   {
+                      ondemand::document doc{};
+                      if (auto ec = parser.iterate(padded.data(), padded.size(), padded.capacity()).get(doc))
+                         return ec;
+
+                      ondemand::value root{};
+                      if (auto ec = doc.get_value().get(root))
+                         return ec;
+
+                      return simdjson_decode::decode(root, value);
+                   }();
+
+         if (ec)
+            return unexpected(oura_exception{ static_cast<int64_t>(ec), simdjson::error_message(ec), ErrorCategory::Parse });
+         else
+            return value;
+      }
+   };
+
+} // namespace oura_charts::detail
@@ -7,6 +7,8 @@
 //---------------------------------------------------------------------------------------------------------------------
 
 #pragma once
+#include <cstdint>
+#include <filesystem>
 #include <string>
 #include <string_view>
 
@@ -46,4 +48,59 @@ namespace oura_charts::detail
    /// <remarks>
    std::string_view fileNameFromPath(std::string_view path) noexcept;
 
+
+   /// <summary>
+   ///   calculate a (non-cryptographic) 64-bit FNV-1a hash for a block of text. Useful for
+   ///   identifying/comparing large strings such as REST responses without keeping a copy.
+   /// </summary>
+   [[nodiscard]] inline constexpr uint64_t hashText(std::string_view text) noexcept
+   {
+      constexpr uint64_t fnv_offset_basis = 14695981039346656037ULL;
+      constexpr uint64_t fnv_prime = 1099511628211ULL;
+
+      uint64_t hash = fnv_offset_basis;
+      for (auto ch : text)
+      {
+         hash ^= static_cast<uint8_t>(ch);
+         hash *= fnv_prime;
+      }
+      return hash;
+   }
+
+
+   /// <summary>
+   ///   read-only memory mapping of a whole file. The file's contents are only read from disk as they're accessed,
+   ///   so even very large files can be "opened" almost instantly, and the pages can be dropped by the OS under
+   ///   memory pressure rather than going to the swap file.
+   /// </summary>
+   /// <remarks>
+   ///   constructor throws oura_exception if the file can't be opened or mapped. An empty file gives an empty view.
+   ///   The view is valid until the object is destroyed, and can be read from multiple threads.
+   /// </remarks>
+   class MappedFile
+   {
+   public:
+      explicit MappedFile(const std::filesystem::path& file_path) noexcept(false);
+      ~MappedFile();
+
+      [[nodiscard]] std::string_view view() const noexcept { return { m_data, m_size }; }
+      [[nodiscard]] size_t size() const noexcept { return m_size; }
+
+      // object is move-only
+      MappedFile(MappedFile&& other) noexcept;
+      MappedFile& operator=(MappedFile&& other) noexcept;
+      MappedFile(const MappedFile&) = delete;
+      MappedFile& operator=(const MappedFile&) = delete;
+
+   private:
+      const char* m_data{};
+      size_t m_size{};
+#if defined(_WIN32)
+      void* m_file{};      // file and mapping HANDLEs, which have to stay open as long as the view does.
+      void* m_mapping{};
+#endif
+
+      void close() noexcept;
+   };
+
 } // namespace oura_charts::detail
@@ -31,6 +31,12 @@ namespace oura_charts
       using type = R;
    };
 
+   template<typename R, typename C, typename... Args>
+   struct MemberFunctionReturnType<R(C::*)(Args...) const>
+   {
+      using type = R;
+   };
+
    template<typename MemberFunctionT>
    using MemberFunctionReturnType_t = typename MemberFunctionReturnType<MemberFunctionT>::type;
 
@@ -48,6 +54,12 @@ namespace oura_charts
       using type = C;
    };
 
+   template<typename R, typename C, typename... Args>
+   struct MemberFunctionClassType<R(C::*)(Args...) const>
+   {
+      using type = C;
+   };
+
    template<typename MemberFunctionT>
    using MemberFunctionClassType_t = typename MemberFunctionClassType<MemberFunctionT>::type;
 
@@ -124,6 +136,13 @@ namespace oura_charts
          return m_result;
       } 
 
+      // combine the values from another calculation into this one.
+      void merge(const MinCalc& other) noexcept
+      {
+         if (other.hasResult())
+            (*this)(other.m_result.value());
+      }
+
       // object is move-only, because a lot of algorithms take functor by value which means
       // we'd lose the result unless we wrap in std::ref()
       MinCalc() = default;
@@ -181,6 +200,13 @@ namespace oura_charts
          return m_result;
       }
 
+      // combine the values from another calculation into this one.
+      void merge(const MaxCalc& other) noexcept
+      {
+         if (other.hasResult())
+            (*this)(other.m_result.value());
+      }
+
       // object is move-only, because a lot of algorithms take functor by value which means
       // we'd lose the result unless we wrap in std::ref()
       MaxCalc() = default;
@@ -243,6 +269,18 @@ namespace oura_charts
          return m_result;
       }
 
+      // combine the values from another calculation into this one.
+      void merge(const SumCalc& other) noexcept
+      {
+         if (!other.hasResult())
+            return;
+
+         if (m_result.has_value())
+            *m_result += *other.m_result;
+         else
+            m_result = other.m_result;
+      }
+
       // object is move-only, because a lot of algorithms take functor by value which means
       // we'd lose the result unless we wrap in std::ref()
       SumCalc() = default;
@@ -327,6 +365,13 @@ namespace oura_charts
          return m_count > 0;
       }
 
+      // combine the values from another calculation into this one.
+      void merge(const AvgCalc& other) noexcept
+      {
+         m_sum.merge(other.m_sum);
+         m_count += other.m_count;
+      }
+
       // object is move-only, because a lot of algorithms take functor by value which means
       // we'd lose the result unless we wrap in std::ref()
       AvgCalc() = default;
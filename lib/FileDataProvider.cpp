@@ -0,0 +1,328 @@
+//---------------------------------------------------------------------------------------------------------------------
+// FileDataProvider.cpp
+//
+// Implementation for class FileDataProvider
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#include "oura_charts/FileDataProvider.h"
+#include "oura_charts/detail/instrumentation.h"
+#include "oura_charts/detail/json_stream.h"
+#include "oura_charts/detail/logging.h"
+#include <algorithm>
+#include <charconv>
+#include <iterator>
+
+namespace oura_charts
+{
+   namespace
+   {
+      constexpr std::string_view KEY_FIELD_DAY = "day";
+      constexpr std::string_view KEY_FIELD_TIMESTAMP = "timestamp";
+
+      constexpr size_t ISO_DATE_LENGTH = 10;       // YYYY-MM-DD
+      constexpr size_t ISO_DATETIME_LENGTH = 19;   // YYYY-MM-DDTHH:MM:SS
+      constexpr size_t UTC_OFFSET_LENGTH = 6;      // +HH:MM
+
+
+      // value of a top-level string member of a JSON object, or empty if there isn't one. Members of nested
+      // objects with the same name (eg sleep's heart_rate.timestamp) are skipped.
+      std::string_view topLevelString(std::string_view json, std::string_view field) noexcept
+      {
+         int depth{};
+         for (size_t pos = 0; pos < json.size(); ++pos)
+         {
+            const char ch = json[pos];
+            if (ch == '{' or ch == '[')
+            {
+               ++depth;
+            }
+            else if (ch == '}' or ch == ']')
+            {
+               --depth;
+            }
+            else if (ch == '"')
+            {
+               // find the end of the string, skipping escapes
+               auto begin = pos + 1;
+               auto end = begin;
+               while (end < json.size() and json[end] != '"')
+                  end += json[end] == '\\' ? 2 : 1;
+               if (end >= json.size())
+                  return {};
+               pos = end;
+
+               if (depth != 1 or json.substr(begin, end - begin) != field)
+                  continue;
+
+               // only a member name if it's followed by a ':'
+               auto colon = json.find_first_not_of(" \t\r\n", end + 1);
+               if (colon == std::string_view::npos or json[colon] != ':')
+                  continue;
+
+               auto value = json.find_first_not_of(" \t\r\n", colon + 1);
+               if (value == std::string_view::npos or json[value] != '"')
+                  return {};
+
+               auto value_end = json.find('"', value + 1);
+               return value_end == std::string_view::npos ? std::string_view{} : json.substr(value + 1, value_end - value - 1);
+            }
+         }
+         return {};
+      }
+
+
+      bool readNumber(std::string_view text, size_t pos, size_t len, int& value) noexcept
+      {
+         auto begin = text.data() + pos;
+         auto [ptr, ec] = std::from_chars(begin, begin + len, value);
+         return ec == std::errc{} and ptr == begin + len;
+      }
+
+
+      // parses "YYYY-MM-DD" or "YYYY-MM-DDTHH:MM:SS[.fff][Z|+HH:MM|-HH:MM]" as UTC. There are millions of these in a
+      // big export, so the fixed-width formats the REST API uses are parsed here directly rather than with
+      // parseIsoDateTime(), which handles anything else.
+      std::optional<sys_seconds> parseKey(std::string_view text) noexcept
+      {
+         auto slow_parse = [text] () -> std::optional<sys_seconds>
+            {
+               auto res = parseIsoDateTime(text);
+               return res ? std::optional{ res.value() } : std::nullopt;
+            };
+
+         int year_num{}, month_num{}, day_num{};
+         if (text.size() < ISO_DATE_LENGTH or text[4] != '-' or text[7] != '-' or
+             !readNumber(text, 0, 4, year_num) or !readNumber(text, 5, 2, month_num) or !readNumber(text, 8, 2, day_num))
+         {
+            return slow_parse();
+         }
+
+         const year_month_day ymd{ chrono::year{ year_num }, chrono::month{ static_cast<unsigned>(month_num) }, chrono::day{ static_cast<unsigned>(day_num) } };
+         if (!ymd.ok())
+            return std::nullopt;
+
+         sys_seconds result{ sys_days{ ymd } };
+         if (text.size() == ISO_DATE_LENGTH)
+            return result;
+
+         int hour{}, minute{}, second{};
+         if (text.size() < ISO_DATETIME_LENGTH or text[10] != 'T' or text[13] != ':' or text[16] != ':' or
+             !readNumber(text, 11, 2, hour) or !readNumber(text, 14, 2, minute) or !readNumber(text, 17, 2, second))
+         {
+            return slow_parse();
+         }
+         result += chrono::hours{ hour } + chrono::minutes{ minute } + chrono::seconds{ second };
+
+         // fractional seconds are truncated
+         auto pos = ISO_DATETIME_LENGTH;
+         if (pos < text.size() and text[pos] == '.')
+         {
+            ++pos;
+            while (pos < text.size() and text[pos] >= '0' and text[pos] <= '9')
+               ++pos;
+         }
+
+         if (pos == text.size() or (text[pos] == 'Z' and pos + 1 == text.size()))
+            return result;
+
+         int offset_hours{}, offset_minutes{};
+         if ((text[pos] == '+' or text[pos] == '-') and text.size() == pos + UTC_OFFSET_LENGTH and text[pos + 3] == ':' and
+             readNumber(text, pos + 1, 2, offset_hours) and readNumber(text, pos + 4, 2, offset_minutes))
+         {
+            const auto offset = chrono::hours{ offset_hours } + chrono::minutes{ offset_minutes };
+            return text[pos] == '+' ? result - offset : result + offset;
+         }
+         return slow_parse();
+      }
+
+
+      sys_seconds parseParam(std::string_view value, const char* param_name) noexcept(false)
+      {
+         auto key = parseKey(value);
+         if (!key)
+            throw oura_exception{ ErrorCategory::Parse, "FileDataProvider - invalid value '{}' for {}", value, param_name };
+
+         return *key;
+      }
+
+   } // namespace
+
+
+   FileDataProvider::FileDataProvider(const fs::path& export_folder, FileDataProviderOptions options) :
+      m_state{ std::make_shared<State>() }
+   {
+      if (!fs::is_directory(export_folder))
+      {
+         const auto folder_name = export_folder.string();
+         throw oura_exception{ ErrorCategory::FileIO, "FileDataProvider - export folder '{}' not found", folder_name };
+      }
+
+      m_state->folder = export_folder;
+      m_state->options = options;
+      for (const auto& dir_entry : fs::directory_iterator{ export_folder })
+      {
+         if (!dir_entry.is_regular_file() or dir_entry.path().extension() != ".json")
+            continue;
+
+         auto endpoint = std::make_unique<Endpoint>();
+         endpoint->file_path = dir_entry.path();
+         m_state->endpoints.emplace(dir_entry.path().stem().string(), std::move(endpoint));
+      }
+   }
+
+
+   std::vector<std::string> FileDataProvider::paths() const
+   {
+      std::vector<std::string> paths{};
+      paths.reserve(m_state->endpoints.size());
+      rg::copy(m_state->endpoints | vw::keys, std::back_inserter(paths));
+      return paths;
+   }
+
+
+   expected<size_t, oura_exception> FileDataProvider::recordCount(std::string_view path) const noexcept
+   {
+      try
+      {
+         return indexedEndpoint(path).records.size();
+      }
+      catch (oura_exception& e)
+      {
+         return unexpected{ std::move(e) };
+      }
+      catch (std::exception& e)
+      {
+         return unexpected{ oura_exception{ e.what() } };
+      }
+   }
+
+
+   FileDataProvider::Endpoint& FileDataProvider::indexedEndpoint(std::string_view path) const noexcept(false)
+   {
+      static auto& index_timer = instrumentation::timer(constants::METRIC_FILE_PROVIDER_INDEX);
+      static auto& record_count = instrumentation::counter(constants::METRIC_FILE_PROVIDER_RECORDS);
+
+      auto it = m_state->endpoints.find(path);
+      if (it == m_state->endpoints.end())
+         throw oura_exception{ ErrorCategory::FileIO, "FileDataProvider - no export file for '{}'", path };
+
+      // if this throws the flag isn't set, so the next request will try again.
+      auto& endpoint = *it->second;
+      std::call_once(endpoint.indexed, [&endpoint] ()
+         {
+            instrumentation::ScopedTimer timer{ index_timer };
+
+            detail::MappedFile file{ endpoint.file_path };
+            std::vector<Record> records{};
+
+            // the whole file is fed as one chunk, so each record is a view of the mapping rather than a copy.
+            detail::JsonPageSplitter splitter{};
+            splitter.feed(file.view(), [&records] (std::string_view json)
+               {
+                  auto key_text = topLevelString(json, KEY_FIELD_DAY);
+                  if (key_text.empty())
+                     key_text = topLevelString(json, KEY_FIELD_TIMESTAMP);
+
+                  // records without a usable key sort first, and are only returned by requests without date filters.
+                  records.emplace_back(key_text.empty() ? sys_seconds::min() : parseKey(key_text).value_or(sys_seconds::min()), json);
+                  return true;
+               });
+
+            if (auto finish_res = splitter.finish(); !finish_res)
+            {
+               const auto file_name = endpoint.file_path.string();
+               const std::string_view reason{ finish_res.error().what() };
+               throw oura_exception{ ErrorCategory::Parse, "FileDataProvider - '{}' isn't valid JSON: {}", file_name, reason };
+            }
+
+            // exports are usually in order already, in which case there's no need to sort.
+            if (!rg::is_sorted(records, {}, &Record::key))
+               rg::stable_sort(records, {}, &Record::key);
+
+            record_count.add(records.size());
+            logging::debug("FileDataProvider - indexed {} records ({} bytes) from '{}'", records.size(), file.size(), endpoint.file_path.string());
+
+            endpoint.document = splitter.recordCount() == 0;
+            endpoint.records = std::move(records);
+            endpoint.file.emplace(std::move(file));
+         });
+
+      return endpoint;
+   }
+
+
+   FileDataProvider::JsonResult FileDataProvider::getPage(std::string_view path, const PageQuery& query) const noexcept
+   {
+      try
+      {
+         const auto& endpoint = indexedEndpoint(path);
+         if (endpoint.document)
+            return std::string{ endpoint.file->view() };
+
+         // narrow [first, last) by whichever filter params were specified. end_date is inclusive, end_datetime isn't.
+         const auto& records = endpoint.records;
+         auto first = records.begin();
+         auto last = records.end();
+         if (!query.start_date.empty())
+            first = std::max(first, rg::lower_bound(records, parseParam(query.start_date, constants::REST_PARAM_START_DATE), {}, &Record::key));
+         if (!query.start_datetime.empty())
+            first = std::max(first, rg::lower_bound(records, parseParam(query.start_datetime, constants::REST_PARAM_START_DATETIME), {}, &Record::key));
+         if (!query.end_date.empty())
+            last = std::min(last, rg::lower_bound(records, parseParam(query.end_date, constants::REST_PARAM_END_DATE) + days{ 1 }, {}, &Record::key));
+         if (!query.end_datetime.empty())
+            last = std::min(last, rg::lower_bound(records, parseParam(query.end_datetime, constants::REST_PARAM_END_DATETIME), {}, &Record::key));
+         last = std::max(first, last);
+
+         // next_token is the index of the page's first record.
+         auto page_first = first;
+         if (!query.next_token.empty())
+         {
+            size_t index{};
+            auto [ptr, ec] = std::from_chars(query.next_token.data(), query.next_token.data() + query.next_token.size(), index);
+            if (ec != std::errc{} or ptr != query.next_token.data() + query.next_token.size() or
+                index < static_cast<size_t>(first - records.begin()) or index > static_cast<size_t>(last - records.begin()))
+            {
+               return unexpected{ oura_exception{ ErrorCategory::Parse, "FileDataProvider - invalid next_token '{}' for '{}'", query.next_token, path } };
+            }
+            page_first = records.begin() + static_cast<ptrdiff_t>(index);
+         }
+
+         // a page always has at least one record, so page_bytes smaller than a record can't stall the paging.
+         const auto page_bytes = m_state->options.page_bytes;
+         auto page_last = page_first;
+         size_t size{};
+         while (page_last != last and (size == 0 or size < page_bytes))
+         {
+            size += page_last->json.size() + 1;
+            ++page_last;
+         }
+
+         std::string json{};
+         json.reserve(size + 64);
+         json.append(R"({"data":[)");
+         for (auto rec = page_first; rec != page_last; ++rec)
+         {
+            if (rec != page_first)
+               json.push_back(',');
+            json.append(rec->json);
+         }
+         if (page_last != last)
+            fmt::format_to(std::back_inserter(json), R"(],"next_token":"{}"}})", page_last - records.begin());
+         else
+            json.append(R"(],"next_token":null})");
+
+         return json;
+      }
+      catch (oura_exception& e)
+      {
+         return unexpected{ std::move(e) };
+      }
+      catch (std::exception& e)
+      {
+         return unexpected{ oura_exception{ e.what() } };
+      }
+   }
+
+} // namespace oura_charts
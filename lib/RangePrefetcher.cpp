@@ -0,0 +1,207 @@
+//---------------------------------------------------------------------------------------------------------------------
+// RangePrefetcher.cpp
+//
+// Implementation for class RangePrefetcher
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#include "oura_charts/RangePrefetcher.h"
+#include "oura_charts/detail/instrumentation.h"
+#include "oura_charts/detail/json_structs.h"
+#include "oura_charts/detail/logging.h"
+
+namespace oura_charts
+{
+   std::pair<DateRange, DateRange> adjacentRanges(const DateRange& range)
+   {
+      const year_month first_month{ range.from.year() / range.from.month() };
+      const year_month last_month{ range.thru.year() / range.thru.month() };
+
+      const bool whole_months = range.from.day() == chrono::day{ 1 } and range.thru == year_month_day{ last_month / chrono::last };
+      if (whole_months)
+      {
+         const auto months = last_month - first_month + chrono::months{ 1 };
+         return { DateRange{ .from = (first_month - months) / 1, .thru = year_month_day{ (first_month - chrono::months{ 1 }) / chrono::last } },
+                  DateRange{ .from = (last_month + chrono::months{ 1 }) / 1, .thru = year_month_day{ (last_month + months) / chrono::last } } };
+      }
+
+      const auto length = sys_days{ range.thru } - sys_days{ range.from } + days{ 1 };
+      return { DateRange{ .from = sys_days{ range.from } - length, .thru = sys_days{ range.from } - days{ 1 } },
+               DateRange{ .from = sys_days{ range.thru } + days{ 1 }, .thru = sys_days{ range.thru } + length } };
+   }
+
+
+   RangePrefetcher::RangePrefetcher(FetchFunc fetch, PrefetchOptions options) :
+      m_fetch{ std::move(fetch) },
+      m_options{ options },
+      m_worker{ [this] (std::stop_token stop) { run(std::move(stop)); } }
+   {}
+
+
+   RangePrefetcher::~RangePrefetcher()
+   {
+      m_worker.request_stop();
+      m_worker.join();
+   }
+
+
+   void RangePrefetcher::cancel()
+   {
+      enqueue({});
+   }
+
+
+   void RangePrefetcher::waitIdle()
+   {
+      std::unique_lock lock{ m_mutex };
+      m_idle.wait(lock, [this] { return m_queue.empty() and !m_busy; });
+   }
+
+
+   PrefetchStats RangePrefetcher::stats() const
+   {
+      std::scoped_lock lock{ m_mutex };
+      return m_stats;
+   }
+
+
+   RangePrefetcher::ForegroundScope::ForegroundScope(RangePrefetcher& prefetcher) : m_prefetcher{ &prefetcher }
+   {
+      std::scoped_lock lock{ m_prefetcher->m_mutex };
+      ++m_prefetcher->m_foreground;
+   }
+
+
+   RangePrefetcher::ForegroundScope::~ForegroundScope()
+   {
+      if (!m_prefetcher)
+         return;
+
+      {
+         std::scoped_lock lock{ m_prefetcher->m_mutex };
+         --m_prefetcher->m_foreground;
+      }
+      m_prefetcher->m_wakeup.notify_all();
+   }
+
+
+   void RangePrefetcher::enqueue(std::vector<Request> requests)
+   {
+      static auto& cancelled = instrumentation::counter(constants::METRIC_PREFETCH_CANCELLED);
+
+      {
+         std::scoped_lock lock{ m_mutex };
+
+         // a range that's part way through is counted as cancelled by the worker when it notices.
+         m_stats.cancelled += m_queue.size();
+         cancelled.add(m_queue.size());
+
+         m_queue.assign(std::make_move_iterator(requests.begin()), std::make_move_iterator(requests.end()));
+         ++m_generation;
+         m_generation_bytes = 0;
+      }
+      m_wakeup.notify_all();
+      m_idle.notify_all();
+   }
+
+
+   void RangePrefetcher::run(std::stop_token stop)
+   {
+      static auto& cancelled = instrumentation::counter(constants::METRIC_PREFETCH_CANCELLED);
+
+      std::unique_lock lock{ m_mutex };
+      // wait() returns the predicate's value, which can still be true after a stop has been requested.
+      while (m_wakeup.wait(lock, stop, [this] { return !m_queue.empty(); }) and !stop.stop_requested())
+      {
+         auto request = std::move(m_queue.front());
+         m_queue.pop_front();
+         m_busy = true;
+
+         switch (fetchRange(lock, stop, request, m_generation))
+         {
+            case Outcome::Completed:
+               ++m_stats.ranges;
+               break;
+
+            case Outcome::Cancelled:
+               ++m_stats.cancelled;
+               cancelled.add();
+               break;
+
+            case Outcome::OverBudget:
+               ++m_stats.over_budget;
+               break;
+
+            case Outcome::Failed:
+               ++m_stats.failed;
+               break;
+         }
+
+         m_busy = false;
+         m_idle.notify_all();
+      }
+   }
+
+
+   RangePrefetcher::Outcome RangePrefetcher::fetchRange(std::unique_lock<std::mutex>& lock, std::stop_token stop, Request& request, uint64_t generation)
+   {
+      static auto& page_count = instrumentation::counter(constants::METRIC_PREFETCH_PAGES);
+      static auto& byte_count = instrumentation::counter(constants::METRIC_PREFETCH_BYTES);
+
+      detail::nullable_string next_token{};
+      do
+      {
+         // don't compete with anything the user is waiting for.
+         m_wakeup.wait(lock, stop, [this, generation] { return m_foreground == 0 or m_generation != generation; });
+         if (stop.stop_requested() or m_generation != generation)
+            return Outcome::Cancelled;
+
+         if (m_generation_bytes >= m_options.max_bytes)
+         {
+            logging::debug("RangePrefetcher - skipping '{}', the prefetch budget of {} bytes has been used", request.path, m_options.max_bytes);
+            return Outcome::OverBudget;
+         }
+
+         if (next_token)
+            request.params[constants::REST_PARAM_NEXT_TOKEN] = std::move(*next_token);
+
+         lock.unlock();
+         JsonResult json_res{};
+         try
+         {
+            json_res = m_fetch(request.path, request.params);
+         }
+         catch (std::exception& e)
+         {
+            json_res = unexpected{ oura_exception{ e.what() } };
+         }
+         lock.lock();
+
+         if (!json_res)
+         {
+            logging::exception(fmt::format("RangePrefetcher - prefetching '{}'", request.path), json_res.error());
+            return Outcome::Failed;
+         }
+
+         const auto size = json_res->size();
+         ++m_stats.pages;
+         m_stats.bytes += size;
+         page_count.add();
+         byte_count.add(size);
+         if (m_generation == generation)
+            m_generation_bytes += size;
+
+         auto token_res = detail::readNextToken(json_res.value());
+         if (!token_res)
+         {
+            logging::exception(fmt::format("RangePrefetcher - prefetching '{}'", request.path), token_res.error());
+            return Outcome::Failed;
+         }
+         next_token = std::move(token_res.value());
+      } while (next_token);
+
+      return Outcome::Completed;
+   }
+
+} // namespace oura_charts
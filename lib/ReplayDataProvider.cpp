@@ -0,0 +1,171 @@
+//---------------------------------------------------------------------------------------------------------------------
+// ReplayDataProvider.cpp
+//
+// Implementation for classes RecordingWriter and ReplayDataProvider
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#include "oura_charts/ReplayDataProvider.h"
+#include "oura_charts/detail/json_structs.h"
+#include "oura_charts/detail/utility.h"
+#include <algorithm>
+#include <thread>
+
+namespace oura_charts
+{
+   namespace
+   {
+      // true if the file is a response body saved by RecordingWriter, which are named with the record number.
+      bool isRecordedBody(const fs::path& file_path)
+      {
+         const auto stem = file_path.stem().string();
+         return file_path.extension() == ".json" && !stem.empty() && rg::all_of(stem, [] (char ch) { return ch >= '0' && ch <= '9'; });
+      }
+   }
+
+
+   RecordingWriter::RecordingWriter(const fs::path& folder) : m_folder{ folder }
+   {
+      std::error_code ec{};
+      fs::create_directories(m_folder, ec);
+
+      // remove the responses from any previous recording, so a replay can't pick up a stale body. Other files
+      // in the folder are left alone.
+      for (const auto& entry : fs::directory_iterator{ m_folder, ec })
+      {
+         if (entry.is_regular_file(ec) && isRecordedBody(entry.path()) && !fs::remove(entry.path(), ec))
+         {
+            const auto file_name = entry.path().string();
+            throw oura_exception{ ErrorCategory::FileIO, "RecordingWriter - unable to remove old response '{}'", file_name };
+         }
+      }
+
+      const auto index_path = m_folder / constants::RECORDING_INDEX_FILE;
+      m_index.open(index_path, std::ios::binary | std::ios::trunc);
+      if (!m_index)
+      {
+         const auto file_name = index_path.string();
+         throw oura_exception{ ErrorCategory::FileIO, "RecordingWriter - unable to create recording index '{}'", file_name };
+      }
+   }
+
+
+   void RecordingWriter::write(std::string_view path, const ParamMap& params, std::string_view body, std::chrono::microseconds latency)
+   {
+      std::scoped_lock lock{ m_mutex };
+
+      detail::recorded_request request{ .path = std::string{ path },
+                                        .params = params,
+                                        .latency_us = latency.count(),
+                                        .body_file = fmt::format("{:06}.json", m_count + 1) };
+
+      const auto body_path = m_folder / request.body_file;
+      std::ofstream body_file{ body_path, std::ios::binary | std::ios::trunc };
+      body_file.write(body.data(), static_cast<std::streamsize>(body.size()));
+      body_file.close();
+      if (!body_file)
+      {
+         const auto file_name = body_path.string();
+         throw oura_exception{ ErrorCategory::FileIO, "RecordingWriter - unable to write response to '{}'", file_name };
+      }
+
+      // the index line is only written once the body is safely on disk.
+      m_index << glz::write_json(request) << '\n';
+      m_index.flush();
+      if (!m_index)
+         throw oura_exception{ "RecordingWriter - unable to write to recording index", ErrorCategory::FileIO };
+
+      ++m_count;
+   }
+
+
+   size_t RecordingWriter::count() const
+   {
+      std::scoped_lock lock{ m_mutex };
+      return m_count;
+   }
+
+
+   ReplayDataProvider::ReplayDataProvider(const fs::path& folder, ReplayOptions options) : m_options{ options }
+   {
+      const auto index_path = folder / constants::RECORDING_INDEX_FILE;
+      std::ifstream index{ index_path, std::ios::binary };
+      if (!index)
+      {
+         const auto file_name = index_path.string();
+         throw oura_exception{ ErrorCategory::FileIO, "ReplayDataProvider - recording index '{}' not found", file_name };
+      }
+
+      auto responses = std::make_shared<ResponseMap>();
+      std::string line{};
+      size_t line_num{};
+      while (std::getline(index, line))
+      {
+         ++line_num;
+         if (line.empty() or line == "\r")
+            continue;
+
+         auto request_res = detail::readJson<detail::recorded_request>(line);
+         if (!request_res)
+         {
+            const auto file_name = index_path.string();
+            const std::string_view reason{ request_res.error().what() };
+            throw oura_exception{ ErrorCategory::Parse, "ReplayDataProvider - invalid entry on line {} of '{}': {}", line_num, file_name, reason };
+         }
+
+         // later responses to the same request replace earlier ones
+         auto& request = request_res.value();
+         detail::MappedFile body{ folder / request.body_file };
+         responses->insert_or_assign(makeKey(request.path, request.params),
+                                     Response{ .body = std::string{ body.view() }, .latency = std::chrono::microseconds{ request.latency_us } });
+      }
+      m_responses = std::move(responses);
+   }
+
+
+   std::string ReplayDataProvider::makeKey(std::string_view path, const ParamMap& params) const
+   {
+      std::string key{ path };
+      char separator = '?';
+      for (const auto& [name, value] : params)
+      {
+         if (!m_options.match_params and name != constants::REST_PARAM_NEXT_TOKEN)
+            continue;
+
+         key += separator;
+         key.append(name).append("=").append(value);
+         separator = '&';
+      }
+      return key;
+   }
+
+
+   ReplayDataProvider::JsonResult ReplayDataProvider::replay(std::string_view path, const ParamMap& params) const noexcept
+   {
+      static auto& request_count = instrumentation::counter(constants::METRIC_REPLAY_REQUESTS);
+      static auto& miss_count = instrumentation::counter(constants::METRIC_REPLAY_MISSES);
+
+      try
+      {
+         request_count.add();
+         auto key = makeKey(path, params);
+         auto it = m_responses->find(key);
+         if (it == m_responses->end())
+         {
+            miss_count.add();
+            return unexpected{ oura_exception{ ErrorCategory::FileIO, "ReplayDataProvider - no recorded response for '{}'", key } };
+         }
+
+         if (m_options.timing == ReplayTiming::RecordedLatency)
+            std::this_thread::sleep_for(it->second.latency);
+
+         return it->second.body;
+      }
+      catch (std::exception& e)
+      {
+         return unexpected{ oura_exception{ e.what() } };
+      }
+   }
+
+} // namespace oura_charts
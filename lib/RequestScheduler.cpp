@@ -0,0 +1,205 @@
+//---------------------------------------------------------------------------------------------------------------------
+// RequestScheduler.cpp
+//
+// Implementation for class RequestScheduler
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#include "oura_charts/RequestScheduler.h"
+#include "oura_charts/detail/instrumentation.h"
+#include "oura_charts/detail/logging.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <thread>
+
+namespace oura_charts
+{
+   using std::chrono::milliseconds;
+   using std::chrono::duration;
+   using std::chrono::duration_cast;
+
+   namespace
+   {
+      constexpr int64_t HTTP_TOO_MANY_REQUESTS = 429;
+      constexpr int64_t HTTP_INTERNAL_SERVER_ERROR = 500;
+      constexpr int64_t HTTP_BAD_GATEWAY = 502;
+      constexpr int64_t HTTP_SERVICE_UNAVAILABLE = 503;
+      constexpr int64_t HTTP_GATEWAY_TIMEOUT = 504;
+
+      // how the adaptive rate reacts to the server. After being throttled the rate is cut in half, and
+      // each success adds back a small fraction of the limit.
+      constexpr double RATE_DECREASE_FACTOR = 0.5;
+      constexpr double RATE_INCREASE_FRACTION = 0.05;
+      constexpr double MIN_RATE_FRACTION = 0.01;
+
+      bool isSuccess(int64_t status_code)
+      {
+         constexpr int64_t HTTP_SUCCESS_MIN = 200;
+         constexpr int64_t HTTP_SUCCESS_MAX = 299;
+         return status_code >= HTTP_SUCCESS_MIN && status_code <= HTTP_SUCCESS_MAX;
+      }
+
+   } // namespace
+
+
+   RequestScheduler::RequestScheduler(RateLimit limit, RetryPolicy policy) :
+      m_limit{ limit },
+      m_policy{ policy },
+      m_rate{ limit.requests_per_second },
+      m_tokens{ limit.burst },
+      m_last_refill{ clock::now() },
+      m_rng{ std::random_device{}() }
+   {
+      if (m_limit.requests_per_second <= 0.0 or m_limit.burst < 1.0)
+         throw oura_exception{ "RequestScheduler - requests_per_second must be > 0 and burst must be >= 1" };
+   }
+
+
+   void RequestScheduler::refill(clock::time_point now)
+   {
+      duration<double> elapsed = now - m_last_refill;
+      m_tokens = std::min(m_limit.burst, m_tokens + (elapsed.count() * m_rate));
+      m_last_refill = now;
+   }
+
+
+   void RequestScheduler::acquire()
+   {
+      static auto& wait_timer = instrumentation::timer(constants::METRIC_REST_RATE_WAIT);
+      instrumentation::ScopedTimer timer{ wait_timer };
+
+      std::unique_lock lock{ m_mutex };
+      for (;;)
+      {
+         auto now = clock::now();
+         refill(now);
+         if (now >= m_blocked_until && m_tokens >= 1.0)
+         {
+            m_tokens -= 1.0;
+            return;
+         }
+
+         auto wait = waitTimeLocked(now);
+         lock.unlock();
+         std::this_thread::sleep_for(wait);
+         lock.lock();
+      }
+   }
+
+
+   RequestScheduler::clock::duration RequestScheduler::timeUntilReady()
+   {
+      std::scoped_lock lock{ m_mutex };
+      auto now = clock::now();
+      refill(now);
+      if (now >= m_blocked_until && m_tokens >= 1.0)
+         return clock::duration::zero();
+
+      return waitTimeLocked(now);
+   }
+
+
+   RequestScheduler::clock::duration RequestScheduler::waitTimeLocked(clock::time_point now) const
+   {
+      // wait until we're unblocked or the next token is available, whichever is later.
+      return (now < m_blocked_until) ? duration_cast<clock::duration>(m_blocked_until - now)
+                                     : duration_cast<clock::duration>(duration<double>{ (1.0 - m_tokens) / m_rate });
+   }
+
+
+   std::optional<milliseconds> RequestScheduler::completeRequest(int64_t status_code, std::string_view retry_after, int attempt)
+   {
+      static auto& retries = instrumentation::counter(constants::METRIC_REST_RETRIES);
+      static auto& throttled = instrumentation::counter(constants::METRIC_REST_THROTTLED);
+
+      std::scoped_lock lock{ m_mutex };
+      if (isSuccess(status_code))
+      {
+         m_rate = std::min(m_limit.requests_per_second, m_rate + (m_limit.requests_per_second * RATE_INCREASE_FRACTION));
+         return std::nullopt;
+      }
+
+      if (!isRetryable(status_code) or attempt >= m_policy.max_attempts)
+         return std::nullopt;
+
+      auto delay = backoffDelayLocked(attempt);
+      if (status_code == HTTP_TOO_MANY_REQUESTS)
+      {
+         throttled.add();
+
+         // slow down, and hold off everyone using this scheduler until the server says it's OK.
+         m_rate = std::max(m_limit.requests_per_second * MIN_RATE_FRACTION, m_rate * RATE_DECREASE_FACTOR);
+         m_tokens = 0.0;
+
+         auto server_delay = parseRetryAfter(retry_after);
+         if (server_delay)
+            delay = std::max(delay, duration_cast<milliseconds>(*server_delay));
+
+         m_blocked_until = std::max(m_blocked_until, clock::now() + delay);
+      }
+
+      retries.add();
+      logging::debug("RequestScheduler - request failed with status {}, retrying in {}ms (attempt {} of {})",
+                     status_code, delay.count(), attempt, m_policy.max_attempts);
+      return delay;
+   }
+
+
+   milliseconds RequestScheduler::backoffDelay(int attempt)
+   {
+      std::scoped_lock lock{ m_mutex };
+      return backoffDelayLocked(attempt);
+   }
+
+
+   milliseconds RequestScheduler::backoffDelayLocked(int attempt)
+   {
+      auto exponent = static_cast<double>(std::max(attempt, 1) - 1);
+      auto backoff = static_cast<double>(m_policy.initial_backoff.count()) * std::pow(m_policy.multiplier, exponent);
+      backoff = std::min(backoff, static_cast<double>(m_policy.max_backoff.count()));
+
+      std::uniform_real_distribution<double> jitter_dist{ 0.0, std::clamp(m_policy.jitter, 0.0, 1.0) };
+      backoff *= 1.0 - jitter_dist(m_rng);
+      return milliseconds{ static_cast<milliseconds::rep>(backoff) };
+   }
+
+
+   double RequestScheduler::currentRate() const
+   {
+      std::scoped_lock lock{ m_mutex };
+      return m_rate;
+   }
+
+
+   bool RequestScheduler::isRetryable(int64_t status_code) noexcept
+   {
+      switch (status_code)
+      {
+         case 0: // no response at all, eg connection failed or timed out
+         case HTTP_TOO_MANY_REQUESTS:
+         case HTTP_INTERNAL_SERVER_ERROR:
+         case HTTP_BAD_GATEWAY:
+         case HTTP_SERVICE_UNAVAILABLE:
+         case HTTP_GATEWAY_TIMEOUT:
+            return true;
+
+         default:
+            return false;
+      }
+   }
+
+
+   std::optional<std::chrono::seconds> RequestScheduler::parseRetryAfter(std::string_view retry_after) noexcept
+   {
+      int64_t secs{};
+      const auto* end = retry_after.data() + retry_after.size();
+      auto [ptr, ec] = std::from_chars(retry_after.data(), end, secs);
+      if (retry_after.empty() or ec != std::errc{} or ptr != end or secs < 0)
+         return std::nullopt;
+
+      return std::chrono::seconds{ secs };
+   }
+
+} // namespace oura_charts
@@ -0,0 +1,200 @@
+//---------------------------------------------------------------------------------------------------------------------
+// ResponseCache.cpp
+//
+// Implementation for class ResponseCache
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#include "oura_charts/ResponseCache.h"
+#include "oura_charts/detail/instrumentation.h"
+#include "oura_charts/detail/logging.h"
+
+namespace oura_charts
+{
+   ResponseCache::ResponseCache(ResponseCacheOptions options) : m_options{ options }
+   {}
+
+
+   ResponseCache::JsonResult ResponseCache::get(std::string_view key, const FetchFunc& fetch)
+   {
+      static auto& hits = instrumentation::counter(constants::METRIC_CACHE_HITS);
+      static auto& misses = instrumentation::counter(constants::METRIC_CACHE_MISSES);
+      static auto& revalidated = instrumentation::counter(constants::METRIC_CACHE_REVALIDATED);
+      static auto& coalesced = instrumentation::counter(constants::METRIC_CACHE_COALESCED);
+
+      std::unique_lock lock{ m_mutex };
+
+      // a fresh entry can be returned as-is
+      auto index_it = m_index.find(key);
+      if (index_it != m_index.end() and clock::now() < index_it->second->expires)
+      {
+         m_entries.splice(m_entries.begin(), m_entries, index_it->second);
+         ++m_stats.hits;
+         hits.add();
+         return index_it->second->json;
+      }
+
+      // if someone else is already fetching this key, wait for their result.
+      if (auto flight_it = m_in_flight.find(key); flight_it != m_in_flight.end())
+      {
+         auto result = flight_it->second.result;
+         ++m_stats.coalesced;
+         lock.unlock();
+
+         coalesced.add();
+         return result.get();
+      }
+
+      // we're doing the fetch. Keep a copy of any stale entry, since it could be evicted while we're waiting
+      // and we'll need it if the server says it's still current.
+      std::promise<JsonResult> promise{};
+      const auto generation = m_generation;
+      m_in_flight.emplace(key, InFlight{ .result = promise.get_future().share(), .generation = generation });
+      ++m_stats.misses;
+
+      std::optional<Entry> stale{};
+      if (index_it != m_index.end())
+         stale = *index_it->second;
+
+      lock.unlock();
+      misses.add();
+
+      FetchResult fetch_res{};
+      try
+      {
+         fetch_res = fetch(stale ? stale->validators : ResponseValidators{});
+      }
+      catch (...)
+      {
+         // waiters get the exception too, and we can't leave the key marked as in flight. If the cache was
+         // cleared in the meantime our entry is already gone, and any entry for the key is someone else's.
+         lock.lock();
+         if (generation == m_generation)
+            m_in_flight.erase(m_in_flight.find(key));
+         lock.unlock();
+         promise.set_exception(std::current_exception());
+         throw;
+      }
+
+      JsonResult result{};
+      lock.lock();
+
+      // if the cache was cleared while we were fetching (eg because the access token changed), the response is
+      // still returned to the callers that were waiting for it but mustn't be stored.
+      const bool current = generation == m_generation;
+      const auto expires = clock::now() + m_options.ttl;
+      if (!fetch_res)
+      {
+         result = unexpected{ std::move(fetch_res.error()) };
+      }
+      else if (fetch_res->not_modified and stale)
+      {
+         ++m_stats.revalidated;
+         revalidated.add();
+         result = stale->json;
+         if (current)
+            storeLocked(key, std::move(stale->json), std::move(stale->validators), expires);
+      }
+      else if (fetch_res->not_modified)
+      {
+         // shouldn't happen since we didn't send any validators, but there's no body to return.
+         result = unexpected{ oura_exception{ ErrorCategory::REST, "ResponseCache - got 'not modified' response for '{}', which isn't cached", key } };
+      }
+      else
+      {
+         result = fetch_res->json;
+         if (current)
+            storeLocked(key, std::move(fetch_res->json), std::move(fetch_res->validators), expires);
+      }
+      if (current)
+         m_in_flight.erase(m_in_flight.find(key));
+      lock.unlock();
+
+      promise.set_value(result);
+      return result;
+   }
+
+
+   void ResponseCache::invalidate(std::string_view key)
+   {
+      std::scoped_lock lock{ m_mutex };
+      if (auto it = m_index.find(key); it != m_index.end())
+         eraseLocked(it->second);
+   }
+
+
+   void ResponseCache::clear()
+   {
+      std::scoped_lock lock{ m_mutex };
+      m_index.clear();
+      m_entries.clear();
+      m_bytes = 0;
+
+      // fetches that are already running finish normally, but don't store their responses.
+      m_in_flight.clear();
+      ++m_generation;
+   }
+
+
+   size_t ResponseCache::size() const
+   {
+      std::scoped_lock lock{ m_mutex };
+      return m_entries.size();
+   }
+
+
+   size_t ResponseCache::sizeBytes() const
+   {
+      std::scoped_lock lock{ m_mutex };
+      return m_bytes;
+   }
+
+
+   ResponseCacheStats ResponseCache::stats() const
+   {
+      std::scoped_lock lock{ m_mutex };
+      return m_stats;
+   }
+
+
+   void ResponseCache::storeLocked(std::string_view key, std::string json, ResponseValidators validators, clock::time_point expires)
+   {
+      if (auto it = m_index.find(key); it != m_index.end())
+         eraseLocked(it->second);
+
+      // a response that could never fit would just flush everything else out.
+      if (json.size() > m_options.max_bytes or m_options.max_entries == 0)
+      {
+         logging::debug("ResponseCache - not caching response for '{}', {} bytes is over the limit", key, json.size());
+         return;
+      }
+
+      m_bytes += json.size();
+      m_entries.emplace_front(Entry{ .key = std::string{ key }, .json = std::move(json), .validators = std::move(validators), .expires = expires });
+      m_index.emplace(m_entries.front().key, m_entries.begin());
+      evictLocked();
+   }
+
+
+   void ResponseCache::eraseLocked(EntryList::iterator it)
+   {
+      m_bytes -= it->json.size();
+      m_index.erase(m_index.find(it->key));
+      m_entries.erase(it);
+   }
+
+
+   void ResponseCache::evictLocked()
+   {
+      static auto& evictions = instrumentation::counter(constants::METRIC_CACHE_EVICTIONS);
+
+      while (m_entries.size() > m_options.max_entries or m_bytes > m_options.max_bytes)
+      {
+         eraseLocked(std::prev(m_entries.end()));
+         ++m_stats.evictions;
+         evictions.add();
+      }
+   }
+
+} // namespace oura_charts
@@ -0,0 +1,256 @@
+//---------------------------------------------------------------------------------------------------------------------
+// ThreadPool.cpp
+//
+// Implementation for classes ThreadPool and TaskGroup
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#include "oura_charts/ThreadPool.h"
+#include "oura_charts/detail/instrumentation.h"
+#include <algorithm>
+#include <limits>
+
+namespace oura_charts
+{
+   namespace
+   {
+      constexpr size_t NO_QUEUE = std::numeric_limits<size_t>::max();
+
+      // the pool (if any) that the current thread is a worker for, and the index of its queue.
+      thread_local const ThreadPool* t_pool = nullptr;
+      thread_local size_t t_queue_idx = NO_QUEUE;
+
+      // settings for the shared pool
+      std::mutex s_shared_mutex{};
+      size_t s_shared_thread_count{};   // guarded by s_shared_mutex, 0 means use the default
+      bool s_shared_created{};          // guarded by s_shared_mutex
+
+   } // namespace
+
+
+   ThreadPool::ThreadPool(size_t thread_count)
+   {
+      thread_count = std::max<size_t>(thread_count, 1);
+
+      m_queues.reserve(thread_count);
+      for (size_t i = 0; i < thread_count; ++i)
+      {
+         m_queues.emplace_back(std::make_unique<WorkerQueue>());
+      }
+
+      // queues all need to exist before any of the threads start, since they'll try to steal from each other.
+      m_threads.reserve(thread_count);
+      for (size_t i = 0; i < thread_count; ++i)
+      {
+         m_threads.emplace_back([this, i] { workerLoop(i); });
+      }
+   }
+
+
+   ThreadPool::~ThreadPool()
+   {
+      {
+         std::lock_guard lock{ m_wake_mutex };
+         m_stopping = true;
+      }
+      m_wake_cv.notify_all();
+
+      // workers don't exit until the queues are empty. This has to be done explicitly here rather than
+      // leaving it to member destruction, since the threads use the members declared after m_threads.
+      m_threads.clear();
+   }
+
+
+   void ThreadPool::post(Task task)
+   {
+      static auto& task_count = instrumentation::counter(constants::METRIC_POOL_TASKS);
+      task_count.add();
+
+      // a worker queues its own tasks locally, anyone else round-robins across the workers.
+      const size_t queue_idx = isWorkerThread() ? t_queue_idx : m_next_queue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+      {
+         auto& queue = *m_queues[queue_idx];
+         std::lock_guard lock{ queue.mutex };
+         queue.tasks.push_back(std::move(task));
+      }
+
+      // sleeping workers check m_pending with the wake mutex held, so we need to hold it to make sure the
+      // notification isn't missed by a worker that's about to go to sleep.
+      {
+         std::lock_guard lock{ m_wake_mutex };
+         m_pending.fetch_add(1);
+      }
+      m_wake_cv.notify_one();
+   }
+
+
+   bool ThreadPool::runPendingTask()
+   {
+      Task task{};
+      if (isWorkerThread())
+      {
+         if (!popTask(t_queue_idx, task) and !stealTask(t_queue_idx, task))
+            return false;
+      }
+      else if (!stealTask(NO_QUEUE, task))
+      {
+         return false;
+      }
+
+      task();
+      return true;
+   }
+
+
+   bool ThreadPool::isWorkerThread() const noexcept
+   {
+      return t_pool == this;
+   }
+
+
+   ThreadPool& ThreadPool::shared()
+   {
+      static ThreadPool pool{ [] {
+                                 std::lock_guard lock{ s_shared_mutex };
+                                 s_shared_created = true;
+                                 return s_shared_thread_count ? s_shared_thread_count : defaultThreadCount();
+                              }() };
+      return pool;
+   }
+
+
+   bool ThreadPool::setSharedThreadCount(size_t thread_count)
+   {
+      std::lock_guard lock{ s_shared_mutex };
+      if (s_shared_created)
+         return false;
+
+      s_shared_thread_count = thread_count;
+      return true;
+   }
+
+
+   size_t ThreadPool::defaultThreadCount() noexcept
+   {
+      return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+   }
+
+
+   void ThreadPool::workerLoop(size_t queue_idx)
+   {
+      t_pool = this;
+      t_queue_idx = queue_idx;
+
+      Task task{};
+      while (true)
+      {
+         if (popTask(queue_idx, task) or stealTask(queue_idx, task))
+         {
+            task();
+            task = nullptr;
+            continue;
+         }
+
+         std::unique_lock lock{ m_wake_mutex };
+         m_wake_cv.wait(lock, [this] { return m_stopping or m_pending.load() > 0; });
+         if (m_stopping and m_pending.load() == 0)
+            break;
+      }
+   }
+
+
+   bool ThreadPool::popTask(size_t queue_idx, Task& task)
+   {
+      auto& queue = *m_queues[queue_idx];
+      std::lock_guard lock{ queue.mutex };
+      if (queue.tasks.empty())
+         return false;
+
+      // newest first from our own queue
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      m_pending.fetch_sub(1);
+      return true;
+   }
+
+
+   bool ThreadPool::stealTask(size_t thief_idx, Task& task)
+   {
+      static auto& steals = instrumentation::counter(constants::METRIC_POOL_STEALS);
+
+      // start with the queue after the thief's own, so thieves don't all pile onto the first queue.
+      const size_t queue_count = m_queues.size();
+      const size_t start = thief_idx == NO_QUEUE ? m_next_queue.load(std::memory_order_relaxed) : thief_idx + 1;
+      for (size_t i = 0; i < queue_count; ++i)
+      {
+         const size_t victim_idx = (start + i) % queue_count;
+         if (victim_idx == thief_idx)
+            continue;
+
+         auto& queue = *m_queues[victim_idx];
+         std::lock_guard lock{ queue.mutex };
+         if (queue.tasks.empty())
+            continue;
+
+         // oldest first from someone else's queue
+         task = std::move(queue.tasks.front());
+         queue.tasks.pop_front();
+         m_pending.fetch_sub(1);
+         steals.add();
+         return true;
+      }
+      return false;
+   }
+
+
+   TaskGroup::~TaskGroup()
+   {
+      waitForTasks();
+   }
+
+
+   void TaskGroup::wait()
+   {
+      waitForTasks();
+
+      std::exception_ptr error{};
+      {
+         std::lock_guard lock{ m_mutex };
+         std::swap(error, m_error);
+      }
+      if (error)
+         std::rethrow_exception(error);
+   }
+
+
+   void TaskGroup::taskDone()
+   {
+      // notify with the lock held, since the group may be destroyed as soon as the waiter sees the count hit 0.
+      std::lock_guard lock{ m_mutex };
+      if (--m_outstanding == 0)
+         m_done_cv.notify_all();
+   }
+
+
+   void TaskGroup::waitForTasks() noexcept
+   {
+      while (true)
+      {
+         {
+            std::lock_guard lock{ m_mutex };
+            if (m_outstanding == 0)
+               return;
+         }
+
+         // help out instead of blocking. Anything in the pool's queues might be one of ours, or something one of
+         // ours is waiting on. If there's nothing to run, our remaining tasks are already running on other threads.
+         if (!m_pool.runPendingTask())
+         {
+            std::unique_lock lock{ m_mutex };
+            m_done_cv.wait_for(lock, constants::TASK_GROUP_WAIT_INTERVAL, [this] { return m_outstanding == 0; });
+         }
+      }
+   }
+
+} // namespace oura_charts
@@ -0,0 +1,163 @@
+//---------------------------------------------------------------------------------------------------------------------
+// instrumentation.cpp
+//
+// defines the metric registry used by the instrumentation layer.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#include "oura_charts/detail/instrumentation.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace oura_charts::instrumentation
+{
+   using std::string;
+   using std::string_view;
+
+   namespace
+   {
+      struct HistogramEntry
+      {
+         MetricUnit unit{};
+         Histogram hist{};
+      };
+
+      // std::map never relocates its nodes, so references handed out by counter()/histogram() stay
+      // valid while other metrics are being added.
+      struct MetricRegistry
+      {
+         std::mutex mutex{};
+         std::map<string, Counter, std::less<>> counters{};
+         std::map<string, HistogramEntry, std::less<>> histograms{};
+      };
+
+      MetricRegistry& registry()
+      {
+         static MetricRegistry reg{};
+         return reg;
+      }
+
+      string_view unitName(MetricUnit unit)
+      {
+         switch (unit)
+         {
+         case MetricUnit::Bytes:
+            return "bytes";
+         case MetricUnit::Nanoseconds:
+            return "ns";
+         case MetricUnit::Count:
+            break;
+         }
+         return "count";
+      }
+
+   } // namespace
+
+
+   void Histogram::reset() noexcept
+   {
+      m_count.store(0, std::memory_order_relaxed);
+      m_sum.store(0, std::memory_order_relaxed);
+      m_min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+      m_max.store(0, std::memory_order_relaxed);
+      for (auto& bucket : m_buckets)
+         bucket.store(0, std::memory_order_relaxed);
+   }
+
+
+   Counter& counter(string_view name)
+   {
+      auto& reg = registry();
+      std::scoped_lock lock{ reg.mutex };
+
+      auto it = reg.counters.find(name);
+      if (it == reg.counters.end())
+         it = reg.counters.emplace(std::piecewise_construct, std::forward_as_tuple(name), std::forward_as_tuple()).first;
+
+      return it->second;
+   }
+
+
+   Histogram& histogram(string_view name, MetricUnit unit)
+   {
+      auto& reg = registry();
+      std::scoped_lock lock{ reg.mutex };
+
+      auto it = reg.histograms.find(name);
+      if (it == reg.histograms.end())
+      {
+         it = reg.histograms.emplace(std::piecewise_construct, std::forward_as_tuple(name), std::forward_as_tuple()).first;
+         it->second.unit = unit;
+      }
+      return it->second.hist;
+   }
+
+
+   std::vector<MetricSnapshot> snapshot()
+   {
+      auto& reg = registry();
+      std::scoped_lock lock{ reg.mutex };
+
+      std::vector<MetricSnapshot> metrics{};
+      metrics.reserve(reg.counters.size() + reg.histograms.size());
+
+      for (const auto& [name, ctr] : reg.counters)
+      {
+         auto val = ctr.value();
+         if (val)
+            metrics.emplace_back(MetricSnapshot{ name, MetricUnit::Count, val, val, val, val });
+      }
+
+      for (const auto& [name, entry] : reg.histograms)
+      {
+         const auto& hist = entry.hist;
+         if (hist.count())
+            metrics.emplace_back(MetricSnapshot{ name, entry.unit, hist.count(), hist.sum(), hist.min(), hist.max() });
+      }
+
+      std::ranges::sort(metrics, {}, &MetricSnapshot::name);
+      return metrics;
+   }
+
+
+   string snapshotToJson()
+   {
+      string json{ "[" };
+      auto out = std::back_inserter(json);
+
+      bool first = true;
+      for (const auto& metric : snapshot())
+      {
+         fmt::format_to(out, R"({}{{"name":"{}","unit":"{}","count":{},"sum":{},"min":{},"max":{},"avg":{:.3f}}})",
+                        first ? "\n  " : ",\n  ",
+                        metric.name,
+                        unitName(metric.unit),
+                        metric.count,
+                        metric.sum,
+                        metric.min,
+                        metric.max,
+                        metric.average());
+         first = false;
+      }
+      json.append("\n]");
+      return json;
+   }
+
+
+   void reset()
+   {
+      auto& reg = registry();
+      std::scoped_lock lock{ reg.mutex };
+
+      for (auto& [name, ctr] : reg.counters)
+         ctr.reset();
+
+      for (auto& [name, entry] : reg.histograms)
+         entry.hist.reset();
+   }
+
+} // namespace oura_charts::instrumentation
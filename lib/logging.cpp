@@ -105,4 +105,46 @@ namespace oura_charts::logging
    }
 
 
+   [[nodiscard]] log_ptr_t LogFactory::makePrivateAsync(string_view log_name,
+                                                        sinks_init_list sinks,
+                                                        log_level::level_enum max_level,
+                                                        const AsyncLogOptions& options)
+   {
+      try
+      {
+         // the thread pool is shared by all async loggers, only create it the first time through.
+         auto pool = spdlog::thread_pool();
+         if (!pool)
+         {
+            spdlog::init_thread_pool(options.queue_size, options.thread_count);
+            pool = spdlog::thread_pool();
+         }
+
+         // Filter any nullptr's out, since debuggerSync may not always be available.
+         auto sink_view = vw::filter(sinks, [] (const sinks_init_list::value_type& val) -> bool
+                                    {
+                                          return val.get() != nullptr;
+                                    });
+
+         auto logger = make_shared<async_logger>(string{ log_name }, rg::begin(sink_view), rg::end(sink_view), std::move(pool), options.overflow_policy);
+         logger->set_level(max_level);
+         return logger;
+      }
+      catch (std::exception& e)
+      {
+         error("Error initializing async logger {}: {}", log_name, e.what());
+         throw;
+      }
+   }
+
+
+   log_ptr_t LogFactory::makeDefaultAsync(const AsyncLogOptions& options, sinks_init_list sinks, log_level::level_enum max_level)
+   {
+      auto logger = makePrivateAsync(constants::CONFIG_DEFAULT_LOG_NAME, sinks, max_level, options);
+      spdlog::drop(logger->name()); // name collision with existing logger will throw.
+      set_default_logger(logger);
+      return logger;
+   }
+
+
 } // namespace oura_charts::logging
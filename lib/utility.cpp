@@ -15,6 +15,17 @@
 #else
    #include <cstdlib>
 #endif
+#if defined(_WIN32)
+   #include <windows.h>
+#else
+   #include <cerrno>
+   #include <fcntl.h>
+   #include <sys/mman.h>
+   #include <sys/stat.h>
+   #include <unistd.h>
+#endif
+#include <system_error>
+#include <utility>
 
 
 namespace oura_charts::detail
@@ -142,4 +153,157 @@ namespace oura_charts::detail
 #endif
 
 
+#if defined(_WIN32)
+
+   MappedFile::MappedFile(const std::filesystem::path& file_path)
+   {
+      auto fail = [&] (std::string_view operation)
+                  {
+                     const auto error_text = std::error_code{ static_cast<int>(::GetLastError()), std::system_category() }.message();
+                     const auto file_name = file_path.string();
+                     close();
+                     return oura_exception{ ErrorCategory::FileIO, "MappedFile - unable to {} '{}': {}", operation, file_name, error_text };
+                  };
+
+      m_file = ::CreateFileW(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+      if (m_file == INVALID_HANDLE_VALUE)
+      {
+         m_file = nullptr;
+         throw fail("open");
+      }
+
+      LARGE_INTEGER file_size{};
+      if (!::GetFileSizeEx(m_file, &file_size))
+         throw fail("get the size of");
+
+      // can't map an empty file
+      m_size = static_cast<size_t>(file_size.QuadPart);
+      if (m_size == 0)
+         return;
+
+      m_mapping = ::CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (!m_mapping)
+         throw fail("map");
+
+      m_data = static_cast<const char*>(::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+      if (!m_data)
+         throw fail("map");
+   }
+
+
+   void MappedFile::close() noexcept
+   {
+      if (m_data)
+         ::UnmapViewOfFile(m_data);
+      if (m_mapping)
+         ::CloseHandle(m_mapping);
+      if (m_file)
+         ::CloseHandle(m_file);
+
+      m_data = nullptr;
+      m_size = 0;
+      m_mapping = nullptr;
+      m_file = nullptr;
+   }
+
+
+   MappedFile::MappedFile(MappedFile&& other) noexcept :
+      m_data{ std::exchange(other.m_data, nullptr) },
+      m_size{ std::exchange(other.m_size, 0) },
+      m_file{ std::exchange(other.m_file, nullptr) },
+      m_mapping{ std::exchange(other.m_mapping, nullptr) }
+   {}
+
+
+   MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+   {
+      if (this != &other)
+      {
+         close();
+         m_data = std::exchange(other.m_data, nullptr);
+         m_size = std::exchange(other.m_size, 0);
+         m_file = std::exchange(other.m_file, nullptr);
+         m_mapping = std::exchange(other.m_mapping, nullptr);
+      }
+      return *this;
+   }
+
+#else // Linux
+
+   MappedFile::MappedFile(const std::filesystem::path& file_path)
+   {
+      auto fail = [&] (std::string_view operation)
+                  {
+                     const auto error_text = std::error_code{ errno, std::generic_category() }.message();
+                     const auto file_name = file_path.string();
+                     return oura_exception{ ErrorCategory::FileIO, "MappedFile - unable to {} '{}': {}", operation, file_name, error_text };
+                  };
+
+      const int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC); // NOLINT(cppcoreguidelines-pro-type-vararg)
+      if (fd < 0)
+         throw fail("open");
+
+      // the mapping keeps its own reference to the file, so the descriptor can be closed as soon as it's mapped.
+      struct stat file_info{};
+      if (::fstat(fd, &file_info) != 0)
+      {
+         auto e = fail("get the size of");
+         ::close(fd);
+         throw e;
+      }
+
+      // can't map an empty file
+      m_size = static_cast<size_t>(file_info.st_size);
+      if (m_size > 0)
+      {
+         void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+         if (data == MAP_FAILED) // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+         {
+            auto e = fail("map");
+            ::close(fd);
+            m_size = 0;
+            throw e;
+         }
+         m_data = static_cast<const char*>(data);
+      }
+      ::close(fd);
+   }
+
+
+   void MappedFile::close() noexcept
+   {
+      if (m_data)
+         ::munmap(const_cast<char*>(m_data), m_size); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+
+      m_data = nullptr;
+      m_size = 0;
+   }
+
+
+   MappedFile::MappedFile(MappedFile&& other) noexcept :
+      m_data{ std::exchange(other.m_data, nullptr) },
+      m_size{ std::exchange(other.m_size, 0) }
+   {}
+
+
+   MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+   {
+      if (this != &other)
+      {
+         close();
+         m_data = std::exchange(other.m_data, nullptr);
+         m_size = std::exchange(other.m_size, 0);
+      }
+      return *this;
+   }
+
+#endif
+
+
+   MappedFile::~MappedFile()
+   {
+      close();
+   }
+
+
 } // namespace oura_charts::detail
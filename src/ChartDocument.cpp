@@ -1,8 +1,43 @@
 #include "ChartDocument.h"
+#include "OuraChartsApp.h"
 
 namespace oura_charts
 {
+   void ChartDocument::setDateRange(const DateRange& range)
+   {
+      auto token_res = wxGetApp().getRestToken();
+      if (!token_res)
+         throw oura_exception{ std::move(token_res.error()) };
 
+      // the prefetcher keeps using the token it was created with, so if the token has changed it has to go before
+      // getDataProvider() clears the cache, or it could keep filling it with the previous account's data.
+      // Destroying it cancels anything pending and waits for a request that's already been sent.
+      if (m_prefetcher and token_res->getToken() != m_prefetch_token)
+         m_prefetcher.reset();
 
+      auto provider_res = wxGetApp().getDataProvider();
+      if (!provider_res)
+         throw oura_exception{ std::move(provider_res.error()) };
+
+      // the prefetcher shares the app's response cache, so anything it fetches is there for the next call.
+      if (!m_prefetcher)
+      {
+         m_prefetcher = std::make_unique<RangePrefetcher>(provider_res.value());
+         m_prefetch_token = token_res->getToken();
+      }
+
+      {
+         // prefetching holds off while the user is waiting for this.
+         auto foreground = m_prefetcher->foreground();
+         m_sleep_sessions = getDataSeries<SleepSession>(provider_res.value(), range.from, range.thru);
+      }
+      m_range = range;
+
+      // replaces whatever was being prefetched for the previous range, since that's no longer where the user is.
+      auto [previous, next] = adjacentRanges(range);
+      m_prefetcher->prefetch<SleepSession>({ previous, next });
+
+      UpdateAllViews();
+   }
 
 } // namespace oura_charts
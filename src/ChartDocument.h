@@ -1,6 +1,10 @@
 #pragma once
 #include "oura_charts/chrono_helpers.h"
+#include "oura_charts/RangePrefetcher.h"
+#include "oura_charts/SleepSession.h"
 #include <wx/docview.h>
+#include <memory>
+#include <string>
 
 
 namespace oura_charts
@@ -12,10 +16,25 @@ namespace oura_charts
       ChartDocument() = default;
       ~ChartDocument() override = default;
 
+      /// <summary>
+      ///   Change the date range the document is showing, retrieving its data and updating the views. The ranges
+      ///   either side of it are then prefetched in the background, so moving to the previous/next range doesn't
+      ///   have to wait for the server. Throws if the data can't be retrieved.
+      /// </summary>
+      void setDateRange(const DateRange& range) noexcept(false);
+
+      // move to the range immediately before/after the current one.
+      void showPreviousRange() noexcept(false) { setDateRange(adjacentRanges(m_range).first); }
+      void showNextRange() noexcept(false)     { setDateRange(adjacentRanges(m_range).second); }
+
+      const DateRange& dateRange() const noexcept                      { return m_range; }
+      const DataSeries<SleepSession>& sleepSessions() const noexcept   { return m_sleep_sessions; }
 
    private:
-      //year_month_day m_from_date{};
-      //year_month_day m_until_date{};
+      DateRange m_range{};
+      DataSeries<SleepSession> m_sleep_sessions{};
+      std::unique_ptr<RangePrefetcher> m_prefetcher{};   // created on first use, since it needs a token.
+      std::string m_prefetch_token{};                    // token m_prefetcher's requests are sent with
    };
 
 } // namespace oura_charts
@@ -6,7 +6,7 @@
 
 #include "oura_charts/chrono_helpers.h"
 #include "oura_charts/DailySleepScore.h"
-#include "oura_charts/RestDataProvider.h"
+#include "oura_charts/GroupedAggregator.h"
 #include "oura_charts/UserProfile.h"
 
 #include <wx/artprov.h>
@@ -66,31 +66,22 @@ namespace oura_charts
 
          auto today = stripTimeOfDay(localNow());
          auto last_year = today - months{ 12 };
-         auto token_res = wxGetApp().getRestToken();
-         if (!token_res)
-            throw oura_exception{ std::move(token_res.error()) };
+         auto provider_res = wxGetApp().getDataProvider();
+         if (!provider_res)
+            throw oura_exception{ std::move(provider_res.error()) };
 
-         RestDataProvider rest_server{ token_res.value(), constants::REST_DEFAULT_BASE_URL };
+         auto& rest_server = provider_res.value();
 
-         auto score_data = getDataSeries<DailySleepScore>(rest_server, getCalendarDate(last_year), getCalendarDate(today));
-         auto score_by_weekday = group<SleepScoreByWeekday>(std::move(score_data), sleepScoreWeekday);
+         // we only need the averages, so aggregate the scores as they're parsed instead of storing them.
+         auto avg_by_weekday = aggregateDataSeries<DailySleepScore, AvgCalc<int>>(rest_server, getCalendarDate(last_year), getCalendarDate(today),
+                                                                                  sleepScoreWeekday, &DailySleepScore::score);
 
-         // calculate various averages by day of week.
+         // weekdays without any data just get a null result.
          constexpr auto weekdays = getWeekdays();
          vector<nullable_double> avg_score(weekdays.size());
-
          for (auto wd : weekdays)
          {
-            // get the sub range representing all the data for the current weekday. could be an empty range,
-            // but that won't cause any problems we'll just get null result.
-            AvgCalc<uint32_t> calc_score{};
-            auto [score_beg, score_end] = score_by_weekday.equal_range(wd);
-            rg::subrange score_range{ score_beg, score_end };
-            rg::for_each(score_range | vw::values, [&] (const DailySleepScore& score)
-                                        {
-                                              calc_score(score.score());
-                                        });
-            avg_score[wd.c_encoding()] = calc_score.result();
+            avg_score[wd.c_encoding()] = avg_by_weekday.result(wd);
          }
 
          matplot::bar(avg_score | vw::transform([] (auto&& val) -> auto
@@ -127,17 +118,16 @@ namespace oura_charts
    {
       try
       {
-         auto auth_res = wxGetApp().getRestToken();
-         if (auth_res)
+         auto provider_res = wxGetApp().getDataProvider();
+         if (provider_res)
          {
-            RestDataProvider provider{ *auth_res, constants::REST_DEFAULT_BASE_URL };
-            auto profile = getUserProfile(provider);
+            auto profile = getUserProfile(*provider_res);
             AboutDialog dlg(profile, this);
             dlg.ShowModal();
          }
          else
          {
-            AboutDialog dlg(auth_res.error().message.c_str(), this);
+            AboutDialog dlg(provider_res.error().message.c_str(), this);
             dlg.ShowModal();
          }
       }
@@ -100,6 +100,23 @@ namespace oura_charts
       return TokenAuth{ pat.ToStdString() };
    }
 
+
+   OuraChartsApp::DataProviderResult OuraChartsApp::getDataProvider()
+   {
+      auto token_res = getRestToken();
+      if (!token_res)
+         return unexpected{ std::move(token_res.error()) };
+
+      // cached responses belong to the account they were retrieved with.
+      if (token_res->getToken() != m_cache_token)
+      {
+         m_response_cache->clear();
+         m_cache_token = token_res->getToken();
+      }
+
+      return DataProviderType{ RestDataProvider{ std::move(token_res.value()), constants::REST_DEFAULT_BASE_URL, m_scheduler }, m_response_cache };
+   }
+
 }  // namespace oura_charts
 
 // this needs to be outside the namespace for Linux but not Windows, go figure
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "constants.h"
+#include "oura_charts/RequestScheduler.h"
+#include "oura_charts/ResponseCache.h"
+#include "oura_charts/RestDataProvider.h"
 #include "oura_charts/TokenAuth.h"
 
 #include <wx/app.h>
@@ -8,6 +11,7 @@
 #include <wx/docview.h>
 
 #include <memory>
+#include <string>
 
 namespace oura_charts
 {
@@ -33,6 +37,15 @@ namespace oura_charts
       using TokenResult = expected<TokenAuth, oura_exception>;
       TokenResult getRestToken() const;
 
+      /// <summary>
+      ///   Gets a data provider for the Oura REST API using the current token. Responses are cached in memory
+      ///   and shared by every provider this returns, so repeating a request (eg reopening a dialog or redrawing
+      ///   a chart) doesn't go back to the server. The cache is cleared if the token changes.
+      /// </summary>
+      using DataProviderType = CachingDataProvider<RestDataProvider<TokenAuth>>;
+      using DataProviderResult = expected<DataProviderType, oura_exception>;
+      DataProviderResult getDataProvider();
+
       /// <summary>
       ///   Get the document manager for the application.
       /// </summary>
@@ -44,6 +57,9 @@ namespace oura_charts
 
    private:
       std::shared_ptr<wxDocManager> m_doc_mgr{};
+      std::shared_ptr<ResponseCache> m_response_cache{ std::make_shared<ResponseCache>() };
+      std::shared_ptr<RequestScheduler> m_scheduler{ std::make_shared<RequestScheduler>() };
+      std::string m_cache_token{};
    };
 
 }  // namespace oura_charts
@@ -0,0 +1,71 @@
+//---------------------------------------------------------------------------------------------------------------------
+// CountingResource.h
+//
+// memory resource that counts the allocations passed through to its upstream resource, used by tests and
+// benchmarks to measure how many allocations an operation makes.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+
+namespace oura_charts::test
+{
+   /// <summary>
+   ///   std::pmr::memory_resource that forwards to an upstream resource, and keeps track of how many
+   ///   allocations/bytes were requested and are still outstanding. Not thread-safe.
+   /// </summary>
+   class CountingResource : public std::pmr::memory_resource
+   {
+   public:
+      explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) noexcept :
+         m_upstream{ upstream }
+      {}
+
+      // total number of calls to allocate()
+      size_t allocationCount() const noexcept { return m_allocations; }
+
+      // total number of bytes requested by calls to allocate()
+      size_t bytesAllocated() const noexcept { return m_bytes; }
+
+      // number of allocations that haven't been deallocated yet.
+      size_t outstandingCount() const noexcept { return m_allocations - m_deallocations; }
+
+      void reset() noexcept
+      {
+         m_allocations = 0;
+         m_deallocations = 0;
+         m_bytes = 0;
+      }
+
+   private:
+      std::pmr::memory_resource* m_upstream;
+      size_t m_allocations{};
+      size_t m_deallocations{};
+      size_t m_bytes{};
+
+      void* do_allocate(size_t bytes, size_t alignment) override
+      {
+         auto* ptr = m_upstream->allocate(bytes, alignment);
+         ++m_allocations;
+         m_bytes += bytes;
+         return ptr;
+      }
+
+      void do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+      {
+         m_upstream->deallocate(ptr, bytes, alignment);
+         ++m_deallocations;
+      }
+
+      bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+      {
+         return this == &other;
+      }
+   };
+
+} // namespace oura_charts::test
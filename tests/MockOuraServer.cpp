@@ -0,0 +1,312 @@
+//---------------------------------------------------------------------------------------------------------------------
+// MockOuraServer.cpp
+//
+// Loopback HTTP server that mimics the Oura REST API using synthetic data, so RestDataProvider can be tested end to
+// end with no network access.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#include "MockOuraServer.h"
+#include <httplib.h>
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+#include <algorithm>
+#include <charconv>
+#include <numeric>
+
+namespace oura_charts::test
+{
+   using std::string;
+   using std::string_view;
+   using namespace std::literals;
+
+   namespace
+   {
+      constexpr const char* MOCK_SERVER_HOST = "127.0.0.1";
+      constexpr const char* MOCK_SERVER_PATH_PREFIX = "/v2/usercollection";
+      constexpr const char* CONTENT_TYPE_JSON = "application/json";
+
+      constexpr int HTTP_NOT_MODIFIED = 304;
+      constexpr int HTTP_BAD_REQUEST = 400;
+      constexpr int HTTP_UNAUTHORIZED = 401;
+      constexpr int HTTP_TOO_MANY_REQUESTS = 429;
+
+      // date/time params are truncated to this length ("YYYY-MM-DDTHH:MM:SS"), which drops any UTC offset.
+      constexpr size_t ISO_DATETIME_LENGTH = 19;
+      constexpr size_t ISO_DATE_LENGTH = 10;
+
+
+      enum class FilterBound
+      {
+         Lower,
+         UpperInclusive,
+         UpperExclusive
+      };
+
+
+      // get the value of a string field from a JSON record, truncated to max_len chars.
+      string_view fieldValue(string_view record, string_view field, size_t max_len)
+      {
+         auto key = fmt::format(R"("{}":")", field);
+         auto pos = record.find(key);
+         if (pos == string_view::npos)
+            throw oura_exception{ ErrorCategory::Parse, "MockOuraServer - record missing '{}' field", field };
+
+         return record.substr(pos + key.size(), max_len);
+      }
+
+
+      // compares only the leading characters the key and the param have in common, so a date param can be compared
+      // to a timestamp key and vice-versa.
+      std::strong_ordering comparePrefix(string_view key, string_view param)
+      {
+         auto len = std::min(key.size(), param.size());
+         return key.substr(0, len) <=> param.substr(0, len);
+      }
+
+
+      void setError(httplib::Response& res, int status, string_view detail)
+      {
+         res.status = status;
+         res.set_content(fmt::format(R"({{"detail":"{}"}})", detail), CONTENT_TYPE_JSON);
+      }
+
+
+      // the ETag is a hash of the body, so it changes whenever the content does.
+      string makeETag(string_view body)
+      {
+         return fmt::format(R"("{:x}")", std::hash<string_view>{}(body));
+      }
+
+   } // namespace
+
+
+   MockOuraServer::MockOuraServer(const SyntheticDataGenerator& generator, MockServerOptions options) :
+      m_options{ std::move(options) },
+      m_server{ std::make_unique<httplib::Server>() }
+   {
+      // keep the records sorted by key, so we can binary search the filter ranges.
+      auto addCollection = [this] (string path, SyntheticDataGenerator::JsonRecords records, string_view key_field, size_t key_len)
+         {
+            std::vector<size_t> order(records.size());
+            std::iota(order.begin(), order.end(), size_t{ 0 });
+
+            std::vector<string> keys{};
+            keys.reserve(records.size());
+            rg::transform(records, std::back_inserter(keys), [&] (const string& rec) { return string{ fieldValue(rec, key_field, key_len) }; });
+            rg::stable_sort(order, {}, [&keys] (size_t idx) -> const string& { return keys[idx]; });
+
+            Collection coll{};
+            coll.keys.reserve(records.size());
+            coll.records.reserve(records.size());
+            for (auto idx : order)
+            {
+               coll.keys.emplace_back(std::move(keys[idx]));
+               coll.records.emplace_back(std::move(records[idx]));
+            }
+            m_collections.emplace(std::move(path), std::move(coll));
+         };
+
+      addCollection(constants::REST_PATH_HEART_RATE, generator.heartRateRecords(), "timestamp", ISO_DATETIME_LENGTH);
+      addCollection(constants::REST_PATH_SLEEP_SESSION, generator.sleepSessionRecords(), "day", ISO_DATE_LENGTH);
+      addCollection(constants::REST_PATH_DAILY_SLEEP, generator.dailySleepScoreRecords(), "day", ISO_DATE_LENGTH);
+      m_personal_info = generator.personalInfoJson();
+
+      for (const auto& [path, coll] : m_collections)
+      {
+         m_server->Get(fmt::format("{}/{}", MOCK_SERVER_PATH_PREFIX, path),
+                       [this, &coll] (const httplib::Request& req, httplib::Response& res) { handleCollection(coll, req, res); });
+      }
+      m_server->Get(fmt::format("{}/{}", MOCK_SERVER_PATH_PREFIX, constants::REST_PATH_PERSONAL_INFO),
+                    [this] (const httplib::Request& req, httplib::Response& res) { handlePersonalInfo(req, res); });
+
+      m_port = m_server->bind_to_any_port(MOCK_SERVER_HOST);
+      if (m_port < 0)
+         throw oura_exception{ ErrorCategory::REST, "MockOuraServer - unable to bind to a port on {}", MOCK_SERVER_HOST };
+
+      m_listen_thread = std::jthread{ [this] { m_server->listen_after_bind(); } };
+      m_server->wait_until_ready();
+   }
+
+
+   MockOuraServer::~MockOuraServer()
+   {
+      m_server->stop();
+      if (m_listen_thread.joinable())
+         m_listen_thread.join();
+   }
+
+
+   string MockOuraServer::baseUrl() const
+   {
+      return fmt::format("http://{}:{}{}", MOCK_SERVER_HOST, m_port, MOCK_SERVER_PATH_PREFIX);
+   }
+
+
+   MockServerOptions MockOuraServer::options() const
+   {
+      std::scoped_lock lock{ m_mutex };
+      return m_options;
+   }
+
+
+   void MockOuraServer::setOptions(MockServerOptions options)
+   {
+      std::scoped_lock lock{ m_mutex };
+      m_options = std::move(options);
+      m_request_times.clear();
+   }
+
+
+   void MockOuraServer::resetCounts() noexcept
+   {
+      m_request_count = 0;
+      m_throttled_count = 0;
+      m_not_modified_count = 0;
+      m_max_concurrent = 0;
+   }
+
+
+   std::optional<MockServerOptions> MockOuraServer::beginRequest(const httplib::Request& req, httplib::Response& res)
+   {
+      ++m_request_count;
+
+      std::unique_lock lock{ m_mutex };
+      auto options = m_options;
+
+      if (!options.token.empty() && req.get_header_value("Authorization") != fmt::format("{}{}", constants::REST_PARAM_AUTH_TOKEN_PREFIX, options.token))
+      {
+         lock.unlock();
+         setError(res, HTTP_UNAUTHORIZED, "invalid or missing access token");
+         return std::nullopt;
+      }
+
+      if (options.throttle_limit)
+      {
+         // sliding window of the request times that count against the limit.
+         auto now = std::chrono::steady_clock::now();
+         while (!m_request_times.empty() && now - m_request_times.front() >= options.throttle_window)
+            m_request_times.pop_front();
+
+         if (m_request_times.size() >= options.throttle_limit)
+         {
+            lock.unlock();
+            ++m_throttled_count;
+            res.set_header("Retry-After", std::to_string(options.retry_after.count()));
+            setError(res, HTTP_TOO_MANY_REQUESTS, "rate limit exceeded");
+            return std::nullopt;
+         }
+         m_request_times.push_back(now);
+      }
+      lock.unlock();
+
+      if (options.latency.count())
+      {
+         // keep track of how many requests are waiting at the same time.
+         const auto concurrent = ++m_concurrent;
+         auto max_concurrent = m_max_concurrent.load();
+         while (concurrent > max_concurrent && !m_max_concurrent.compare_exchange_weak(max_concurrent, concurrent))
+         {}
+
+         std::this_thread::sleep_for(options.latency);
+         --m_concurrent;
+      }
+
+      return options;
+   }
+
+
+   void MockOuraServer::handleCollection(const Collection& coll, const httplib::Request& req, httplib::Response& res)
+   {
+      auto options = beginRequest(req, res);
+      if (!options)
+         return;
+
+      const auto& keys = coll.keys;
+      auto first = keys.begin();
+      auto last = keys.end();
+
+      // narrow [first, last) by whichever filter params were specified.
+      auto filter = [&] (const char* param, FilterBound bound) -> bool
+         {
+            if (!req.has_param(param))
+               return true;
+
+            auto value = req.get_param_value(param).substr(0, ISO_DATETIME_LENGTH);
+            if (value.size() < ISO_DATE_LENGTH)
+            {
+               setError(res, HTTP_BAD_REQUEST, fmt::format("invalid value for {}", param));
+               return false;
+            }
+
+            if (bound == FilterBound::UpperInclusive)
+               last = std::min(last, rg::partition_point(keys, [&] (const string& key) { return comparePrefix(key, value) <= 0; }));
+            else if (bound == FilterBound::UpperExclusive)
+               last = std::min(last, rg::partition_point(keys, [&] (const string& key) { return comparePrefix(key, value) < 0; }));
+            else
+               first = std::max(first, rg::partition_point(keys, [&] (const string& key) { return comparePrefix(key, value) < 0; }));
+
+            return true;
+         };
+
+      if (!filter(constants::REST_PARAM_START_DATE, FilterBound::Lower) or
+          !filter(constants::REST_PARAM_START_DATETIME, FilterBound::Lower) or
+          !filter(constants::REST_PARAM_END_DATE, FilterBound::UpperInclusive) or
+          !filter(constants::REST_PARAM_END_DATETIME, FilterBound::UpperExclusive))
+      {
+         return;
+      }
+      last = std::max(first, last);
+
+      // next_token is just the index of the next record to return.
+      auto begin_idx = static_cast<size_t>(first - keys.begin());
+      auto end_idx = static_cast<size_t>(last - keys.begin());
+      auto page_idx = begin_idx;
+      if (req.has_param(constants::REST_PARAM_NEXT_TOKEN))
+      {
+         auto token = req.get_param_value(constants::REST_PARAM_NEXT_TOKEN);
+         auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), page_idx);
+         if (ec != std::errc{} or ptr != token.data() + token.size() or page_idx < begin_idx or page_idx > end_idx)
+         {
+            setError(res, HTTP_BAD_REQUEST, "invalid next_token");
+            return;
+         }
+      }
+
+      auto page_end = options->page_size ? std::min(end_idx, page_idx + options->page_size) : end_idx;
+      auto page_first = coll.records.begin() + static_cast<ptrdiff_t>(page_idx);
+      auto page_last = coll.records.begin() + static_cast<ptrdiff_t>(page_end);
+
+      string body{ R"({"data":[)" };
+      fmt::format_to(std::back_inserter(body), "{}", fmt::join(page_first, page_last, ","));
+      if (page_end < end_idx)
+         fmt::format_to(std::back_inserter(body), R"(],"next_token":"{}"}})", page_end);
+      else
+         body.append(R"(],"next_token":null})");
+
+      sendJson(req, res, std::move(body));
+   }
+
+
+   void MockOuraServer::handlePersonalInfo(const httplib::Request& req, httplib::Response& res)
+   {
+      if (beginRequest(req, res))
+         sendJson(req, res, m_personal_info);
+   }
+
+
+   void MockOuraServer::sendJson(const httplib::Request& req, httplib::Response& res, string body)
+   {
+      auto etag = makeETag(body);
+      res.set_header("ETag", etag);
+      if (req.get_header_value("If-None-Match") == etag)
+      {
+         ++m_not_modified_count;
+         res.status = HTTP_NOT_MODIFIED;
+         return;
+      }
+      res.set_content(std::move(body), CONTENT_TYPE_JSON);
+   }
+
+} // namespace oura_charts::test
@@ -0,0 +1,144 @@
+//---------------------------------------------------------------------------------------------------------------------
+// MockOuraServer.h
+//
+// Loopback HTTP server that mimics the Oura REST API using synthetic data, so RestDataProvider can be tested end to
+// end with no network access.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "oura_charts/oura_charts.h"
+#include "SyntheticDataGenerator.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace httplib
+{
+   class Server;
+   struct Request;
+   struct Response;
+}
+
+
+namespace oura_charts::test
+{
+   /// <summary>
+   ///   settings that control how MockOuraServer responds to requests. These can be changed while the server is
+   ///   running.
+   /// </summary>
+   struct MockServerOptions
+   {
+      // max number of records returned in a single response, the rest are available through next_token.
+      size_t page_size{ 1000 };
+
+      // delay added to every response, to simulate network/server latency.
+      std::chrono::milliseconds latency{ 0 };
+
+      // If more than throttle_limit requests are received within throttle_window, the server responds with
+      // HTTP 429 (Too Many Requests) and a Retry-After header until the window has room. 0 means no limit.
+      size_t throttle_limit{ 0 };
+      std::chrono::milliseconds throttle_window{ 1000 };
+      seconds retry_after{ 1 };
+
+      // If not empty, requests must have an "Authorization: Bearer <token>" header with this token or they
+      // will get HTTP 401.
+      std::string token{};
+   };
+
+
+   /// <summary>
+   ///   Serves the heartrate, sleep, daily_sleep and personal_info endpoints on the loopback interface, using data
+   ///   from a SyntheticDataGenerator. Listens on a random free port from construction until destruction.
+   /// </summary>
+   /// <remarks>
+   ///   Responses have an ETag, and requests with a matching If-None-Match header get a 304 with no body.
+   ///
+   ///   Collection endpoints filter on start_date/end_date (inclusive, compared against the record's day) and
+   ///   start_datetime/end_datetime (end is exclusive, compared against the record's timestamp), and return paged
+   ///   results linked by next_token the same way the real API does. All date/time params are assumed to be UTC.
+   /// </remarks>
+   class MockOuraServer
+   {
+   public:
+      explicit MockOuraServer(const SyntheticDataGenerator& generator, MockServerOptions options = {});
+      ~MockOuraServer();
+
+      MockOuraServer(const MockOuraServer&) = delete;
+      MockOuraServer(MockOuraServer&&) = delete;
+      MockOuraServer& operator=(const MockOuraServer&) = delete;
+      MockOuraServer& operator=(MockOuraServer&&) = delete;
+
+      /// <summary>
+      ///   base URL to pass to RestDataProvider, eg "http://127.0.0.1:54321/v2/usercollection"
+      /// </summary>
+      [[nodiscard]] std::string baseUrl() const;
+      [[nodiscard]] int port() const noexcept { return m_port; }
+
+      /// <summary>
+      ///   get/set the current options. New options take effect with the next request.
+      /// </summary>
+      [[nodiscard]] MockServerOptions options() const;
+      void setOptions(MockServerOptions options);
+
+      /// <summary>
+      ///   number of requests received, how many of those got a 429 response, and how many got a 304 response
+      ///   because the If-None-Match header matched the ETag of the response.
+      /// </summary>
+      [[nodiscard]] size_t requestCount() const noexcept     { return m_request_count.load();      }
+      [[nodiscard]] size_t throttledCount() const noexcept   { return m_throttled_count.load();    }
+      [[nodiscard]] size_t notModifiedCount() const noexcept { return m_not_modified_count.load(); }
+      void resetCounts() noexcept;
+
+      /// <summary>
+      ///   the most requests that were waiting out the 'latency' delay at the same time, which shows whether a
+      ///   client's requests overlapped. Always 0 if latency is 0.
+      /// </summary>
+      [[nodiscard]] size_t maxConcurrentRequests() const noexcept { return m_max_concurrent.load(); }
+
+   private:
+      // records for a collection endpoint, sorted by filter key (timestamp or day)
+      struct Collection
+      {
+         std::vector<std::string> keys{};
+         SyntheticDataGenerator::JsonRecords records{};
+      };
+
+      mutable std::mutex m_mutex{};
+      MockServerOptions m_options;
+      std::deque<std::chrono::steady_clock::time_point> m_request_times{};
+
+      std::map<std::string, Collection, std::less<>> m_collections{};
+      std::string m_personal_info{};
+
+      std::atomic<size_t> m_request_count{};
+      std::atomic<size_t> m_throttled_count{};
+      std::atomic<size_t> m_not_modified_count{};
+      std::atomic<size_t> m_concurrent{};
+      std::atomic<size_t> m_max_concurrent{};
+
+      std::unique_ptr<httplib::Server> m_server;
+      int m_port{};
+      std::jthread m_listen_thread{};
+
+      // Applies auth/throttling, returns the current options or nullopt if the response has already
+      // been filled in with an error (401 or 429)
+      [[nodiscard]] std::optional<MockServerOptions> beginRequest(const httplib::Request& req, httplib::Response& res);
+      void handleCollection(const Collection& coll, const httplib::Request& req, httplib::Response& res);
+      void handlePersonalInfo(const httplib::Request& req, httplib::Response& res);
+
+      // sends the body with an ETag header, or a 304 response if it matches the request's If-None-Match
+      void sendJson(const httplib::Request& req, httplib::Response& res, std::string body);
+   };
+
+} // namespace oura_charts::test
@@ -0,0 +1,422 @@
+//---------------------------------------------------------------------------------------------------------------------
+// SyntheticDataGenerator.cpp
+//
+// Generates realistic (but fake) paged JSON data for the REST endpoints, so that tests and benchmarks can run at
+// production data volumes without hitting the REST API.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#include "SyntheticDataGenerator.h"
+#include <fmt/format.h>
+#include <fmt/chrono.h>
+#include <fmt/ranges.h>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <optional>
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+namespace oura_charts::test
+{
+   using std::string;
+
+   namespace
+   {
+      // xor'ed with the seed so each endpoint gets an independent stream of random values.
+      constexpr uint64_t STREAM_HEART_RATE = 0x4852'0000'0000'0001;
+      constexpr uint64_t STREAM_SLEEP = 0x534C'0000'0000'0002;
+      constexpr uint64_t STREAM_DAILY_SLEEP = 0x4453'0000'0000'0003;
+
+      // Oura reports interval data (HR, HRV) in 5 minute increments, movement in 30 second increments.
+      constexpr seconds INTERVAL_5_MIN{ 300 };
+      constexpr seconds INTERVAL_30_SEC{ 30 };
+
+      /// <summary>
+      ///   thin wrapper over mt19937_64 that produces the same values on every platform.
+      /// </summary>
+      class SeededRandom
+      {
+      public:
+         explicit SeededRandom(uint64_t seed) : m_engine{ seed } {}
+
+         // random int in the closed range [low, high]
+         int range(int low, int high)
+         {
+            return low + static_cast<int>(m_engine() % static_cast<uint64_t>(high - low + 1));
+         }
+
+         // random double in the range [0.0, 1.0)
+         double unit()
+         {
+            return static_cast<double>(m_engine() >> 11) * 0x1.0p-53;
+         }
+
+         // random double in the range [low, high)
+         double real(double low, double high)
+         {
+            return low + ((high - low) * unit());
+         }
+
+         bool chance(double probability)
+         {
+            return unit() < probability;
+         }
+
+         // random value that will be null according to the probability.
+         std::optional<double> nullableReal(double probability, double low, double high)
+         {
+            if (chance(probability))
+               return std::nullopt;
+            return real(low, high);
+         }
+
+         // looks like a UUID, which is what the REST API uses for id's
+         string uuid()
+         {
+            // function arguments can be evaluated in any order, so each value is drawn before formatting. This
+            // applies to every call that takes more than one random value.
+            const auto time_low = m_engine() & 0xFFFF'FFFF;
+            const auto time_mid = m_engine() & 0xFFFF;
+            const auto time_high = m_engine() & 0xFFF;
+            const auto clock_seq = (m_engine() & 0x3FFF) | 0x8000;
+            const auto node = m_engine() & 0xFFFF'FFFF'FFFF;
+            return fmt::format("{:08x}-{:04x}-4{:03x}-{:04x}-{:012x}", time_low, time_mid, time_high, clock_seq, node);
+         }
+
+         // string of random digits in the range ['1', max_digit]
+         string digits(size_t count, char max_digit)
+         {
+            string text(count, '1');
+            rg::generate(text, [&] { return static_cast<char>('1' + range(0, max_digit - '1')); });
+            return text;
+         }
+
+      private:
+         std::mt19937_64 m_engine;
+      };
+
+
+      string formatNullable(std::optional<double> val)
+      {
+         return val ? fmt::format("{:.3f}", *val) : string{ "null" };
+      }
+
+
+      string formatIntervalItems(SeededRandom& rng, size_t count, double null_density, double low, double high)
+      {
+         std::vector<string> items{};
+         items.reserve(count);
+         for (size_t idx = 0; idx < count; ++idx)
+         {
+            items.emplace_back(formatNullable(rng.nullableReal(null_density, low, high)));
+         }
+         return fmt::format("[{}]", fmt::join(items, ","));
+      }
+
+   } // namespace
+
+
+   SyntheticDataGenerator::SyntheticDataGenerator(SyntheticDataOptions options) : m_options{ std::move(options) }
+   {
+      if (!m_options.time_zone.empty())
+         m_zone = chrono::locate_zone(m_options.time_zone);
+   }
+
+
+   sys_seconds SyntheticDataGenerator::localToSys(local_seconds ts) const
+   {
+      return m_zone ? m_zone->to_sys(ts, chrono::choose::earliest) : sys_seconds{ ts.time_since_epoch() };
+   }
+
+
+   local_seconds SyntheticDataGenerator::sysToLocal(sys_seconds ts) const
+   {
+      return m_zone ? m_zone->to_local(ts) : local_seconds{ ts.time_since_epoch() };
+   }
+
+
+   string SyntheticDataGenerator::formatLocal(sys_seconds ts) const
+   {
+      auto offset = m_zone ? m_zone->get_info(ts).offset : seconds{ 0 };
+      auto offset_min = chrono::duration_cast<minutes>(offset).count();
+      auto abs_offset_min = std::abs(offset_min);
+
+      // shift the UTC time by the offset, so the formatted value is local time.
+      return fmt::format("{:%FT%T}{}{:02}:{:02}", ts + offset, offset_min < 0 ? '-' : '+', abs_offset_min / 60, abs_offset_min % 60);
+   }
+
+
+   SyntheticDataGenerator::JsonPages SyntheticDataGenerator::paginate(const JsonRecords& records) const
+   {
+      const auto page_size = m_options.page_size ? m_options.page_size : std::max<size_t>(records.size(), 1);
+      const auto page_count = std::max<size_t>((records.size() + page_size - 1) / page_size, 1);
+
+      JsonPages pages{};
+      pages.reserve(page_count);
+      for (size_t page_idx = 0; page_idx < page_count; ++page_idx)
+      {
+         auto first = records.begin() + static_cast<ptrdiff_t>(std::min(page_idx * page_size, records.size()));
+         auto last = records.begin() + static_cast<ptrdiff_t>(std::min((page_idx + 1) * page_size, records.size()));
+
+         string page{ R"({"data":[)" };
+         fmt::format_to(std::back_inserter(page), "{}", fmt::join(first, last, ","));
+
+         // same next_token convention as TestDataProvider::paginateDataSource()
+         auto next_idx = page_idx + 1;
+         if (next_idx < page_count)
+            fmt::format_to(std::back_inserter(page), R"(],"next_token":"{}"}})", next_idx);
+         else
+            page.append(R"(],"next_token":null})");
+
+         pages.emplace_back(std::move(page));
+      }
+      return pages;
+   }
+
+
+   size_t SyntheticDataGenerator::heartRateCount() const noexcept
+   {
+      auto start = localToSys(local_days{ m_options.start_date });
+      auto end = localToSys(local_days{ m_options.start_date } + days{ m_options.num_days });
+      return static_cast<size_t>((end - start + m_options.hr_interval - 1s) / m_options.hr_interval);
+   }
+
+
+   SyntheticDataGenerator::JsonRecords SyntheticDataGenerator::heartRateRecords() const
+   {
+      SeededRandom rng{ m_options.seed ^ STREAM_HEART_RATE };
+
+      JsonRecords records{};
+      records.reserve(heartRateCount());
+
+      auto start = localToSys(local_days{ m_options.start_date });
+      auto end = localToSys(local_days{ m_options.start_date } + days{ m_options.num_days });
+      for (auto ts = start; ts < end; ts += m_options.hr_interval)
+      {
+         // local time of day determines whether we're asleep or not.
+         auto local_ts = sysToLocal(ts);
+         auto hour = chrono::floor<hours>(local_ts - chrono::floor<days>(local_ts));
+
+         int bpm{};
+         std::string_view source{};
+         if (hour < 7h)
+         {
+            source = "sleep";
+            bpm = rng.range(48, 65);
+         }
+         else if (rng.chance(0.02))
+         {
+            source = "workout";
+            bpm = rng.range(110, 165);
+         }
+         else
+         {
+            source = "awake";
+            bpm = rng.range(60, 95);
+         }
+
+         // REST API always returns HR timestamps as UTC
+         records.emplace_back(fmt::format(R"({{"bpm":{},"source":"{}","timestamp":"{:%FT%T}+00:00"}})", bpm, source, ts));
+      }
+      return records;
+   }
+
+
+   SyntheticDataGenerator::JsonRecords SyntheticDataGenerator::sleepSessionRecords() const
+   {
+      SeededRandom rng{ m_options.seed ^ STREAM_SLEEP };
+      const auto null_density = m_options.null_density;
+
+      JsonRecords records{};
+      records.reserve(static_cast<size_t>(m_options.num_days));
+
+      auto makeSession = [&] (local_seconds bedtime_start_local, seconds time_in_bed, std::string_view sleep_type, int period)
+         {
+            auto bedtime_start = localToSys(bedtime_start_local);
+            auto bedtime_end = bedtime_start + time_in_bed;
+            year_month_day day{ chrono::floor<days>(sysToLocal(bedtime_end)) };
+
+            seconds latency{ rng.range(60, 1800) };
+            seconds awake_time = latency + seconds{ rng.range(60, static_cast<int>(time_in_bed.count() / 6)) };
+            seconds total_sleep = time_in_bed - awake_time;
+            seconds deep_sleep{ static_cast<int64_t>(static_cast<double>(total_sleep.count()) * rng.real(0.10, 0.25)) };
+            seconds rem_sleep{ static_cast<int64_t>(static_cast<double>(total_sleep.count()) * rng.real(0.15, 0.30)) };
+            seconds light_sleep = total_sleep - deep_sleep - rem_sleep;
+
+            auto interval_count = static_cast<size_t>(time_in_bed / INTERVAL_5_MIN);
+            auto interval_start = formatLocal(bedtime_start);
+
+            const auto id = rng.uuid();
+            const auto average_breath = formatNullable(rng.nullableReal(null_density, 12.0, 18.0));
+            const auto average_heart_rate = formatNullable(rng.nullableReal(null_density, 50.0, 68.0));
+            const auto average_hrv = formatNullable(rng.nullableReal(null_density, 20.0, 80.0));
+            const auto heart_rate_items = formatIntervalItems(rng, interval_count, null_density, 45.0, 75.0);
+            const auto hrv_items = formatIntervalItems(rng, interval_count, null_density, 10.0, 120.0);
+            const auto lowest_heart_rate = rng.range(42, 58);
+            const auto movement = rng.digits(static_cast<size_t>(time_in_bed / INTERVAL_30_SEC), '4');
+
+            std::array<int, 8> contributors{};
+            for (auto& contributor : contributors)
+            {
+               contributor = rng.range(1, 100);
+            }
+            const auto readiness_score = rng.range(40, 99);
+            const auto temperature_deviation = formatNullable(rng.nullableReal(null_density, -1.0, 1.0));
+            const auto temperature_trend_deviation = formatNullable(rng.nullableReal(null_density, -0.5, 0.5));
+            const auto restless_periods = rng.range(0, 40);
+            const auto sleep_phases = rng.digits(interval_count, '4');
+
+            string record{};
+            auto out = std::back_inserter(record);
+            fmt::format_to(out, R"({{"id":"{}","average_breath":{},"average_heart_rate":{},"average_hrv":{},"awake_time":{},)",
+                           id,
+                           average_breath,
+                           average_heart_rate,
+                           average_hrv,
+                           awake_time.count());
+            fmt::format_to(out, R"("bedtime_end":"{}","bedtime_start":"{}","day":"{}","deep_sleep_duration":{},"efficiency":{},)",
+                           formatLocal(bedtime_end),
+                           interval_start,
+                           toIsoDate(day),
+                           deep_sleep.count(),
+                           total_sleep.count() * 100 / time_in_bed.count());
+            fmt::format_to(out, R"("heart_rate":{{"interval":300.0,"items":{},"timestamp":"{}"}},)",
+                           heart_rate_items,
+                           interval_start);
+            fmt::format_to(out, R"("hrv":{{"interval":300.0,"items":{},"timestamp":"{}"}},)",
+                           hrv_items,
+                           interval_start);
+            fmt::format_to(out, R"("latency":{},"light_sleep_duration":{},"low_battery_alert":false,"lowest_heart_rate":{},"movement_30_sec":"{}","period":{},)",
+                           latency.count(),
+                           light_sleep.count(),
+                           lowest_heart_rate,
+                           movement,
+                           period);
+            fmt::format_to(out, R"("readiness":{{"contributors":{{"activity_balance":{},"body_temperature":{},"hrv_balance":{},"previous_day_activity":{},)"
+                                R"("previous_night":{},"recovery_index":{},"resting_heart_rate":{},"sleep_balance":{}}},)"
+                                R"("score":{},"temperature_deviation":{},"temperature_trend_deviation":{}}},)",
+                           contributors[0], contributors[1], contributors[2], contributors[3],
+                           contributors[4], contributors[5], contributors[6], contributors[7],
+                           readiness_score,
+                           temperature_deviation,
+                           temperature_trend_deviation);
+            fmt::format_to(out, R"("readiness_score_delta":null,"rem_sleep_duration":{},"restless_periods":{},"sleep_phase_5_min":"{}",)"
+                                R"("sleep_score_delta":null,"sleep_algorithm_version":"v2","time_in_bed":{},"total_sleep_duration":{},"type":"{}"}})",
+                           rem_sleep.count(),
+                           restless_periods,
+                           sleep_phases,
+                           time_in_bed.count(),
+                           total_sleep.count(),
+                           sleep_type);
+
+            records.emplace_back(std::move(record));
+         };
+
+      for (int day_idx = 0; day_idx < m_options.num_days; ++day_idx)
+      {
+         auto night = local_days{ m_options.start_date } + days{ day_idx };
+
+         // the occasional afternoon nap, which comes before that night's sleep.
+         if (rng.chance(0.1))
+         {
+            const minutes nap_start{ rng.range(0, 180) };
+            const minutes nap_length{ rng.range(20, 90) };
+            makeSession(night + 14h + nap_start, nap_length, "late_nap", 1);
+         }
+
+         // bedtime between 9:30pm and 11:30pm local time, 6 to 9.5 hours in bed
+         const minutes bedtime{ rng.range(30, 150) };
+         const minutes time_in_bed{ rng.range(360, 570) };
+         makeSession(night + 21h + bedtime, time_in_bed, "long_sleep", 0);
+      }
+      return records;
+   }
+
+
+   size_t SyntheticDataGenerator::sleepSessionCount() const
+   {
+      // naps are random, so the only reliable way to get the count is to generate the data.
+      return sleepSessionRecords().size();
+   }
+
+
+   size_t SyntheticDataGenerator::dailySleepScoreCount() const noexcept
+   {
+      return static_cast<size_t>(m_options.num_days);
+   }
+
+
+   SyntheticDataGenerator::JsonRecords SyntheticDataGenerator::dailySleepScoreRecords() const
+   {
+      SeededRandom rng{ m_options.seed ^ STREAM_DAILY_SLEEP };
+
+      JsonRecords records{};
+      records.reserve(dailySleepScoreCount());
+
+      for (int day_idx = 0; day_idx < m_options.num_days; ++day_idx)
+      {
+         auto day = local_days{ m_options.start_date } + days{ day_idx };
+         const auto id = rng.uuid();
+         std::array<int, 7> contributors{};
+         for (auto& contributor : contributors)
+         {
+            contributor = rng.range(1, 100);
+         }
+         const auto score = rng.range(40, 99);
+
+         records.emplace_back(fmt::format(R"({{"id":"{}","contributors":{{"deep_sleep":{},"efficiency":{},"latency":{},"rem_sleep":{},)"
+                                          R"("restfulness":{},"timing":{},"total_sleep":{}}},"day":"{}","score":{},"timestamp":"{}"}})",
+                                          id,
+                                          contributors[0], contributors[1], contributors[2], contributors[3],
+                                          contributors[4], contributors[5], contributors[6],
+                                          toIsoDate(year_month_day{ day }),
+                                          score,
+                                          formatLocal(localToSys(day))));
+      }
+      return records;
+   }
+
+
+   SyntheticDataGenerator::JsonPages SyntheticDataGenerator::heartRatePages() const
+   {
+      return paginate(heartRateRecords());
+   }
+
+
+   SyntheticDataGenerator::JsonPages SyntheticDataGenerator::sleepSessionPages() const
+   {
+      return paginate(sleepSessionRecords());
+   }
+
+
+   SyntheticDataGenerator::JsonPages SyntheticDataGenerator::dailySleepScorePages() const
+   {
+      return paginate(dailySleepScoreRecords());
+   }
+
+
+   string SyntheticDataGenerator::personalInfoJson() const
+   {
+      SeededRandom rng{ m_options.seed };
+      const auto id = rng.uuid();
+      const auto age = rng.range(18, 80);
+      const auto weight = rng.real(50.0, 110.0);
+      const auto height = rng.real(1.50, 2.00);
+      const auto sex = rng.chance(0.5) ? "male" : "female";
+      return fmt::format(R"({{"id":"{}","age":{},"weight":{:.1f},"height":{:.2f},"biological_sex":"{}","email":"synthetic@example.com"}})",
+                         id, age, weight, height, sex);
+   }
+
+
+   void SyntheticDataGenerator::populate(TestDataProvider& provider) const
+   {
+      provider.addJsonPages(constants::REST_PATH_HEART_RATE, heartRatePages());
+      provider.addJsonPages(constants::REST_PATH_SLEEP_SESSION, sleepSessionPages());
+      provider.addJsonPages(constants::REST_PATH_DAILY_SLEEP, dailySleepScorePages());
+   }
+
+} // namespace oura_charts::test
+
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
@@ -0,0 +1,121 @@
+//---------------------------------------------------------------------------------------------------------------------
+// SyntheticDataGenerator.h
+//
+// Generates realistic (but fake) paged JSON data for the REST endpoints, so that tests and benchmarks can run at
+// production data volumes without hitting the REST API.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "oura_charts/oura_charts.h"
+#include "oura_charts/chrono_helpers.h"
+#include "TestDataProvider.h"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace oura_charts::test
+{
+   /// <summary>
+   ///   settings used to control the data created by SyntheticDataGenerator.
+   /// </summary>
+   struct SyntheticDataOptions
+   {
+      static inline constexpr uint64_t DEFAULT_SEED = 0x0A7B'5EED;
+
+      // generator output is fully determined by the seed and the other options.
+      uint64_t seed{ DEFAULT_SEED };
+
+      // first calendar date of generated data, and how many days to generate.
+      year_month_day start_date{ chrono::year{ 2022 } / 1 / 1 };
+      int num_days{ 365 };
+
+      // max number of records per JSON page. Pages are linked with next_token values the same
+      // way TestDataProvider::paginateDataSource() does it.
+      size_t page_size{ 1000 };
+
+      // probability (0.0 - 1.0) that any nullable value will be generated as 'null'
+      double null_density{ 0.05 };
+
+      // time zone used for the local time offsets in sleep data. A zone that observes DST means
+      // multi-month ranges will have DST crossings. An empty string means UTC (no DST).
+      std::string time_zone{ "America/Chicago" };
+
+      // how often a heart rate sample is generated.
+      seconds hr_interval{ 300 };
+   };
+
+
+   /// <summary>
+   ///   Deterministic, seeded generator for heart rate, sleep session and daily sleep score JSON in the same format
+   ///   the REST API uses. Generated pages can be loaded directly into a TestDataProvider.
+   /// </summary>
+   /// <remarks>
+   ///   We don't use the std:: distributions since their output isn't specified by the standard, and we want the
+   ///   same seed to produce the same data on every platform.
+   /// </remarks>
+   class SyntheticDataGenerator
+   {
+   public:
+      using JsonPages = std::vector<std::string>;
+      using JsonRecords = std::vector<std::string>;
+
+      explicit SyntheticDataGenerator(SyntheticDataOptions options = {});
+
+      /// <summary>
+      ///   the options this generator was created with.
+      /// </summary>
+      const SyntheticDataOptions& options() const noexcept { return m_options; }
+
+      /// <summary>
+      ///   generate JSON pages for the REST endpoints. Every call with the same options generates the same data.
+      /// </summary>
+      [[nodiscard]] JsonPages heartRatePages() const;
+      [[nodiscard]] JsonPages sleepSessionPages() const;
+      [[nodiscard]] JsonPages dailySleepScorePages() const;
+
+      /// <summary>
+      ///   generate the individual JSON records for the REST endpoints, in timestamp order. This is what the
+      ///   xxxPages() functions paginate, for consumers that need to do their own filtering/paging.
+      /// </summary>
+      [[nodiscard]] JsonRecords heartRateRecords() const;
+      [[nodiscard]] JsonRecords sleepSessionRecords() const;
+      [[nodiscard]] JsonRecords dailySleepScoreRecords() const;
+
+      /// <summary>
+      ///   JSON for the (non-paged) personal_info endpoint.
+      /// </summary>
+      [[nodiscard]] std::string personalInfoJson() const;
+
+      /// <summary>
+      ///   number of records that will be generated for each endpoint with the current options.
+      /// </summary>
+      [[nodiscard]] size_t heartRateCount() const noexcept;
+      [[nodiscard]] size_t sleepSessionCount() const;
+      [[nodiscard]] size_t dailySleepScoreCount() const noexcept;
+
+      /// <summary>
+      ///   generate the data for all endpoints and add it to the provider under the endpoint's REST path.
+      ///   Any existing data for those paths is replaced.
+      /// </summary>
+      void populate(TestDataProvider& provider) const;
+
+   private:
+      SyntheticDataOptions m_options;
+      const chrono::time_zone* m_zone{};
+
+      // splits a list of JSON records into pages, linked by next_token
+      [[nodiscard]] JsonPages paginate(const JsonRecords& records) const;
+
+      // format a timestamp as ISO date/time string with UTC offset for the configured time zone.
+      [[nodiscard]] std::string formatLocal(sys_seconds ts) const;
+
+      [[nodiscard]] sys_seconds localToSys(local_seconds ts) const;
+      [[nodiscard]] local_seconds sysToLocal(sys_seconds ts) const;
+   };
+
+} // namespace oura_charts::test
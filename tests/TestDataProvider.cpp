@@ -60,7 +60,7 @@ namespace oura_charts::test
       }
       else if (overwrite_existing)
       {
-         it->second = json_data;
+         it->second = std::move(json_data);
          return true;
       }
 
@@ -68,6 +68,16 @@ namespace oura_charts::test
    }
 
 
+   void TestDataProvider::addJsonPages(std::string_view path, std::vector<std::string> pages)
+   {
+      for (size_t idx{ 0 }; idx < pages.size(); ++idx)
+      {
+         std::string id_str = (idx == 0) ? "" : std::to_string(idx);
+         addJsonData(std::string{ path }, std::move(pages[idx]), id_str, true);
+      }
+   }
+
+
    // clang-tidy thinks this method shouldn't be noexcept(), but I can't see how it would ever through short of memory allocation failing 
    // NOLINTNEXTLINE(bugprone-exception-escape)
    [[nodiscard]] TestDataProvider::JsonResult TestDataProvider::getJsonData(std::string_view path, std::string_view next_token) const noexcept
@@ -87,6 +97,23 @@ namespace oura_charts::test
    }
 
 
+   // NOLINTNEXTLINE(bugprone-exception-escape)
+   TestDataProvider::StreamResult TestDataProvider::streamJsonData(std::string_view path, std::string_view next_token, const JsonChunkCallback& on_chunk) const noexcept
+   {
+      auto json_res = getJsonData(path, next_token);
+      if (!json_res)
+         return unexpected{ std::move(json_res.error()) };
+
+      std::string_view json{ json_res.value() };
+      for (size_t pos = 0; pos < json.size(); pos += m_stream_chunk_size)
+      {
+         if (!on_chunk(json.substr(pos, m_stream_chunk_size)))
+            return unexpected{ oura_exception{ "TestDataProvider::streamJsonData() cancelled by callback", ErrorCategory::Parse } };
+      }
+      return {};
+   }
+
+
    TestDataProvider::JsonResult TestDataProvider::getJsonFile(const fs::path& file_path)  const noexcept
    {
       try
@@ -15,6 +15,7 @@
 #include <string>
 #include <string_view>
 #include <variant>
+#include <vector>
 
 
 namespace oura_charts::test
@@ -39,6 +40,12 @@ namespace oura_charts::test
       // describing what went wrong in the event of failure.
       using JsonResult = expected<std::string, oura_exception>;
 
+      // type returned by streamJsonData(), which has no value since the JSON goes to the callback.
+      using StreamResult = expected<void, oura_exception>;
+
+      // default size of the chunks streamJsonData() splits the JSON text into.
+      static inline constexpr size_t DEFAULT_STREAM_CHUNK_SIZE = 4096;
+
 
       /// <summary>
       ///   Initialize a provider instance with json sources defined in files from a folder
@@ -91,6 +98,34 @@ namespace oura_charts::test
       }
 
 
+      /// <summary>
+      ///   Retrieve the JSON data associated with the specified path, passing it to on_chunk in pieces
+      ///   of streamChunkSize() bytes to simulate a streaming network transfer. Params are handled the
+      ///   same as getJsonData().
+      /// </summary>
+      template<KeyValueRange MapT>
+      [[nodiscard]] StreamResult streamJsonData(std::string_view path, const MapT& param_map, const JsonChunkCallback& on_chunk) const noexcept
+      {
+         std::string_view next_token{};
+         if (!param_map.empty())
+         {
+            auto it = param_map.find(constants::REST_PARAM_NEXT_TOKEN);
+            if (it == param_map.end())
+               return unexpected{ oura_exception{ "TestDataProvider::streamJsonData() called with invalid param_map, missing next_token", ErrorCategory::Parse } };
+
+            next_token = it->second;
+         }
+         return streamJsonData(path, next_token, on_chunk);
+      }
+
+
+      /// <summary>
+      ///   get/set the chunk size used by streamJsonData()
+      /// </summary>
+      size_t streamChunkSize() const noexcept           { return m_stream_chunk_size; }
+      void setStreamChunkSize(size_t size) noexcept     { m_stream_chunk_size = size ? size : 1; }
+
+
       /// <summary>
       ///   Add  the specified JSON text to the provider using the specified path as
       ///   its key.
@@ -103,6 +138,13 @@ namespace oura_charts::test
       bool addJsonData(std::string path, std::string json_data, std::string_view next_token, bool overwrite_existing = false);
 
 
+      /// <summary>
+      ///   Add a paged data source, replacing any existing data for the path. The pages must be linked with
+      ///   the same next_token values paginateDataSource() uses (page index, with an empty token for the first page).
+      /// </summary>
+      void addJsonPages(std::string_view path, std::vector<std::string> pages);
+
+
       /// <summary>
       ///   turn an existing data source into a paged data source by duplicating it to multiple
       ///   sections. may throw on error.
@@ -114,10 +156,12 @@ namespace oura_charts::test
       using JsonMap = std::map<std::string, JsonEntry, std::less<>>;
 
       JsonMap m_json_map{};
+      size_t m_stream_chunk_size{ DEFAULT_STREAM_CHUNK_SIZE };
 
       void enumerateJsonFromFolder(const fs::path& data_folder);
       [[nodiscard]] JsonResult getJsonData(std::string_view path, std::string_view next_token) const noexcept;
       [[nodiscard]] JsonResult getJsonFile(const fs::path& json_path)  const noexcept;
+      [[nodiscard]] StreamResult streamJsonData(std::string_view path, std::string_view next_token, const JsonChunkCallback& on_chunk) const noexcept;
    };
 
 } // namespace oura_charts::test
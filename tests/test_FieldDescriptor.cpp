@@ -0,0 +1,120 @@
+//---------------------------------------------------------------------------------------------------------------------
+// test_FieldDescriptor.cpp
+//
+// unit tests for field descriptors and the column extraction/aggregation/CSV output that uses them.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+#include "oura_charts/oura_charts.h"
+#include "SyntheticDataGenerator.h"
+#include "TestDataProvider.h"
+#include "oura_charts/DailySleepScore.h"
+#include "oura_charts/FieldDescriptor.h"
+#include "oura_charts/functors.h"
+#include "oura_charts/HeartRate.h"
+#include "oura_charts/SleepSession.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <sstream>
+#include <string>
+
+namespace oura_charts::test
+{
+   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
+
+   using namespace std::literals;
+
+   // the descriptor types are checked at compile time.
+   static_assert(std::same_as<decltype(heartRateBpmField)::ColumnType, int>);
+   static_assert(!decltype(heartRateBpmField)::NULLABLE);
+   static_assert(std::same_as<decltype(sessionAvgHRVField)::ColumnType, nullable_double>);
+   static_assert(std::same_as<decltype(sessionAvgHRVField)::ValueType, double>);
+   static_assert(decltype(sessionAvgHRVField)::NULLABLE);
+   static_assert(fieldCount<HeartRate> == 3);
+   static_assert(fieldNames<DailySleepScore>()[2] == "score");
+   static_assert(DescribedElement<SleepSession>);
+   static_assert(!DescribedElement<std::string>);
+   static_assert(!FieldDescriptorFor<decltype(heartRateBpmField), SleepSession>);
+
+
+   TEST_CASE("test_extractColumn", "[fields]")
+   {
+      SyntheticDataGenerator gen{ SyntheticDataOptions{ .num_days = 7 } };
+      TestDataProvider provider{};
+      gen.populate(provider);
+
+      SECTION("values match the accessor")
+      {
+         auto hr_series = detail::getDataSeries<HeartRate>(provider);
+         auto bpm = extractColumn(hr_series, heartRateBpmField);
+         REQUIRE(bpm.size() == hr_series.size());
+         REQUIRE(rg::equal(bpm, hr_series, {}, {}, &HeartRate::beatsPerMin));
+      }
+
+      SECTION("nullable fields keep their nulls")
+      {
+         auto sessions = detail::getDataSeries<SleepSession>(provider);
+         auto hrv = extractColumn(sessions, sessionAvgHRVField);
+         REQUIRE(hrv.size() == sessions.size());
+         REQUIRE(rg::equal(hrv, sessions, {}, {}, &SleepSession::avgHRV));
+      }
+   }
+
+
+   TEST_CASE("test_aggregateColumn", "[fields]")
+   {
+      SyntheticDataGenerator gen{ SyntheticDataOptions{ .num_days = 7 } };
+      TestDataProvider provider{};
+      gen.populate(provider);
+      auto hr_series = detail::getDataSeries<HeartRate>(provider);
+
+      auto avg = aggregateColumn<AvgCalc<int>>(hr_series, heartRateBpmField);
+      auto max = aggregateColumn<MaxCalc<int>>(hr_series, heartRateBpmField);
+
+      AvgCalc<int> expected_avg{};
+      MaxCalc<int> expected_max{};
+      for (const auto& hr : hr_series)
+      {
+         expected_avg(hr.beatsPerMin());
+         expected_max(hr.beatsPerMin());
+      }
+      REQUIRE(avg.count() == hr_series.size());
+      REQUIRE_THAT(avg.result().value(), Catch::Matchers::WithinAbs(expected_avg.result().value(), 0.0001));
+      REQUIRE(max.result() == expected_max.result());
+
+      // nulls are skipped, same as when calling the functor directly.
+      auto sessions = detail::getDataSeries<SleepSession>(provider);
+      auto hrv = aggregateColumn<AvgCalc<double>>(sessions, sessionAvgHRVField);
+      REQUIRE(hrv.count() == static_cast<size_t>(rg::count_if(sessions, [] (const SleepSession& sess) { return sess.avgHRV().has_value(); })));
+   }
+
+
+   TEST_CASE("test_writeCsv", "[fields]")
+   {
+      constexpr local_days day{ 2024y / 3 / 1 };
+      std::vector<detail::hr_data> hr_structs{ { 55, "rest"s, day + 1h },
+                                               { 61, "awake, \"active\""s, day + 2h + 30min } };
+      HeartRateSeries hr_series{ hr_structs };
+
+      std::ostringstream out{};
+      auto rows = writeCsv(out, hr_series);
+
+      REQUIRE(rows == 2);
+      REQUIRE(out.str() == "timestamp,bpm,source\n"
+                           "2024-03-01T01:00:00,55,rest\n"
+                           "2024-03-01T02:30:00,61,\"awake, \"\"active\"\"\"\n");
+
+      SECTION("nulls are empty")
+      {
+         std::string row{};
+         detail::appendCsvValue(row, nullable_double{});
+         detail::appendCsvValue(row, ","sv);
+         detail::appendCsvValue(row, nullable_uint{ 7 });
+         detail::appendCsvValue(row, chrono::seconds{ 90min });
+         REQUIRE(row == "\",\"75400");
+      }
+   }
+
+   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
+
+} // namespace oura_charts::test
@@ -0,0 +1,194 @@
+//---------------------------------------------------------------------------------------------------------------------
+// test_FileDataProvider.cpp
+//
+// unit tests for FileDataProvider, using synthetic data written to a temp folder in the export layout.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+#include "oura_charts/oura_charts.h"
+#include "MockOuraServer.h"
+#include "oura_charts/DailySleepScore.h"
+#include "oura_charts/FileDataProvider.h"
+#include "oura_charts/HeartRate.h"
+#include "oura_charts/RestDataProvider.h"
+#include "oura_charts/SleepSession.h"
+#include "oura_charts/TokenAuth.h"
+#include "oura_charts/UserProfile.h"
+#include <catch2/catch_test_macros.hpp>
+#include <fstream>
+
+namespace oura_charts::test
+{
+   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
+
+   using namespace std::literals;
+
+   namespace
+   {
+      constexpr auto MOCK_TOKEN = "mock_token"sv;
+
+      SyntheticDataGenerator mockGenerator()
+      {
+         return SyntheticDataGenerator{ SyntheticDataOptions{ .num_days = 30, .time_zone = "" } };
+      }
+
+      void writeFile(const fs::path& file_path, std::string_view json)
+      {
+         std::ofstream file{ file_path, std::ios::binary | std::ios::trunc };
+         file.write(json.data(), static_cast<std::streamsize>(json.size()));
+      }
+
+      std::string collectionJson(const SyntheticDataGenerator::JsonRecords& records)
+      {
+         return fmt::format("{{\"data\":[\n{}\n]}}", fmt::join(records, ",\n"));
+      }
+
+      // writes the generator's data to a fresh temp folder, one file per endpoint.
+      fs::path writeExport(const SyntheticDataGenerator& generator, std::string_view folder_name)
+      {
+         auto folder = fs::temp_directory_path() / folder_name;
+         fs::remove_all(folder);
+         fs::create_directories(folder);
+
+         writeFile(folder / "heartrate.json", collectionJson(generator.heartRateRecords()));
+         writeFile(folder / "sleep.json", collectionJson(generator.sleepSessionRecords()));
+         writeFile(folder / "daily_sleep.json", collectionJson(generator.dailySleepScoreRecords()));
+         writeFile(folder / "personal_info.json", generator.personalInfoJson());
+         return folder;
+      }
+
+      // number of pages getDataSeries() would request.
+      size_t countPages(const FileDataProvider& provider, std::string_view path, detail::SortedPropertyMap params)
+      {
+         size_t pages{};
+         while (true)
+         {
+            auto json_res = provider.getJsonData(path, detail::SortedPropertyMap{ params });
+            REQUIRE(json_res.has_value());
+            ++pages;
+
+            auto token_res = detail::readNextToken(json_res.value());
+            REQUIRE(token_res.has_value());
+            if (!token_res.value())
+               return pages;
+
+            params[constants::REST_PARAM_NEXT_TOKEN] = *token_res.value();
+         }
+      }
+   }
+
+
+   TEST_CASE("test_FileDataProvider_matches_rest", "[file_provider][mock_server]")
+   {
+      auto generator = mockGenerator();
+      FileDataProvider provider{ writeExport(generator, "oura_charts_test_export"), FileDataProviderOptions{ .page_bytes = 16 * 1024 } };
+      MockOuraServer server{ generator, MockServerOptions{ .page_size = 100, .token = std::string{ MOCK_TOKEN } } };
+      RestDataProvider rest{ TokenAuth{ MOCK_TOKEN }, server.baseUrl() };
+
+      REQUIRE(provider.paths() == std::vector<std::string>{ "daily_sleep", "heartrate", "personal_info", "sleep" });
+      REQUIRE(provider.recordCount(constants::REST_PATH_HEART_RATE) == generator.heartRateCount());
+      REQUIRE(provider.recordCount(constants::REST_PATH_SLEEP_SESSION) == generator.sleepSessionCount());
+      REQUIRE(provider.recordCount(constants::REST_PATH_PERSONAL_INFO) == 0);
+
+      const year_month_day from{ chrono::year{ 2022 } / 1 / 5 };
+      const year_month_day thru{ chrono::year{ 2022 } / 1 / 14 };
+
+      // same date filtering as the REST API
+      auto scores = getDataSeries<DailySleepScore>(provider, from, thru);
+      REQUIRE(scores.size() == 10);
+      REQUIRE(rg::equal(scores, getDataSeries<DailySleepScore>(rest, from, thru), {}, &DailySleepScore::id, &DailySleepScore::id));
+
+      auto sessions = getDataSeries<SleepSession>(provider, from, thru);
+      REQUIRE(sessions.size() >= 10);
+      REQUIRE(rg::equal(sessions, getDataSeries<SleepSession>(rest, from, thru), {}, &SleepSession::id, &SleepSession::id));
+
+      auto heart_rates = getDataSeries<HeartRate>(provider, from, thru);
+      REQUIRE(heart_rates.size() == 10 * 288);
+      REQUIRE(rg::equal(heart_rates, getDataSeries<HeartRate>(rest, from, thru), {}, &HeartRate::timestamp, &HeartRate::timestamp));
+
+      // without params everything is returned
+      REQUIRE(detail::getDataSeries<HeartRate>(provider, detail::SortedPropertyMap{}).size() == generator.heartRateCount());
+
+      // single-object endpoints are served as-is
+      REQUIRE(getUserProfile(provider).email() == "synthetic@example.com");
+
+      SECTION("streaming")
+      {
+         DataSeries<HeartRate> streamed{};
+         auto count = streamDataSeries<HeartRate>(provider, from, thru, appendTo(streamed));
+         REQUIRE(count == heart_rates.size());
+         REQUIRE(rg::equal(streamed, heart_rates, {}, &HeartRate::timestamp, &HeartRate::timestamp));
+      }
+
+      SECTION("copies share the index")
+      {
+         auto copy = provider;
+         REQUIRE(copy.recordCount(constants::REST_PATH_HEART_RATE) == generator.heartRateCount());
+         REQUIRE(getDataSeries<DailySleepScore>(copy, from, thru).size() == 10);
+      }
+   }
+
+
+   TEST_CASE("test_FileDataProvider_paging", "[file_provider]")
+   {
+      auto generator = mockGenerator();
+      auto folder = writeExport(generator, "oura_charts_test_export_paging");
+
+      const year_month_day from{ chrono::year{ 2022 } / 1 / 5 };
+      const year_month_day thru{ chrono::year{ 2022 } / 1 / 7 };
+      auto params = detail::dateRangeParams<DailySleepScore>(from, thru);
+
+      SECTION("pages are split by size")
+      {
+         // a page always has at least one record, so this gives one record per page.
+         FileDataProvider one_per_page{ folder, FileDataProviderOptions{ .page_bytes = 1 } };
+         REQUIRE(countPages(one_per_page, constants::REST_PATH_DAILY_SLEEP, params) == 3);
+         REQUIRE(getDataSeries<DailySleepScore>(one_per_page, from, thru).size() == 3);
+
+         // 30 days of heart rate is over half a MB, so it's split into several pages that are parsed in parallel.
+         FileDataProvider provider{ folder, FileDataProviderOptions{ .page_bytes = 64 * 1024 } };
+         auto pages = countPages(provider, constants::REST_PATH_HEART_RATE, {});
+         REQUIRE(pages > 1);
+         REQUIRE(pages < 20);
+         REQUIRE(countPages(provider, constants::REST_PATH_DAILY_SLEEP, params) == 1);
+      }
+
+      SECTION("records don't have to be in order")
+      {
+         auto records = generator.dailySleepScoreRecords();
+         rg::reverse(records);
+         writeFile(folder / "daily_sleep.json", collectionJson(records));
+
+         FileDataProvider provider{ folder };
+         auto scores = getDataSeries<DailySleepScore>(provider, from, thru);
+         REQUIRE(scores.size() == 3);
+         REQUIRE(scores.front().date() == from);
+         REQUIRE(scores.back().date() == thru);
+      }
+   }
+
+
+   TEST_CASE("test_FileDataProvider_errors", "[file_provider]")
+   {
+      REQUIRE_THROWS_AS(FileDataProvider{ fs::temp_directory_path() / "oura_charts_no_such_folder" }, oura_exception);
+
+      auto folder = writeExport(mockGenerator(), "oura_charts_test_export_errors");
+      writeFile(folder / "broken.json", R"({"data":[{"day":"2022-01-01"})");
+      FileDataProvider provider{ folder };
+
+      REQUIRE_FALSE(provider.getJsonData("no_such_path").has_value());
+      REQUIRE_FALSE(provider.recordCount("broken").has_value());
+
+      auto json_res = provider.getJsonData("broken");
+      REQUIRE_FALSE(json_res.has_value());
+      REQUIRE(json_res.error().category == ErrorCategory::Parse);
+
+      using detail::SortedPropertyMap;
+      REQUIRE_FALSE(provider.getJsonData(constants::REST_PATH_DAILY_SLEEP, SortedPropertyMap{ { constants::REST_PARAM_NEXT_TOKEN, "abc" } }).has_value());
+      REQUIRE_FALSE(provider.getJsonData(constants::REST_PATH_DAILY_SLEEP, SortedPropertyMap{ { constants::REST_PARAM_NEXT_TOKEN, "100000" } }).has_value());
+      REQUIRE_FALSE(provider.getJsonData(constants::REST_PATH_DAILY_SLEEP, SortedPropertyMap{ { constants::REST_PARAM_START_DATE, "yesterday" } }).has_value());
+   }
+
+   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
+
+} // namespace oura_charts::test
@@ -0,0 +1,153 @@
+//---------------------------------------------------------------------------------------------------------------------
+// test_GroupedAggregator.cpp
+//
+// unit tests for GroupedAggregator, which calculates grouped statistics directly from streamed data.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+#include "oura_charts/oura_charts.h"
+#include "SyntheticDataGenerator.h"
+#include "TestDataProvider.h"
+#include "oura_charts/DailySleepScore.h"
+#include "oura_charts/functors.h"
+#include "oura_charts/GroupedAggregator.h"
+#include "oura_charts/HeartRate.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+namespace oura_charts::test
+{
+   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
+
+   using namespace std::literals;
+
+
+   TEST_CASE("test_GroupedAggregator_matches_groupBy", "[aggregate]")
+   {
+      SyntheticDataGenerator gen{ SyntheticDataOptions{ .num_days = 60, .page_size = 10 } };
+      TestDataProvider provider{};
+      gen.populate(provider);
+
+      auto avg_by_weekday = aggregateBy<DailySleepScore, AvgCalc<int>>(sleepScoreWeekday, &DailySleepScore::score);
+      auto count = detail::streamDataSeries<DailySleepScore>(provider, detail::SortedPropertyMap{}, avg_by_weekday);
+      REQUIRE(count == gen.dailySleepScoreCount());
+      REQUIRE(avg_by_weekday.recordCount() == count);
+      REQUIRE(avg_by_weekday.groups().size() == 7);
+
+      // same results as grouping the whole series and then calculating each group.
+      auto score_by_weekday = group<SleepScoreByWeekday>(detail::getDataSeries<DailySleepScore>(provider, detail::SortedPropertyMap{}), sleepScoreWeekday);
+      for (auto wd : getWeekdays())
+      {
+         AvgCalc<int> calc{};
+         auto [beg, end] = score_by_weekday.equal_range(wd);
+         rg::for_each(rg::subrange{ beg, end } | vw::values, [&calc] (const DailySleepScore& score) { calc(score.score()); });
+
+         REQUIRE(avg_by_weekday.result(wd).has_value());
+         REQUIRE(avg_by_weekday.result(wd) == calc.result());
+         REQUIRE(avg_by_weekday.groups().at(wd).count() == calc.count());
+      }
+   }
+
+
+   TEST_CASE("test_GroupedAggregator_min_max", "[aggregate]")
+   {
+      SyntheticDataGenerator gen{ SyntheticDataOptions{ .num_days = 45, .page_size = 1000 } };
+      TestDataProvider provider{};
+      gen.populate(provider);
+
+      auto min_by_month = aggregateBy<HeartRate, MinCalc<int>>(heartRateMonth, &HeartRate::beatsPerMin);
+      auto max_by_month = aggregateBy<HeartRate, MaxCalc<int>>(heartRateMonth, &HeartRate::beatsPerMin);
+      detail::streamDataSeries<HeartRate>(provider, detail::SortedPropertyMap{},
+                                          [&] (const HeartRate& hr)
+                                          {
+                                             min_by_month(hr);
+                                             max_by_month(hr);
+                                          });
+
+      auto hr_series = detail::getDataSeries<HeartRate>(provider, detail::SortedPropertyMap{});
+      for (const auto& [mon, min_calc] : min_by_month.groups())
+      {
+         auto in_month = hr_series | vw::filter([mon] (const HeartRate& hr) { return heartRateMonth(hr) == mon; })
+                                   | vw::transform(&HeartRate::beatsPerMin);
+
+         REQUIRE(min_calc.result() == rg::min(in_month));
+         REQUIRE(max_by_month.result(mon) == rg::max(in_month));
+      }
+
+      // a group with no data has a null result
+      REQUIRE_FALSE(min_by_month.result(chrono::June).has_value());
+   }
+
+   TEST_CASE("test_aggregateSeries_matches_aggregateBy", "[aggregate][pool]")
+   {
+      // enough heart rate samples that the series is split into several chunks
+      SyntheticDataGenerator gen{ SyntheticDataOptions{ .num_days = 120 } };
+      TestDataProvider provider{};
+      gen.populate(provider);
+      auto hr_series = detail::getDataSeries<HeartRate>(provider, detail::SortedPropertyMap{});
+      REQUIRE(hr_series.size() >= 4 * constants::AGGREGATE_MIN_CHUNK_SIZE);
+
+      auto avg_by_month = aggregateBy<HeartRate, AvgCalc<int>>(heartRateMonth, &HeartRate::beatsPerMin);
+      auto max_by_month = aggregateBy<HeartRate, MaxCalc<int>>(heartRateMonth, &HeartRate::beatsPerMin);
+      for (const auto& hr : hr_series)
+      {
+         avg_by_month(hr);
+         max_by_month(hr);
+      }
+
+      ThreadPool pool{ 4 };
+      auto parallel_avg = aggregateSeries<AvgCalc<int>>(hr_series, heartRateMonth, &HeartRate::beatsPerMin, pool);
+      auto parallel_max = aggregateSeries<MaxCalc<int>>(hr_series, heartRateMonth, &HeartRate::beatsPerMin, pool);
+
+      REQUIRE(parallel_avg.recordCount() == hr_series.size());
+      REQUIRE(parallel_avg.groups().size() == avg_by_month.groups().size());
+      for (const auto& [mon, calc] : avg_by_month.groups())
+      {
+         REQUIRE(parallel_avg.groups().at(mon).count() == calc.count());
+         REQUIRE_THAT(parallel_avg.result(mon).value(), Catch::Matchers::WithinAbs(calc.result().value(), 0.0001));
+         REQUIRE(parallel_max.result(mon) == max_by_month.result(mon));
+      }
+
+      SECTION("small series are aggregated on the calling thread")
+      {
+         auto first_week = hr_series.range(hr_series.front().timestamp(), hr_series.front().timestamp() + days{ 7 });
+         auto small = aggregateSeries<MinCalc<int>>(first_week, heartRateWeekday, &HeartRate::beatsPerMin, pool);
+         REQUIRE(small.recordCount() == rg::size(first_week));
+         REQUIRE(small.groups().size() == 7);
+      }
+   }
+
+
+   TEST_CASE("test_GroupedAggregator_merge", "[aggregate]")
+   {
+      SyntheticDataGenerator gen{ SyntheticDataOptions{ .num_days = 30, .page_size = 1000 } };
+      TestDataProvider provider{};
+      gen.populate(provider);
+      auto scores = detail::getDataSeries<DailySleepScore>(provider, detail::SortedPropertyMap{});
+
+      auto all = aggregateBy<DailySleepScore, SumCalc<int>>(sleepScoreWeekday, &DailySleepScore::score);
+      auto first_half = aggregateBy<DailySleepScore, SumCalc<int>>(sleepScoreWeekday, &DailySleepScore::score);
+      auto second_half = aggregateBy<DailySleepScore, SumCalc<int>>(sleepScoreWeekday, &DailySleepScore::score);
+      for (size_t idx = 0; idx < scores.size(); ++idx)
+      {
+         all(scores[idx]);
+         if (idx < 3)
+            first_half(scores[idx]);
+         else
+            second_half(scores[idx]);
+      }
+
+      // first_half only has some of the groups, so the merge both combines and adds groups.
+      REQUIRE(first_half.groups().size() < 7);
+      first_half.merge(std::move(second_half));
+      REQUIRE(first_half.recordCount() == all.recordCount());
+      REQUIRE(second_half.recordCount() == 0);
+      for (auto wd : getWeekdays())
+      {
+         REQUIRE(first_half.result(wd) == all.result(wd));
+      }
+   }
+
+   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
+
+} // namespace oura_charts::test
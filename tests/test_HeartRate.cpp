@@ -6,6 +6,8 @@
 // Copyright (c) 2024 Jeff Kohn. All Right Reserved.
 //---------------------------------------------------------------------------------------------------------------------
 #include "oura_charts/oura_charts.h"
+#include "CountingResource.h"
+#include "SyntheticDataGenerator.h"
 #include "TestDataProvider.h"
 #include "oura_charts/HeartRate.h"
 #include "oura_charts/detail/json_structs.h"
@@ -70,6 +72,74 @@ namespace oura_charts::test
    }
 
 
+   TEST_CASE("test_HeartRateSeries_memory_resource", "[parsing][pmr]")
+   {
+      TestDataProvider provider{ constants::UNIT_TEST_DATA_DIR };
+      REQUIRE_NOTHROW(provider.paginateDataSource(constants::REST_PATH_HEART_RATE, 3));
+      HeartRateSeries expected{ detail::getDataSeries<HeartRate>(provider, detail::SortedPropertyMap{}) };
+
+      SECTION("series and page buffers allocate from the resource")
+      {
+         CountingResource counter{};
+         {
+            auto series = detail::getDataSeries<HeartRate>(provider, detail::SortedPropertyMap{}, &counter);
+            REQUIRE(series.get_allocator().resource() == &counter);
+            REQUIRE(rg::equal(series, expected, {}, &HeartRate::timestamp, &HeartRate::timestamp));
+            REQUIRE(counter.allocationCount() > 0);
+         }
+         REQUIRE(counter.outstandingCount() == 0);
+      }
+
+      SECTION("monotonic arena only allocates a few blocks")
+      {
+         // 20 days of 5-minute readings in 20 pages. The arena's blocks grow geometrically, so the number of
+         // upstream allocations only grows with the log of the total size, not with the number of records.
+         SyntheticDataGenerator gen{ SyntheticDataOptions{ .num_days = 20, .page_size = 288 } };
+         TestDataProvider synthetic{};
+         gen.populate(synthetic);
+
+         CountingResource upstream{};
+         std::pmr::monotonic_buffer_resource arena{ &upstream };
+         auto series = detail::getDataSeries<HeartRate>(synthetic, detail::SortedPropertyMap{}, &arena);
+         REQUIRE(series.size() == gen.heartRateCount());
+         REQUIRE(upstream.allocationCount() > 0);
+         REQUIRE(upstream.allocationCount() <= 32);
+      }
+   }
+
+
+   TEST_CASE("test_HeartRateSeries_parallel_pages", "[parsing][pool]")
+   {
+      SyntheticDataGenerator gen{ SyntheticDataOptions{ .num_days = 20, .page_size = 100 } };
+      TestDataProvider provider{};
+      gen.populate(provider);
+
+      // the memory resource overload parses one page at a time, so compare against that.
+      std::pmr::unsynchronized_pool_resource resource{};
+      auto expected = detail::getDataSeries<HeartRate>(provider, detail::SortedPropertyMap{}, &resource);
+      REQUIRE(expected.size() == gen.heartRateCount());
+
+      auto same_elements = [&expected] (const HeartRateSeries& series)
+                           {
+                              return rg::equal(series, expected, {}, &HeartRate::timestamp, &HeartRate::timestamp)
+                                     and rg::equal(series, expected, {}, &HeartRate::beatsPerMin, &HeartRate::beatsPerMin);
+                           };
+
+      ThreadPool pool{ 4 };
+      REQUIRE(same_elements(detail::getDataSeries<HeartRate>(provider, detail::SortedPropertyMap{}, pool)));
+
+      ThreadPool single_thread{ 1 };
+      REQUIRE(same_elements(detail::getDataSeries<HeartRate>(provider, detail::SortedPropertyMap{}, single_thread)));
+
+      // a page that can't be parsed fails the whole fetch, even though it's parsed on another thread.
+      auto pages = gen.heartRatePages();
+      const auto bad_idx = pages.size() / 2;
+      pages[bad_idx] = fmt::format(R"({{"data":[{{"bpm":"fast"}}],"next_token":"{}"}})", bad_idx + 1);
+      provider.addJsonPages(constants::REST_PATH_HEART_RATE, std::move(pages));
+      REQUIRE_THROWS_AS(detail::getDataSeries<HeartRate>(provider, detail::SortedPropertyMap{}, pool), oura_exception);
+   }
+
+
    // generate range containing the specified bpm values for the first 28 days
    // of each month.
    auto generateHeartRateSeries(rg::input_range auto&& bpm_values, int num_days = 7)
@@ -190,6 +260,80 @@ namespace oura_charts::test
       }
    }
 
+   // one reading every 5 minutes for a day, starting at midnight
+   std::vector<hr_data> generateDayOfHeartRates(local_days day, int bpm)
+   {
+      std::vector<hr_data> hr_structs{};
+      for (auto ts = local_seconds{ day }; ts < day + days{ 1 }; ts += minutes{ 5 })
+      {
+         hr_structs.emplace_back(hr_data{ bpm, "test"s, ts });
+      }
+      return hr_structs;
+   }
+
+
+   TEST_CASE("test_HeartRateSeries_time_queries", "[series]")
+   {
+      constexpr local_days day{ 2024y / 3 / 1 };
+      auto hr_structs = generateDayOfHeartRates(day, 60);
+      rg::reverse(hr_structs);
+
+      // the series is put in timestamp order when it's constructed
+      HeartRateSeries hr_series{ hr_structs };
+      REQUIRE(hr_series.isOrdered());
+      REQUIRE(hr_series.front().timestamp() == day);
+
+      SECTION("range")
+      {
+         auto two_to_four = hr_series.range(day + 2h, day + 4h);
+         REQUIRE(rg::distance(two_to_four) == 24);
+         REQUIRE(two_to_four.front().timestamp() == day + 2h);
+         REQUIRE(two_to_four.back().timestamp() == day + 4h - 5min);
+
+         REQUIRE(hr_series.range(day - 2h, day - 1h).empty());
+         REQUIRE(hr_series.range(day + 4h, day + 2h).empty());
+         REQUIRE(rg::distance(hr_series.range(day - 1h, day + days{ 2 })) == ssize(hr_series));
+      }
+
+      SECTION("atOrBefore")
+      {
+         REQUIRE(hr_series.atOrBefore(day + 2h)->timestamp() == day + 2h);
+         REQUIRE(hr_series.atOrBefore(day + 2h + 3min)->timestamp() == day + 2h);
+         REQUIRE(hr_series.atOrBefore(day + days{ 5 })->timestamp() == hr_series.back().timestamp());
+         REQUIRE(hr_series.atOrBefore(day - 1s) == hr_series.cend());
+      }
+   }
+
+
+   TEST_CASE("test_HeartRateSeries_merge", "[series]")
+   {
+      constexpr local_days day{ 2024y / 3 / 1 };
+      auto first_fetch = generateDayOfHeartRates(day, 60);
+      auto second_fetch = generateDayOfHeartRates(day, 70);
+
+      // overlapping fetches: 00:00 - 16:00 and 08:00 - 24:00
+      HeartRateSeries merged{ vw::take(first_fetch, 192) | rg::to<std::vector>() };
+      HeartRateSeries later{ vw::drop(second_fetch, 96) | rg::to<std::vector>() };
+      merged.merge(later);
+
+      REQUIRE(merged.size() == 288);
+      REQUIRE(merged.isOrdered());
+      REQUIRE(rg::adjacent_find(merged, {}, &HeartRate::timestamp) == merged.end());
+
+      // duplicates come from the more recent fetch
+      REQUIRE(merged.atOrBefore(day + 7h)->beatsPerMin() == 60);
+      REQUIRE(merged.atOrBefore(day + 8h)->beatsPerMin() == 70);
+      REQUIRE(merged.atOrBefore(day + 15h)->beatsPerMin() == 70);
+
+      SECTION("custom key keeps records with the same timestamp")
+      {
+         // only the readings with the same bpm (before 8:00) are duplicates now.
+         HeartRateSeries other{ first_fetch };
+         merged.merge(std::move(other), &HeartRate::beatsPerMin);
+         REQUIRE(merged.size() == 288 + 192);
+      }
+   }
+
    // NOLINTEND(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
 
 
@@ -0,0 +1,127 @@
+//---------------------------------------------------------------------------------------------------------------------
+// test_HeartRateFollower.cpp
+//
+// unit tests for HeartRateFollower, using a local mock of the REST API.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+#include "oura_charts/oura_charts.h"
+#include "MockOuraServer.h"
+#include "oura_charts/HeartRateFollower.h"
+#include "oura_charts/RestDataProvider.h"
+#include "oura_charts/TokenAuth.h"
+#include <catch2/catch_test_macros.hpp>
+#include <stop_token>
+#include <thread>
+
+namespace oura_charts::test
+{
+   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
+
+   using namespace std::literals;
+
+   namespace
+   {
+      constexpr auto MOCK_TOKEN = "mock_token"sv;
+
+      SyntheticDataGenerator mockGenerator()
+      {
+         return SyntheticDataGenerator{ SyntheticDataOptions{ .num_days = 30, .time_zone = "" } };
+      }
+
+      MockServerOptions mockOptions(size_t page_size)
+      {
+         return MockServerOptions{ .page_size = page_size, .token = std::string{ MOCK_TOKEN } };
+      }
+   }
+
+
+   TEST_CASE("test_HeartRateFollower_poll", "[rest][mock_server][hr_follow]")
+   {
+      // samples every 5 minutes, 10 per page.
+      MockOuraServer server{ mockGenerator(), mockOptions(10) };
+      RestDataProvider provider{ TokenAuth{ MOCK_TOKEN }, server.baseUrl() };
+
+      const auto midnight = local_seconds{ local_days{ chrono::year{ 2022 } / 1 / 3 } };
+      HeartRateFollower follower{ provider, midnight };
+      REQUIRE_FALSE(follower.lastTimestamp().has_value());
+      REQUIRE_FALSE(follower.minBpm().has_value());
+
+      // first poll gets everything since midnight
+      REQUIRE(follower.poll(midnight + 6h) == 72);
+      REQUIRE(server.requestCount() == 8);
+      REQUIRE(follower.lastTimestamp() == midnight + 6h - 5min);
+
+      // later polls only ask for what's new, so the cost doesn't grow with the time since midnight.
+      server.resetCounts();
+      REQUIRE(follower.poll(midnight + 1h) == 0);
+      REQUIRE(server.requestCount() == 0);
+      REQUIRE(follower.poll(midnight + 6h) == 0);
+      REQUIRE(server.requestCount() == 1);
+      REQUIRE(follower.poll(midnight + 6h + 30min) == 6);
+      REQUIRE(server.requestCount() == 2);
+      REQUIRE(follower.poll(midnight + 9h) == 30);
+      REQUIRE(server.requestCount() == 5);
+
+      // same samples as fetching the whole range at once.
+      const auto& series = follower.series();
+      auto full = getDataSeries<HeartRate>(provider, midnight, midnight + 9h);
+      REQUIRE(series.size() == 108);
+      REQUIRE(series.isOrdered());
+      REQUIRE(rg::equal(series, full, {}, &HeartRate::timestamp, &HeartRate::timestamp));
+      REQUIRE(rg::adjacent_find(series, {}, &HeartRate::timestamp) == series.end());
+
+      // statistics updated incrementally match the ones calculated from the whole series.
+      auto hourly = aggregateSeries<AvgCalc<int>>(full, heartRateHour, &HeartRate::beatsPerMin);
+      REQUIRE(follower.hourlyAverages().groups().size() == 9);
+      REQUIRE(follower.hourlyAverages().recordCount() == full.size());
+      for (const auto& [hour, calc] : hourly.groups())
+      {
+         REQUIRE(follower.hourlyAverages().result(hour) == calc.result());
+      }
+
+      auto [min_it, max_it] = rg::minmax_element(full, {}, &HeartRate::beatsPerMin);
+      REQUIRE(follower.minBpm() == min_it->beatsPerMin());
+      REQUIRE(follower.maxBpm() == max_it->beatsPerMin());
+   }
+
+
+   TEST_CASE("test_HeartRateFollower_follow", "[rest][mock_server][hr_follow]")
+   {
+      MockOuraServer server{ mockGenerator(), mockOptions(0) };
+      RestDataProvider provider{ TokenAuth{ MOCK_TOKEN }, server.baseUrl() };
+
+      // last day of generated data, so polling up to the current time returns one day's samples and then nothing.
+      const auto start = local_seconds{ local_days{ chrono::year{ 2022 } / 1 / 30 } };
+      HeartRateFollower follower{ provider, start, HeartRateFollowOptions{ .poll_interval = 10ms } };
+
+      std::stop_source stop{};
+      size_t updates{};
+      size_t samples{};
+      follower.follow(stop.get_token(), [&] (const auto& f, size_t added)
+                                        {
+                                           ++updates;
+                                           samples += added;
+                                           if (f.series().size() == 288)
+                                              stop.request_stop();
+                                        });
+      REQUIRE(updates == 1);
+      REQUIRE(samples == 288);
+      REQUIRE(server.requestCount() == 1);
+
+      SECTION("errors don't stop the follower")
+      {
+         HeartRateFollower bad_token{ RestDataProvider{ TokenAuth{ "bad_token"sv }, server.baseUrl() }, start,
+                                      HeartRateFollowOptions{ .poll_interval = 10ms } };
+         REQUIRE_THROWS_AS(bad_token.poll(), oura_exception);
+
+         std::stop_source timeout{};
+         std::jthread stopper{ [&timeout] { std::this_thread::sleep_for(50ms); timeout.request_stop(); } };
+         bad_token.follow(timeout.get_token(), [] (const auto&, size_t) {});
+         REQUIRE(bad_token.series().empty());
+      }
+   }
+
+   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
+
+} // namespace oura_charts::test
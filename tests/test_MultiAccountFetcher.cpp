@@ -0,0 +1,142 @@
+//---------------------------------------------------------------------------------------------------------------------
+// test_MultiAccountFetcher.cpp
+//
+// unit tests for MultiAccountFetcher
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+#include "oura_charts/oura_charts.h"
+#include "MockOuraServer.h"
+#include "SyntheticDataGenerator.h"
+#include "TestDataProvider.h"
+#include "oura_charts/DailySleepScore.h"
+#include "oura_charts/HeartRate.h"
+#include "oura_charts/MultiAccountFetcher.h"
+#include <catch2/catch_test_macros.hpp>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace oura_charts::test
+{
+   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
+
+   using namespace std::literals;
+
+   namespace
+   {
+      // a provider with its own synthetic data, so each account gets different results.
+      TestDataProvider accountProvider(uint64_t seed)
+      {
+         SyntheticDataGenerator gen{ SyntheticDataOptions{ .seed = seed, .num_days = 10, .page_size = 50 } };
+         TestDataProvider provider{};
+         gen.populate(provider);
+         return provider;
+      }
+   }
+
+
+   TEST_CASE("test_MultiAccountFetcher_results", "[multi_fetch]")
+   {
+      ThreadPool pool{ 2 };
+      MultiAccountFetcher<TestDataProvider> fetcher{ MultiFetchOptions{ .max_connections = 3 }, pool };
+
+      std::map<std::string, DailySleepScoreSeries> expected{};
+      for (uint64_t seed = 1; seed <= 5; ++seed)
+      {
+         auto provider = accountProvider(seed);
+         auto id = fmt::format("user_{}", seed);
+         expected[id] = detail::getDataSeries<DailySleepScore>(provider, detail::SortedPropertyMap{}, pool);
+         fetcher.addAccount(std::move(id), std::move(provider));
+      }
+      REQUIRE(fetcher.accountCount() == 5);
+
+      SECTION("each account gets its own series")
+      {
+         // the sink is called from the fetcher's threads, so check the results afterwards.
+         std::map<std::string, AccountSeriesResult<DailySleepScore>> results{};
+         auto summary = fetcher.fetch<DailySleepScore>(detail::SortedPropertyMap{}, [&results] (std::string_view id, AccountSeriesResult<DailySleepScore>&& res)
+                                                       {
+                                                          results.emplace(id, std::move(res));
+                                                       });
+         REQUIRE(summary.accounts == 5);
+         REQUIRE(summary.failed_accounts == 0);
+         REQUIRE(results.size() == expected.size());
+         for (const auto& [id, series] : expected)
+         {
+            const auto& res = results.at(id);
+            REQUIRE(res.has_value());
+            REQUIRE(rg::equal(*res, series, {}, &DailySleepScore::date, &DailySleepScore::date));
+            REQUIRE(rg::equal(*res, series, {}, &DailySleepScore::score, &DailySleepScore::score));
+         }
+      }
+
+      SECTION("a failed account doesn't stop the others")
+      {
+         fetcher.addAccount("no_data", TestDataProvider{});
+
+         std::vector<std::string> succeeded{};
+         std::vector<std::string> failed{};
+         auto summary = fetcher.fetch<DailySleepScore>(detail::SortedPropertyMap{}, [&] (std::string_view id, AccountSeriesResult<DailySleepScore>&& res)
+                                                       {
+                                                          (res ? succeeded : failed).emplace_back(id);
+                                                       });
+         REQUIRE(summary.accounts == 6);
+         REQUIRE(summary.failed_accounts == 1);
+         REQUIRE(succeeded.size() == 5);
+         REQUIRE(failed == std::vector<std::string>{ "no_data" });
+      }
+
+      SECTION("exceptions from the sink are rethrown")
+      {
+         size_t calls{};
+         auto bad_sink = [&calls] (std::string_view, AccountSeriesResult<DailySleepScore>&&)
+                         {
+                            ++calls;
+                            throw std::runtime_error{ "test" };
+                         };
+         REQUIRE_THROWS_AS(fetcher.fetch<DailySleepScore>(detail::SortedPropertyMap{}, bad_sink), std::runtime_error);
+         REQUIRE(calls == 5);
+      }
+   }
+
+
+   TEST_CASE("test_MultiAccountFetcher_rate_limits", "[multi_fetch][mock_server]")
+   {
+      SyntheticDataGenerator gen{ SyntheticDataOptions{ .num_days = 10, .time_zone = "" } };
+      MockOuraServer server{ gen, MockServerOptions{ .page_size = 100 } };
+
+      const year_month_day from{ chrono::year{ 2022 } / 1 / 3 };
+      const year_month_day thru{ chrono::year{ 2022 } / 1 / 4 };
+
+      // one account is only allowed a few requests a second, the others are unrestricted. With a single
+      // connection, the slow account must not hold up the others while it waits for its budget.
+      RestAccountFetcher fetcher{ MultiFetchOptions{ .max_connections = 1 } };
+      auto slow_scheduler = std::make_shared<RequestScheduler>(RateLimit{ .requests_per_second = 4.0, .burst = 1.0 });
+      fetcher.addAccount("slow", RestDataProvider{ TokenAuth{ "slow_token"sv }, server.baseUrl(), slow_scheduler });
+      for (int i = 0; i < 3; ++i)
+      {
+         fetcher.addAccount(fmt::format("fast_{}", i), RestDataProvider{ TokenAuth{ fmt::format("fast_token_{}", i) }, server.baseUrl() });
+      }
+
+      std::vector<std::string> finish_order{};
+      std::vector<size_t> sizes{};
+      auto summary = fetcher.fetch<HeartRate>(from, thru, [&] (std::string_view id, AccountSeriesResult<HeartRate>&& res)
+                                              {
+                                                 finish_order.emplace_back(id);
+                                                 sizes.push_back(res ? res->size() : 0);
+                                              });
+
+      // 576 samples at 100 per page is 6 requests per account
+      REQUIRE(summary.failed_accounts == 0);
+      REQUIRE(summary.requests == 4 * 6);
+      REQUIRE(server.requestCount() == 4 * 6);
+      REQUIRE(finish_order.size() == 4);
+      REQUIRE(rg::all_of(sizes, [] (size_t size) { return size == 2 * 288; }));
+      REQUIRE(finish_order.back() == "slow");
+   }
+
+   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
+
+} // namespace oura_charts::test
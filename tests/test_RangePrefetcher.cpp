@@ -0,0 +1,182 @@
+//---------------------------------------------------------------------------------------------------------------------
+// test_RangePrefetcher.cpp
+//
+// unit tests for RangePrefetcher, using a local mock of the REST API.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+#include "oura_charts/oura_charts.h"
+#include "MockOuraServer.h"
+#include "oura_charts/DailySleepScore.h"
+#include "oura_charts/RangePrefetcher.h"
+#include "oura_charts/RestDataProvider.h"
+#include "oura_charts/TokenAuth.h"
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+
+namespace oura_charts::test
+{
+   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+   using namespace std::literals;
+
+   namespace
+   {
+      constexpr auto MOCK_TOKEN = "mock_token"sv;
+
+      SyntheticDataGenerator mockGenerator()
+      {
+         return SyntheticDataGenerator{ SyntheticDataOptions{ .num_days = 90, .time_zone = "" } };
+      }
+
+      MockServerOptions mockOptions(size_t page_size)
+      {
+         return MockServerOptions{ .page_size = page_size, .token = std::string{ MOCK_TOKEN } };
+      }
+
+      const DateRange JANUARY{ chrono::year{ 2022 } / 1 / 1, chrono::year{ 2022 } / 1 / 31 };
+      const DateRange FEBRUARY{ chrono::year{ 2022 } / 2 / 1, chrono::year{ 2022 } / 2 / 28 };
+      const DateRange MARCH{ chrono::year{ 2022 } / 3 / 1, chrono::year{ 2022 } / 3 / 31 };
+   }
+
+
+   TEST_CASE("test_adjacentRanges", "[prefetch]")
+   {
+      using chrono::year;
+
+      // months page by month, whatever their length
+      REQUIRE(adjacentRanges(FEBRUARY) == std::pair{ JANUARY, MARCH });
+
+      // ...including several at a time, and across years
+      auto [before, after] = adjacentRanges(DateRange{ year{ 2022 } / 1 / 1, year{ 2022 } / 2 / 28 });
+      REQUIRE(before == DateRange{ year{ 2021 } / 11 / 1, year{ 2021 } / 12 / 31 });
+      REQUIRE(after == DateRange{ year{ 2022 } / 3 / 1, year{ 2022 } / 4 / 30 });
+
+      // anything else pages by the same number of days
+      std::tie(before, after) = adjacentRanges(DateRange{ year{ 2022 } / 2 / 25, year{ 2022 } / 3 / 3 });
+      REQUIRE(before == DateRange{ year{ 2022 } / 2 / 18, year{ 2022 } / 2 / 24 });
+      REQUIRE(after == DateRange{ year{ 2022 } / 3 / 4, year{ 2022 } / 3 / 10 });
+   }
+
+
+   TEST_CASE("test_RangePrefetcher_fills_cache", "[prefetch][mock_server][cache]")
+   {
+      MockOuraServer server{ mockGenerator(), mockOptions(10) };
+      CachingDataProvider caching{ RestDataProvider{ TokenAuth{ MOCK_TOKEN }, server.baseUrl() } };
+      RangePrefetcher prefetcher{ caching };
+
+      // user is looking at February, so get January and March ready.
+      auto [previous, next] = adjacentRanges(FEBRUARY);
+      prefetcher.prefetch<DailySleepScore>({ previous, next });
+      prefetcher.waitIdle();
+
+      auto stats = prefetcher.stats();
+      REQUIRE(stats.ranges == 2);
+      REQUIRE(stats.pages == 8);
+      REQUIRE(stats.bytes > 0);
+      REQUIRE(server.requestCount() == 8);
+
+      // paging to either of them doesn't go to the server
+      auto scores = getDataSeries<DailySleepScore>(caching, previous.from, previous.thru);
+      REQUIRE(scores.size() == 31);
+      REQUIRE(getDataSeries<DailySleepScore>(caching, next.from, next.thru).size() == 31);
+      REQUIRE(server.requestCount() == 8);
+      REQUIRE(caching.cache()->stats().hits == 8);
+
+      SECTION("errors are counted, and don't stop later prefetches")
+      {
+         RangePrefetcher bad_token{ CachingDataProvider{ RestDataProvider{ TokenAuth{ "bad_token"sv }, server.baseUrl() } } };
+         bad_token.prefetch<DailySleepScore>({ JANUARY, MARCH });
+         bad_token.waitIdle();
+         REQUIRE(bad_token.stats().failed == 2);
+         REQUIRE(bad_token.stats().ranges == 0);
+      }
+   }
+
+
+   TEST_CASE("test_RangePrefetcher_cancel", "[prefetch][mock_server]")
+   {
+      auto options = mockOptions(10);
+      options.latency = 50ms;
+      MockOuraServer server{ mockGenerator(), options };
+      CachingDataProvider caching{ RestDataProvider{ TokenAuth{ MOCK_TOKEN }, server.baseUrl() } };
+      RangePrefetcher prefetcher{ caching };
+
+      SECTION("a new prefetch replaces the old one")
+      {
+         // January is either still queued or has had at most one page fetched when the user moves on.
+         prefetcher.prefetch<DailySleepScore>({ JANUARY });
+         prefetcher.prefetch<DailySleepScore>({ MARCH });
+         prefetcher.waitIdle();
+
+         auto stats = prefetcher.stats();
+         REQUIRE(stats.cancelled == 1);
+         REQUIRE(stats.ranges == 1);
+         REQUIRE(server.requestCount() <= 5);
+      }
+
+      SECTION("cancel")
+      {
+         prefetcher.prefetch<DailySleepScore>({ JANUARY, MARCH });
+         prefetcher.cancel();
+         prefetcher.waitIdle();
+
+         auto stats = prefetcher.stats();
+         REQUIRE(stats.cancelled == 2);
+         REQUIRE(stats.ranges == 0);
+         REQUIRE(server.requestCount() <= 1);
+      }
+
+      SECTION("destructor doesn't wait for pending ranges")
+      {
+         {
+            RangePrefetcher temp{ caching };
+            temp.prefetch<DailySleepScore>({ JANUARY, FEBRUARY, MARCH });
+         }
+         // fetching all three ranges would take 11 requests.
+         REQUIRE(server.requestCount() <= 1);
+      }
+   }
+
+
+   TEST_CASE("test_RangePrefetcher_priority_and_budget", "[prefetch][mock_server]")
+   {
+      MockOuraServer server{ mockGenerator(), mockOptions(10) };
+      CachingDataProvider caching{ RestDataProvider{ TokenAuth{ MOCK_TOKEN }, server.baseUrl() } };
+
+      SECTION("waits for the foreground")
+      {
+         RangePrefetcher prefetcher{ caching };
+         {
+            auto foreground = prefetcher.foreground();
+            prefetcher.prefetch<DailySleepScore>({ JANUARY });
+            std::this_thread::sleep_for(100ms);
+            REQUIRE(server.requestCount() == 0);
+         }
+         prefetcher.waitIdle();
+         REQUIRE(prefetcher.stats().ranges == 1);
+         REQUIRE(server.requestCount() == 4);
+      }
+
+      SECTION("stops at max_bytes")
+      {
+         // the first page goes over the limit, so it's the only one.
+         RangePrefetcher prefetcher{ caching, PrefetchOptions{ .max_bytes = 1 } };
+         prefetcher.prefetch<DailySleepScore>({ JANUARY, MARCH });
+         prefetcher.waitIdle();
+
+         auto stats = prefetcher.stats();
+         REQUIRE(stats.pages == 1);
+         REQUIRE(stats.over_budget == 2);
+         REQUIRE(server.requestCount() == 1);
+
+         // the budget is per call to prefetch()
+         prefetcher.prefetch<DailySleepScore>({ MARCH });
+         prefetcher.waitIdle();
+         REQUIRE(prefetcher.stats().pages == 2);
+      }
+   }
+
+   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+} // namespace oura_charts::test
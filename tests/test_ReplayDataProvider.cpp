@@ -0,0 +1,165 @@
+//---------------------------------------------------------------------------------------------------------------------
+// test_ReplayDataProvider.cpp
+//
+// unit tests for RecordingDataProvider and ReplayDataProvider, recording traffic from a local mock of the REST API.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+#include "oura_charts/oura_charts.h"
+#include "MockOuraServer.h"
+#include "oura_charts/DailySleepScore.h"
+#include "oura_charts/HeartRate.h"
+#include "oura_charts/ReplayDataProvider.h"
+#include "oura_charts/RestDataProvider.h"
+#include "oura_charts/TokenAuth.h"
+#include "oura_charts/UserProfile.h"
+#include <catch2/catch_test_macros.hpp>
+#include <fstream>
+
+namespace oura_charts::test
+{
+   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+   using namespace std::literals;
+
+   namespace
+   {
+      constexpr auto MOCK_TOKEN = "mock_token"sv;
+
+      SyntheticDataGenerator mockGenerator()
+      {
+         return SyntheticDataGenerator{ SyntheticDataOptions{ .num_days = 30, .time_zone = "" } };
+      }
+
+      MockServerOptions mockOptions(size_t page_size)
+      {
+         return MockServerOptions{ .page_size = page_size, .token = std::string{ MOCK_TOKEN } };
+      }
+
+      fs::path recordingFolder(std::string_view name)
+      {
+         auto folder = fs::temp_directory_path() / name;
+         fs::remove_all(folder);
+         return folder;
+      }
+   }
+
+
+   TEST_CASE("test_ReplayDataProvider_round_trip", "[replay][mock_server]")
+   {
+      MockOuraServer server{ mockGenerator(), mockOptions(100) };
+      auto folder = recordingFolder("oura_charts_test_recording");
+
+      const year_month_day from{ chrono::year{ 2022 } / 1 / 3 };
+      const year_month_day thru{ chrono::year{ 2022 } / 1 / 4 };
+      const year_month_day later{ chrono::year{ 2022 } / 1 / 5 };
+
+      // record a paged endpoint, a single-page one and a single object.
+      RecordingDataProvider recorder{ RestDataProvider{ TokenAuth{ MOCK_TOKEN }, server.baseUrl() }, folder };
+      auto heart_rates = getDataSeries<HeartRate>(recorder, from, thru);
+      auto scores = getDataSeries<DailySleepScore>(recorder, from, thru);
+      auto profile = getUserProfile(recorder);
+      REQUIRE(heart_rates.size() == 2 * 288);
+      REQUIRE(server.requestCount() == 8);
+      REQUIRE(recorder.writer()->count() == server.requestCount());
+
+      // replay gives the same results without going to the server.
+      ReplayDataProvider replay{ folder };
+      REQUIRE(replay.size() == 8);
+      auto replayed = getDataSeries<HeartRate>(replay, from, thru);
+      REQUIRE(rg::equal(replayed, heart_rates, {}, &HeartRate::timestamp, &HeartRate::timestamp));
+      REQUIRE(rg::equal(getDataSeries<DailySleepScore>(replay, from, thru), scores, {}, &DailySleepScore::id, &DailySleepScore::id));
+      REQUIRE(getUserProfile(replay).email() == profile.email());
+      REQUIRE(server.requestCount() == 8);
+
+      SECTION("requests that weren't recorded are errors")
+      {
+         auto missing = replay.getJsonData(constants::REST_PATH_SLEEP_SESSION);
+         REQUIRE_FALSE(missing.has_value());
+         REQUIRE(missing.error().category == ErrorCategory::FileIO);
+         REQUIRE_THROWS_AS(getDataSeries<HeartRate>(replay, from, later), oura_exception);
+      }
+
+      SECTION("matching by path and next_token")
+      {
+         // different dates still get the recorded pages, the same way TestDataProvider serves them.
+         ReplayDataProvider any_params{ folder, ReplayOptions{ .match_params = false } };
+         REQUIRE(getDataSeries<HeartRate>(any_params, from, later).size() == heart_rates.size());
+      }
+
+      SECTION("failed requests aren't recorded")
+      {
+         auto bad_folder = recordingFolder("oura_charts_test_recording_errors");
+         RecordingDataProvider bad_token{ RestDataProvider{ TokenAuth{ "bad_token"sv }, server.baseUrl() }, bad_folder };
+         REQUIRE_THROWS_AS(getDataSeries<HeartRate>(bad_token, from, thru), oura_exception);
+         REQUIRE(bad_token.writer()->count() == 0);
+         REQUIRE(ReplayDataProvider{ bad_folder }.size() == 0);
+      }
+   }
+
+
+   TEST_CASE("test_ReplayDataProvider_timing", "[replay][mock_server]")
+   {
+      // one page, which takes at least 'latency' to arrive.
+      constexpr auto latency = 100ms;
+      auto options = mockOptions(0);
+      options.latency = latency;
+      MockOuraServer server{ mockGenerator(), options };
+      auto folder = recordingFolder("oura_charts_test_recording_timing");
+
+      const year_month_day from{ chrono::year{ 2022 } / 1 / 3 };
+      const year_month_day thru{ chrono::year{ 2022 } / 1 / 4 };
+      {
+         RecordingDataProvider recorder{ RestDataProvider{ TokenAuth{ MOCK_TOKEN }, server.baseUrl() }, folder };
+         REQUIRE(getDataSeries<DailySleepScore>(recorder, from, thru).size() == 2);
+      }
+
+      auto timeReplay = [&] (ReplayTiming timing)
+         {
+            ReplayDataProvider replay{ folder, ReplayOptions{ .timing = timing } };
+            auto start = std::chrono::steady_clock::now();
+            REQUIRE(getDataSeries<DailySleepScore>(replay, from, thru).size() == 2);
+            return std::chrono::steady_clock::now() - start;
+         };
+
+      REQUIRE(timeReplay(ReplayTiming::RecordedLatency) >= latency);
+   }
+
+
+   TEST_CASE("test_ReplayDataProvider_errors", "[replay]")
+   {
+      auto folder = recordingFolder("oura_charts_test_recording_invalid");
+      REQUIRE_THROWS_AS(ReplayDataProvider{ folder }, oura_exception);
+
+      // an index entry whose body file is missing
+      {
+         RecordingWriter writer{ folder };
+         writer.write(constants::REST_PATH_PERSONAL_INFO, {}, R"({"email":"x"})", 10ms);
+      }
+      REQUIRE(ReplayDataProvider{ folder }.size() == 1);
+      fs::remove(folder / "000001.json");
+      REQUIRE_THROWS_AS(ReplayDataProvider{ folder }, oura_exception);
+   }
+
+
+   TEST_CASE("test_RecordingWriter_replaces_old_recording", "[replay]")
+   {
+      auto folder = recordingFolder("oura_charts_test_recording_replaced");
+      {
+         RecordingWriter writer{ folder };
+         writer.write(constants::REST_PATH_PERSONAL_INFO, {}, R"({"email":"x"})", 10ms);
+         writer.write(constants::REST_PATH_PERSONAL_INFO, {}, R"({"email":"y"})", 10ms);
+      }
+      std::ofstream{ folder / "notes.json" } << "{}";
+
+      // the old responses are removed, anything else in the folder is left alone.
+      RecordingWriter writer{ folder };
+      REQUIRE_FALSE(fs::exists(folder / "000001.json"));
+      REQUIRE_FALSE(fs::exists(folder / "000002.json"));
+      REQUIRE(fs::exists(folder / "notes.json"));
+      REQUIRE(ReplayDataProvider{ folder }.size() == 0);
+   }
+
+   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+} // namespace oura_charts::test
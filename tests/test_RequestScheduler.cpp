@@ -0,0 +1,139 @@
+//---------------------------------------------------------------------------------------------------------------------
+// test_RequestScheduler.cpp
+//
+// unit tests for the REST request scheduler (rate limiting and retry/backoff)
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+#include "oura_charts/oura_charts.h"
+#include "oura_charts/RequestScheduler.h"
+#include <catch2/catch_test_macros.hpp>
+
+namespace oura_charts::test
+{
+   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
+
+   using namespace std::literals;
+   using clock = RequestScheduler::clock;
+
+
+   TEST_CASE("test_RequestScheduler_retryable", "[scheduler]")
+   {
+      REQUIRE(RequestScheduler::isRetryable(0));
+      REQUIRE(RequestScheduler::isRetryable(429));
+      REQUIRE(RequestScheduler::isRetryable(503));
+      REQUIRE_FALSE(RequestScheduler::isRetryable(200));
+      REQUIRE_FALSE(RequestScheduler::isRetryable(400));
+      REQUIRE_FALSE(RequestScheduler::isRetryable(401));
+      REQUIRE_FALSE(RequestScheduler::isRetryable(404));
+
+      REQUIRE(RequestScheduler::parseRetryAfter("120") == 120s);
+      REQUIRE(RequestScheduler::parseRetryAfter("0") == 0s);
+      REQUIRE_FALSE(RequestScheduler::parseRetryAfter(""));
+      REQUIRE_FALSE(RequestScheduler::parseRetryAfter("-1"));
+      REQUIRE_FALSE(RequestScheduler::parseRetryAfter("Wed, 21 Oct 2015 07:28:00 GMT"));
+   }
+
+
+   TEST_CASE("test_RequestScheduler_backoff", "[scheduler]")
+   {
+      RetryPolicy policy{ .max_attempts = 4, .initial_backoff = 100ms, .max_backoff = 1000ms, .multiplier = 2.0, .jitter = 0.5 };
+      RequestScheduler scheduler{ RateLimit{}, policy };
+
+      // delays double each time, jitter can reduce them by up to half, and they never exceed max_backoff
+      for (int i = 0; i < 20; ++i)
+      {
+         auto delay1 = scheduler.backoffDelay(1);
+         auto delay3 = scheduler.backoffDelay(3);
+         auto delay10 = scheduler.backoffDelay(10);
+         REQUIRE((delay1 >= 50ms and delay1 <= 100ms));
+         REQUIRE((delay3 >= 200ms and delay3 <= 400ms));
+         REQUIRE((delay10 >= 500ms and delay10 <= 1000ms));
+      }
+
+      SECTION("success and permanent errors aren't retried")
+      {
+         REQUIRE_FALSE(scheduler.completeRequest(200, "", 1));
+         REQUIRE_FALSE(scheduler.completeRequest(404, "", 1));
+      }
+
+      SECTION("transient errors are retried until max_attempts")
+      {
+         REQUIRE(scheduler.completeRequest(503, "", 1));
+         REQUIRE(scheduler.completeRequest(0, "", 3));
+         REQUIRE_FALSE(scheduler.completeRequest(503, "", 4));
+      }
+
+      SECTION("Retry-After is honored")
+      {
+         auto delay = scheduler.completeRequest(429, "2", 1);
+         REQUIRE(delay);
+         REQUIRE(*delay >= 2s);
+      }
+   }
+
+
+   TEST_CASE("test_RequestScheduler_adaptive_rate", "[scheduler]")
+   {
+      RateLimit limit{ .requests_per_second = 100.0, .burst = 1.0 };
+      RequestScheduler scheduler{ limit, RetryPolicy{ .initial_backoff = 1ms, .max_backoff = 1ms } };
+      REQUIRE(scheduler.currentRate() == 100.0);
+
+      // throttling cuts the rate, successes bring it back up to (but not over) the limit.
+      REQUIRE(scheduler.completeRequest(429, "", 1));
+      REQUIRE(scheduler.currentRate() == 50.0);
+
+      for (int i = 0; i < 50; ++i)
+         REQUIRE_FALSE(scheduler.completeRequest(200, "", 1));
+
+      REQUIRE(scheduler.currentRate() == 100.0);
+   }
+
+
+   TEST_CASE("test_RequestScheduler_token_bucket", "[scheduler]")
+   {
+      RateLimit limit{ .requests_per_second = 100.0, .burst = 5.0 };
+      RequestScheduler scheduler{ limit };
+
+      // the burst is available right away, after that we're limited to the rate.
+      auto start = clock::now();
+      for (int i = 0; i < 5; ++i)
+      {
+         REQUIRE(scheduler.timeUntilReady() == clock::duration::zero());
+         scheduler.acquire();
+      }
+
+      for (int i = 0; i < 5; ++i)
+         scheduler.acquire();
+
+      REQUIRE(clock::now() - start >= 40ms);
+
+      REQUIRE_THROWS_AS(RequestScheduler(RateLimit{ .requests_per_second = 0.0 }), oura_exception);
+   }
+
+
+   TEST_CASE("test_RequestScheduler_time_until_ready", "[scheduler]")
+   {
+      RateLimit limit{ .requests_per_second = 10.0, .burst = 1.0 };
+      RequestScheduler scheduler{ limit, RetryPolicy{ .initial_backoff = 500ms, .max_backoff = 500ms, .jitter = 0.0 } };
+
+      // checking doesn't use up the budget
+      REQUIRE(scheduler.timeUntilReady() == clock::duration::zero());
+      REQUIRE(scheduler.timeUntilReady() == clock::duration::zero());
+
+      // the next token is never more than 1/rate away.
+      scheduler.acquire();
+      REQUIRE(scheduler.timeUntilReady() <= 100ms);
+
+      // being throttled blocks until the retry delay has passed. Whatever time has gone by since the request
+      // completed is subtracted from the wait, so add it back in.
+      const auto throttled_at = clock::now();
+      REQUIRE(scheduler.completeRequest(429, "", 1));
+      const auto wait = scheduler.timeUntilReady();
+      const auto elapsed = clock::now() - throttled_at;
+      REQUIRE(wait + elapsed >= 500ms);
+   }
+
+   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
+
+} // namespace oura_charts::test
@@ -0,0 +1,282 @@
+//---------------------------------------------------------------------------------------------------------------------
+// test_ResponseCache.cpp
+//
+// unit tests for ResponseCache and CachingDataProvider
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+#include "oura_charts/oura_charts.h"
+#include "SyntheticDataGenerator.h"
+#include "TestDataProvider.h"
+#include "oura_charts/DailySleepScore.h"
+#include "oura_charts/ResponseCache.h"
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <future>
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace oura_charts::test
+{
+   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
+
+   using namespace std::literals;
+
+   namespace
+   {
+      /// <summary>
+      ///   provider that supports conditional requests, with a version number that stands in for the data on the
+      ///   server changing. Copies share the same state.
+      /// </summary>
+      class VersionedProvider
+      {
+      public:
+         using JsonResult = expected<std::string, oura_exception>;
+         using ConditionalResult = expected<ConditionalResponse, oura_exception>;
+
+         struct State
+         {
+            std::atomic<int> version{ 1 };
+            std::atomic<int> requests{};
+            std::atomic<int> not_modified{};
+            std::atomic<bool> fail{};
+            std::chrono::milliseconds latency{};
+         };
+
+         std::shared_ptr<State> state{ std::make_shared<State>() };
+
+         [[nodiscard]] JsonResult getJsonData(std::string_view path) const noexcept
+         {
+            auto res = getJsonDataIfModified(path, std::map<std::string, std::string>{}, {});
+            if (!res)
+               return unexpected{ res.error() };
+
+            return res->json;
+         }
+
+         template <KeyValueRange MapT>
+         [[nodiscard]] JsonResult getJsonData(std::string_view path, MapT&&) const noexcept
+         {
+            return getJsonData(path);
+         }
+
+         template <KeyValueRange MapT>
+         [[nodiscard]] ConditionalResult getJsonDataIfModified(std::string_view path, const MapT&, const ResponseValidators& validators) const noexcept
+         {
+            ++state->requests;
+            std::this_thread::sleep_for(state->latency);
+            if (state->fail)
+               return unexpected{ oura_exception{ "VersionedProvider - failed", ErrorCategory::REST } };
+
+            auto version = state->version.load();
+            auto etag = fmt::format(R"("v{}")", version);
+            if (validators.etag == etag)
+            {
+               ++state->not_modified;
+               return ConditionalResponse{ .not_modified = true };
+            }
+            return ConditionalResponse{ .json = fmt::format(R"({{"path":"{}","version":{}}})", path, version), .validators = { .etag = etag } };
+         }
+      };
+
+      static_assert(ConditionalDataProvider<VersionedProvider>);
+      static_assert(StreamingDataProvider<CachingDataProvider<VersionedProvider>>);
+   }
+
+
+   TEST_CASE("test_ResponseCache_ttl_and_revalidation", "[cache]")
+   {
+      VersionedProvider provider{};
+      auto cache = std::make_shared<ResponseCache>(ResponseCacheOptions{ .ttl = 50ms });
+      CachingDataProvider caching{ provider, cache };
+
+      // second request is served from memory
+      auto first = caching.getJsonData("personal_info");
+      REQUIRE(first.has_value());
+      REQUIRE(caching.getJsonData("personal_info") == first.value());
+      REQUIRE(provider.state->requests == 1);
+      REQUIRE(cache->stats().hits == 1);
+
+      // once the ttl runs out the server is asked, but doesn't send the body again if it hasn't changed.
+      std::this_thread::sleep_for(60ms);
+      REQUIRE(caching.getJsonData("personal_info") == first.value());
+      REQUIRE(provider.state->requests == 2);
+      REQUIRE(provider.state->not_modified == 1);
+      REQUIRE(cache->stats().revalidated == 1);
+
+      // revalidating restarts the ttl
+      REQUIRE(caching.getJsonData("personal_info") == first.value());
+      REQUIRE(provider.state->requests == 2);
+
+      // if it has changed we get the new version
+      ++provider.state->version;
+      std::this_thread::sleep_for(60ms);
+      auto updated = caching.getJsonData("personal_info");
+      REQUIRE(updated.has_value());
+      REQUIRE(updated.value() != first.value());
+      REQUIRE(updated.value().contains(R"("version":2)"));
+
+      // params are part of the key
+      REQUIRE(caching.getJsonData("heartrate", std::map<std::string, std::string>{ { "start_date", "2024-01-01" } }).has_value());
+      REQUIRE(caching.getJsonData("heartrate", std::map<std::string, std::string>{ { "start_date", "2024-01-02" } }).has_value());
+      REQUIRE(cache->size() == 3);
+   }
+
+
+   TEST_CASE("test_ResponseCache_errors_not_cached", "[cache]")
+   {
+      VersionedProvider provider{};
+      CachingDataProvider caching{ provider };
+
+      provider.state->fail = true;
+      REQUIRE_FALSE(caching.getJsonData("personal_info").has_value());
+      REQUIRE(caching.cache()->size() == 0);
+
+      provider.state->fail = false;
+      REQUIRE(caching.getJsonData("personal_info").has_value());
+      REQUIRE(provider.state->requests == 2);
+
+      // exceptions thrown by the fetch function go to the caller, and don't leave the key stuck in flight.
+      ResponseCache cache{};
+      auto throwing = [] (const ResponseValidators&) -> ResponseCache::FetchResult { throw std::runtime_error{ "test" }; };
+      REQUIRE_THROWS_AS(cache.get("key", throwing), std::runtime_error);
+      REQUIRE(cache.get("key", [] (const ResponseValidators&) { return ResponseCache::FetchResult{ ConditionalResponse{ .json = "{}" } }; }) == "{}");
+   }
+
+
+   TEST_CASE("test_ResponseCache_lru_eviction", "[cache]")
+   {
+      auto fetch_value = [] (std::string value)
+         {
+            return [value] (const ResponseValidators&) { return ResponseCache::FetchResult{ ConditionalResponse{ .json = value } }; };
+         };
+
+      SECTION("max_entries")
+      {
+         ResponseCache cache{ ResponseCacheOptions{ .max_entries = 2 } };
+         REQUIRE(cache.get("a", fetch_value("1")) == "1");
+         REQUIRE(cache.get("b", fetch_value("2")) == "2");
+
+         // using 'a' makes 'b' the least recently used, so it's the one that goes.
+         REQUIRE(cache.get("a", fetch_value("x")) == "1");
+         REQUIRE(cache.get("c", fetch_value("3")) == "3");
+         REQUIRE(cache.size() == 2);
+         REQUIRE(cache.stats().evictions == 1);
+         REQUIRE(cache.get("a", fetch_value("x")) == "1");
+         REQUIRE(cache.get("b", fetch_value("new")) == "new");
+      }
+
+      SECTION("max_bytes")
+      {
+         ResponseCache cache{ ResponseCacheOptions{ .max_bytes = 10 } };
+         REQUIRE(cache.get("a", fetch_value("12345")) == "12345");
+         REQUIRE(cache.get("b", fetch_value("12345")) == "12345");
+         REQUIRE(cache.sizeBytes() == 10);
+
+         REQUIRE(cache.get("c", fetch_value("123")) == "123");
+         REQUIRE(cache.size() == 2);
+         REQUIRE(cache.sizeBytes() == 8);
+
+         // too big to ever fit, so it's returned but not cached
+         REQUIRE(cache.get("d", fetch_value("12345678901")) == "12345678901");
+         REQUIRE(cache.size() == 2);
+      }
+
+      SECTION("invalidate")
+      {
+         ResponseCache cache{};
+         REQUIRE(cache.get("a", fetch_value("1")) == "1");
+         REQUIRE(cache.get("b", fetch_value("2")) == "2");
+         cache.invalidate("a");
+         REQUIRE(cache.get("a", fetch_value("new")) == "new");
+         cache.clear();
+         REQUIRE(cache.size() == 0);
+         REQUIRE(cache.sizeBytes() == 0);
+      }
+   }
+
+
+   TEST_CASE("test_ResponseCache_single_flight", "[cache]")
+   {
+      VersionedProvider provider{};
+      provider.state->latency = 100ms;
+      CachingDataProvider caching{ provider };
+
+      // every thread asks for the same thing at once, only one request should be sent.
+      constexpr size_t thread_count = 8;
+      std::vector<CachingDataProvider<VersionedProvider>::JsonResult> results(thread_count);
+      {
+         std::vector<std::jthread> threads{};
+         for (size_t i = 0; i < thread_count; ++i)
+         {
+            threads.emplace_back([&caching, &results, i] { results[i] = caching.getJsonData("personal_info"); });
+         }
+      }
+
+      REQUIRE(provider.state->requests == 1);
+      REQUIRE(rg::all_of(results, [&results] (const auto& res) { return res.has_value() and res.value() == results.front().value(); }));
+
+      auto stats = caching.cache()->stats();
+      REQUIRE(stats.misses == 1);
+      REQUIRE(stats.coalesced + stats.hits == thread_count - 1);
+   }
+
+
+   TEST_CASE("test_ResponseCache_clear_during_fetch", "[cache]")
+   {
+      auto fetch_value = [] (std::string value)
+         {
+            return [value] (const ResponseValidators&) { return ResponseCache::FetchResult{ ConditionalResponse{ .json = value } }; };
+         };
+
+      // a fetch that's still running when the cache is cleared (eg because the access token changed)
+      ResponseCache cache{};
+      std::promise<void> started{};
+      std::promise<void> release{};
+      ResponseCache::JsonResult old_result{};
+      std::jthread old_fetch{ [&cache, &started, &old_result, released = release.get_future()] ()
+         {
+            old_result = cache.get("a", [&started, &released] (const ResponseValidators&)
+               {
+                  started.set_value();
+                  released.wait();
+                  return ResponseCache::FetchResult{ ConditionalResponse{ .json = "old" } };
+               });
+         } };
+      started.get_future().wait();
+      cache.clear();
+
+      // later lookups don't wait for it, and its response isn't stored when it arrives.
+      REQUIRE(cache.get("a", fetch_value("new")) == "new");
+      release.set_value();
+      old_fetch.join();
+
+      REQUIRE(old_result == "old");
+      REQUIRE(cache.size() == 1);
+      REQUIRE(cache.get("a", fetch_value("x")) == "new");
+   }
+
+
+   TEST_CASE("test_CachingDataProvider_series", "[cache]")
+   {
+      // works with providers that don't support conditional requests, including paged endpoints.
+      SyntheticDataGenerator gen{ SyntheticDataOptions{ .num_days = 30, .page_size = 10 } };
+      TestDataProvider provider{};
+      gen.populate(provider);
+      CachingDataProvider caching{ provider };
+
+      auto first = detail::getDataSeries<DailySleepScore>(caching);
+      auto misses = caching.cache()->stats().misses;
+      REQUIRE(first.size() == 30);
+      REQUIRE(misses == 3);
+
+      auto second = detail::getDataSeries<DailySleepScore>(caching);
+      REQUIRE(caching.cache()->stats().misses == misses);
+      REQUIRE(caching.cache()->stats().hits == 3);
+      REQUIRE(rg::equal(first, second, {}, &DailySleepScore::score, &DailySleepScore::score));
+   }
+
+   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
+
+} // namespace oura_charts::test
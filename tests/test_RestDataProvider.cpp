@@ -0,0 +1,275 @@
+//---------------------------------------------------------------------------------------------------------------------
+// test_RestDataProvider.cpp
+//
+// end-to-end tests for RestDataProvider, using a local mock of the REST API.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+#include "oura_charts/oura_charts.h"
+#include "MockOuraServer.h"
+#include "oura_charts/DailySleepScore.h"
+#include "oura_charts/HeartRate.h"
+#include "oura_charts/RequestScheduler.h"
+#include "oura_charts/ResponseCache.h"
+#include "oura_charts/RestDataProvider.h"
+#include "oura_charts/SleepSession.h"
+#include "oura_charts/TokenAuth.h"
+#include "oura_charts/UserProfile.h"
+#include "oura_charts/detail/instrumentation.h"
+#include <catch2/catch_test_macros.hpp>
+
+namespace oura_charts::test
+{
+   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+   using namespace std::literals;
+
+   namespace
+   {
+      constexpr const char* MOCK_TOKEN = "mock_token";
+
+      SyntheticDataGenerator mockGenerator()
+      {
+         return SyntheticDataGenerator{ SyntheticDataOptions{ .num_days = 30, .time_zone = "" } };
+      }
+
+      MockServerOptions mockOptions(size_t page_size)
+      {
+         return MockServerOptions{ .page_size = page_size, .token = MOCK_TOKEN };
+      }
+   }
+
+
+   TEST_CASE("test_RestDataProvider_heart_rate_paging", "[rest][mock_server]")
+   {
+      MockOuraServer server{ mockGenerator(), mockOptions(100) };
+      RestDataProvider provider{ TokenAuth{ MOCK_TOKEN }, server.baseUrl() };
+
+      // two days of samples every 5 minutes, 100 per page.
+      auto start = sys_days{ chrono::year{ 2022 } / 1 / 3 };
+      auto hr_series = getDataSeries<HeartRate>(provider, start, start + days{ 2 });
+      REQUIRE(hr_series.size() == 2 * 288);
+      REQUIRE(server.requestCount() == 6);
+
+      auto first = localToUtc(hr_series.front().timestamp());
+      auto last = localToUtc(hr_series.back().timestamp());
+      REQUIRE(first >= start);
+      REQUIRE(last < start + days{ 2 });
+   }
+
+
+   TEST_CASE("test_RestDataProvider_date_filter", "[rest][mock_server]")
+   {
+      MockOuraServer server{ mockGenerator(), mockOptions(3) };
+      RestDataProvider provider{ TokenAuth{ MOCK_TOKEN }, server.baseUrl() };
+
+      const year_month_day from{ chrono::year{ 2022 } / 1 / 5 };
+      const year_month_day thru{ chrono::year{ 2022 } / 1 / 14 };
+
+      // end_date is inclusive
+      auto scores = getDataSeries<DailySleepScore>(provider, from, thru);
+      REQUIRE(scores.size() == 10);
+      REQUIRE(server.requestCount() == 4);
+
+      auto sessions = getDataSeries<SleepSession>(provider, from, thru);
+      REQUIRE(sessions.size() >= 10);
+      for (const auto& session : sessions)
+      {
+         REQUIRE(session.sessionDate() >= from);
+         REQUIRE(session.sessionDate() <= thru);
+      }
+   }
+
+
+   TEST_CASE("test_RestDataProvider_batched_fetch", "[rest][mock_server]")
+   {
+      // one page per endpoint, each taking at least 'latency' to arrive.
+      constexpr auto latency = 300ms;
+      auto options = mockOptions(0);
+      options.latency = latency;
+      MockOuraServer server{ mockGenerator(), options };
+      RestDataProvider provider{ TokenAuth{ MOCK_TOKEN }, server.baseUrl() };
+
+      const year_month_day from{ chrono::year{ 2022 } / 1 / 5 };
+      const year_month_day thru{ chrono::year{ 2022 } / 1 / 14 };
+
+      auto start = std::chrono::steady_clock::now();
+      auto [sessions, scores, heart_rates] = getDataSeries<SleepSession, DailySleepScore, HeartRate>(provider, from, thru);
+      auto elapsed = std::chrono::steady_clock::now() - start;
+
+      // the requests overlap instead of running one after the other.
+      REQUIRE(server.requestCount() == 3);
+      REQUIRE(server.maxConcurrentRequests() > 1);
+      REQUIRE(elapsed >= latency);
+
+      REQUIRE(sessions.size() >= 10);
+      REQUIRE(scores.size() == 10);
+
+      // HR filters on date/time, so the dates are converted to a local time range covering full days.
+      REQUIRE(heart_rates.size() == 10 * 288);
+      REQUIRE(getCalendarDate(heart_rates.front().timestamp()) == from);
+      REQUIRE(getCalendarDate(heart_rates.back().timestamp()) == thru);
+   }
+
+
+   TEST_CASE("test_RestDataProvider_compression", "[rest][mock_server]")
+   {
+      if constexpr (!instrumentation::ENABLED)
+         SKIP("byte counts require instrumentation");
+
+      MockOuraServer server{ mockGenerator(), mockOptions(0) };
+      RestDataProvider provider{ TokenAuth{ MOCK_TOKEN }, server.baseUrl() };
+      const auto start = sys_days{ chrono::year{ 2022 } / 1 / 3 };
+
+      auto byteCounts = [&]
+         {
+            instrumentation::reset();
+            auto hr_series = getDataSeries<HeartRate>(provider, start, start + days{ 7 });
+            REQUIRE(hr_series.size() == 7 * 288);
+
+            uint64_t wire{};
+            uint64_t decompressed{};
+            for (const auto& metric : instrumentation::snapshot())
+            {
+               if (metric.name == constants::METRIC_REST_WIRE_BYTES)
+                  wire = metric.sum;
+               else if (metric.name == constants::METRIC_REST_RESPONSE_BYTES)
+                  decompressed = metric.sum;
+            }
+            return std::pair{ wire, decompressed };
+         };
+
+      REQUIRE(provider.compressionEnabled());
+      auto [compressed_wire, compressed_text] = byteCounts();
+      REQUIRE(compressed_wire > 0);
+      REQUIRE(compressed_wire * 4 < compressed_text);
+
+      provider.enableCompression(false);
+      auto [plain_wire, plain_text] = byteCounts();
+      REQUIRE(plain_wire == plain_text);
+      REQUIRE(plain_text == compressed_text);
+   }
+
+
+   TEST_CASE("test_RestDataProvider_streaming", "[rest][mock_server][json_stream]")
+   {
+      MockOuraServer server{ mockGenerator(), mockOptions(100) };
+      RestDataProvider provider{ TokenAuth{ MOCK_TOKEN }, server.baseUrl() };
+
+      const year_month_day from{ chrono::year{ 2022 } / 1 / 3 };
+      const year_month_day thru{ chrono::year{ 2022 } / 1 / 4 };
+
+      DataSeries<HeartRate> streamed{};
+      auto count = streamDataSeries<HeartRate>(provider, from, thru, appendTo(streamed));
+      REQUIRE(count > 100);
+      REQUIRE(streamed.size() == count);
+
+      // same pages, same records as the buffered version.
+      auto requests = server.requestCount();
+      auto buffered = getDataSeries<HeartRate>(provider, from, thru);
+      REQUIRE(server.requestCount() == 2 * requests);
+      REQUIRE(buffered.size() == count);
+      REQUIRE(std::ranges::equal(streamed, buffered, {}, &HeartRate::timestamp, &HeartRate::timestamp));
+
+      SECTION("errors are reported")
+      {
+         RestDataProvider bad_token{ TokenAuth{ "bad_token" }, server.baseUrl() };
+         REQUIRE_THROWS_AS(streamDataSeries<HeartRate>(bad_token, from, thru, [] (HeartRate&&) {}), oura_exception);
+      }
+   }
+
+
+   TEST_CASE("test_RestDataProvider_personal_info", "[rest][mock_server]")
+   {
+      MockOuraServer server{ mockGenerator(), mockOptions(100) };
+      RestDataProvider provider{ TokenAuth{ MOCK_TOKEN }, server.baseUrl() };
+
+      auto profile = getUserProfile(provider);
+      REQUIRE(profile.email() == "synthetic@example.com");
+   }
+
+
+   TEST_CASE("test_RestDataProvider_conditional_requests", "[rest][mock_server][cache]")
+   {
+      MockOuraServer server{ mockGenerator(), mockOptions(100) };
+      RestDataProvider provider{ TokenAuth{ MOCK_TOKEN }, server.baseUrl() };
+      const std::map<std::string, std::string> no_params{};
+
+      auto first = provider.getJsonDataIfModified(constants::REST_PATH_PERSONAL_INFO, no_params, {});
+      REQUIRE(first.has_value());
+      REQUIRE_FALSE(first->not_modified);
+      REQUIRE_FALSE(first->json.empty());
+      REQUIRE_FALSE(first->validators.etag.empty());
+
+      // the server doesn't send the body again when the ETag matches
+      auto second = provider.getJsonDataIfModified(constants::REST_PATH_PERSONAL_INFO, no_params, first->validators);
+      REQUIRE(second.has_value());
+      REQUIRE(second->not_modified);
+      REQUIRE(second->json.empty());
+      REQUIRE(server.notModifiedCount() == 1);
+
+      // with a cache in front, repeated requests don't go to the server until the ttl runs out, and then
+      // only to revalidate.
+      server.resetCounts();
+      auto cache = std::make_shared<ResponseCache>(ResponseCacheOptions{ .ttl = 0ms });
+      CachingDataProvider caching{ provider, cache };
+      for (int i = 0; i < 3; ++i)
+      {
+         REQUIRE(getUserProfile(caching).email() == "synthetic@example.com");
+      }
+      REQUIRE(server.requestCount() == 3);
+      REQUIRE(server.notModifiedCount() == 2);
+      REQUIRE(cache->stats().revalidated == 2);
+   }
+
+
+   TEST_CASE("test_RestDataProvider_errors", "[rest][mock_server]")
+   {
+      MockOuraServer server{ mockGenerator(), mockOptions(100) };
+      const auto start = sys_days{ chrono::year{ 2022 } / 1 / 3 };
+
+      SECTION("invalid token")
+      {
+         RestDataProvider provider{ TokenAuth{ "bad_token" }, server.baseUrl() };
+         auto json_res = provider.getJsonData(constants::REST_PATH_HEART_RATE);
+         REQUIRE_FALSE(json_res.has_value());
+         REQUIRE(json_res.error().category == ErrorCategory::REST);
+      }
+
+      SECTION("throttled, no retries")
+      {
+         // three pages, but only two are allowed.
+         auto options = mockOptions(100);
+         options.throttle_limit = 2;
+         options.throttle_window = 60s;
+         server.setOptions(options);
+
+         auto scheduler = std::make_shared<RequestScheduler>(RateLimit{}, RetryPolicy{ .max_attempts = 1 });
+         RestDataProvider provider{ TokenAuth{ MOCK_TOKEN }, server.baseUrl(), scheduler };
+         REQUIRE_THROWS_AS(getDataSeries<HeartRate>(provider, start, start + days{ 1 }), oura_exception);
+         REQUIRE(server.throttledCount() == 1);
+      }
+
+      SECTION("throttled, resumes after Retry-After")
+      {
+         auto options = mockOptions(100);
+         options.throttle_limit = 2;
+         options.throttle_window = 500ms;
+         options.retry_after = 1s;
+         server.setOptions(options);
+
+         auto scheduler = std::make_shared<RequestScheduler>(RateLimit{}, RetryPolicy{ .initial_backoff = 10ms });
+         RestDataProvider provider{ TokenAuth{ MOCK_TOKEN }, server.baseUrl(), scheduler };
+         auto hr_series = getDataSeries<HeartRate>(provider, start, start + days{ 1 });
+
+         // the throttled page is retried in place, earlier pages aren't re-fetched.
+         REQUIRE(hr_series.size() == 288);
+         REQUIRE(server.throttledCount() == 1);
+         REQUIRE(server.requestCount() == 4);
+         REQUIRE(scheduler->currentRate() < scheduler->rateLimit().requests_per_second);
+      }
+   }
+
+   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+} // namespace oura_charts::test
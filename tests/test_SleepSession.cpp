@@ -6,10 +6,13 @@
 // Copyright (c) 2024 Jeff Kohn. All Right Reserved.
 //---------------------------------------------------------------------------------------------------------------------
 #include "oura_charts/oura_charts.h"
+#include "SyntheticDataGenerator.h"
 #include "TestDataProvider.h"
+#include "oura_charts/EnumArray.h"
 #include "oura_charts/SleepSession.h"
 #include "oura_charts/detail/json_structs.h"
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
 #include <filesystem>
 
 // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
@@ -40,6 +43,125 @@ namespace oura_charts::test
    }
 
 
+   TEST_CASE("test_EnumArray", "[EnumArray]")
+   {
+      ReadinessContributorArray contributors{};
+      REQUIRE(contributors.count() == 0);
+      REQUIRE(contributors.size() == 8);
+      REQUIRE_FALSE(contributors.get(ReadinessContributors::hrv_balance).has_value());
+
+      contributors.set(ReadinessContributors::hrv_balance, 90);
+      contributors.set(ReadinessContributors::sleep_balance, std::optional<int>{});
+      REQUIRE(contributors.count() == 1);
+      REQUIRE(contributors.contains(ReadinessContributors::hrv_balance));
+      REQUIRE_FALSE(contributors.contains(ReadinessContributors::sleep_balance));
+      REQUIRE(contributors.get(ReadinessContributors::hrv_balance) == 90);
+      REQUIRE(contributors[ReadinessContributors::hrv_balance] == 90);
+      REQUIRE(contributors[ReadinessContributors::sleep_balance] == 0);
+
+      contributors.reset(ReadinessContributors::hrv_balance);
+      REQUIRE(contributors == ReadinessContributorArray{});
+   }
+
+
+   TEST_CASE("test_parse_readiness_contributors", "[parsing][EnumArray]")
+   {
+      using namespace detail;
+
+      // contributors can be null or missing.
+      constexpr auto json = R"({"contributors":{"activity_balance":87,"body_temperature":null,"hrv_balance":94,"previous_night":1,
+                                                "recovery_index":0,"resting_heart_rate":33,"sleep_balance":51},
+                                "score":48,"temperature_deviation":-0.1,"temperature_trend_deviation":null})";
+
+      auto data_res = readJson<sleep_data::readiness_data>(std::string{ json });
+      REQUIRE(data_res.has_value());
+
+      const auto& contributors = data_res->contributors;
+      REQUIRE(contributors.count() == 6);
+      REQUIRE(contributors.get(ReadinessContributors::activity_balance) == 87);
+      REQUIRE(contributors.get(ReadinessContributors::recovery_index) == 0);
+      REQUIRE(contributors.get(ReadinessContributors::resting_heart_rate) == 33);
+      REQUIRE_FALSE(contributors.contains(ReadinessContributors::body_temperature));
+      REQUIRE_FALSE(contributors.contains(ReadinessContributors::previous_day_activity));
+      REQUIRE(data_res->score == 48);
+
+      // writing it back out gives us an object again.
+      auto out_json = glz::write_json(contributors);
+      REQUIRE(out_json.contains(R"("hrv_balance":94)"));
+      auto round_trip = readJson<sleep_data::ReadinessContributorArray>(out_json);
+      REQUIRE(round_trip.has_value());
+      REQUIRE(round_trip.value() == contributors);
+   }
+
+
+   TEST_CASE("test_ReadinessContributorAvgCalc", "[EnumArray]")
+   {
+      SyntheticDataGenerator gen{ SyntheticDataOptions{ .num_days = 30 } };
+      TestDataProvider provider{};
+      gen.populate(provider);
+      auto sessions = detail::getDataSeries<SleepSession>(provider);
+      REQUIRE(sessions.size() > 0);
+
+      ReadinessContributorAvgCalc calc{};
+      rg::for_each(sessions | vw::transform(&SleepSession::readinessContributors), std::ref(calc));
+      REQUIRE(calc.count() == sessions.size());
+
+      // compare against a plain AvgCalc for each contributor
+      auto averages = calc.result();
+      for (size_t idx = 0; idx < ReadinessContributorArray::size(); ++idx)
+      {
+         auto contributor = static_cast<ReadinessContributors>(idx);
+         AvgCalc<int> expected{};
+         for (const auto& session : sessions)
+         {
+            expected(session.readinessContributors().get(contributor));
+         }
+
+         REQUIRE(averages.contains(contributor) == expected.hasResult());
+         if (expected.hasResult())
+         {
+            REQUIRE_THAT(averages[contributor], Catch::Matchers::WithinRel(*expected.result()));
+         }
+      }
+   }
+
+
+   TEST_CASE("test_SleepSessionSummary", "[parsing]")
+   {
+      SyntheticDataGenerator gen{ SyntheticDataOptions{ .num_days = 30 } };
+      TestDataProvider provider{};
+      gen.populate(provider);
+
+      auto sessions = detail::getDataSeries<SleepSession>(provider);
+      auto summaries = detail::getDataSeries<SleepSessionSummary>(provider);
+      REQUIRE(summaries.size() == sessions.size());
+
+      // summary values are the same as the full parse, the rest are empty.
+      for (const auto& [session, summary] : vw::zip(sessions, summaries))
+      {
+         REQUIRE(summary.id() == session.id());
+         REQUIRE(summary.sleepType() == session.sleepType());
+         REQUIRE(summary.sessionDate() == session.sessionDate());
+         REQUIRE(summary.bedtimeStart() == session.bedtimeStart());
+         REQUIRE(summary.bedtimeEnd() == session.bedtimeEnd());
+         REQUIRE(summary.avgHRV() == session.avgHRV());
+         REQUIRE(summary.avgHeartRate() == session.avgHeartRate());
+         REQUIRE(summary.restingHeartRate() == session.restingHeartRate());
+         REQUIRE(summary.sleepTimeTotal() == session.sleepTimeTotal());
+         REQUIRE(summary.restlessPeriods() == session.restlessPeriods());
+         REQUIRE(summary.readinessScore() == session.readinessScore());
+         REQUIRE(summary.temperatureDeviation() == session.temperatureDeviation());
+         REQUIRE(summary.readinessContributors().count() == 0);
+      }
+
+      // projections, filters and field descriptors for SleepSession work with the summary.
+      summaries.keepIf(long_sleep_filter);
+      auto hrv = extractColumn(summaries, sessionAvgHRVField);
+      REQUIRE(hrv.size() == summaries.size());
+      REQUIRE(sessionWeekday(summaries.front()) == weekday{ sys_days{ summaries.front().sessionDate() } });
+   }
+
+
 // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
 
 } // namespace oura_charts::test
@@ -0,0 +1,124 @@
+//---------------------------------------------------------------------------------------------------------------------
+// test_SyntheticDataGenerator.cpp
+//
+// unit tests for the synthetic data generator used for large-dataset tests and benchmarks.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+#include "oura_charts/oura_charts.h"
+#include "SyntheticDataGenerator.h"
+#include "oura_charts/DailySleepScore.h"
+#include "oura_charts/HeartRate.h"
+#include "oura_charts/SleepSession.h"
+#include <catch2/catch_test_macros.hpp>
+
+namespace oura_charts::test
+{
+   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+   using namespace std::literals;
+
+
+   TEST_CASE("test_SyntheticDataGenerator_deterministic", "[synthetic]")
+   {
+      SyntheticDataOptions options{ .num_days = 14, .page_size = 100 };
+      SyntheticDataGenerator gen1{ options };
+      SyntheticDataGenerator gen2{ options };
+
+      REQUIRE(gen1.heartRatePages() == gen2.heartRatePages());
+      REQUIRE(gen1.sleepSessionPages() == gen2.sleepSessionPages());
+      REQUIRE(gen1.dailySleepScorePages() == gen2.dailySleepScorePages());
+
+      // a different seed should give us different data
+      options.seed += 1;
+      SyntheticDataGenerator gen3{ options };
+      REQUIRE(gen1.heartRatePages() != gen3.heartRatePages());
+      REQUIRE(gen1.sleepSessionPages() != gen3.sleepSessionPages());
+   }
+
+
+   TEST_CASE("test_SyntheticDataGenerator_pagination", "[synthetic]")
+   {
+      SyntheticDataGenerator gen{ SyntheticDataOptions{ .num_days = 10, .page_size = 250, .time_zone = "" } };
+
+      // 10 days of samples every 5 minutes == 2880 records == 12 pages
+      REQUIRE(gen.heartRateCount() == 2880);
+      auto pages = gen.heartRatePages();
+      REQUIRE(pages.size() == 12);
+      REQUIRE(pages.front().contains(R"("next_token":"1")"));
+      REQUIRE(pages.back().contains(R"("next_token":null)"));
+
+      // everything fits on a single page
+      REQUIRE(gen.dailySleepScorePages().size() == 1);
+   }
+
+
+   TEST_CASE("test_SyntheticDataGenerator_getDataSeries", "[synthetic][parsing]")
+   {
+      SyntheticDataGenerator gen{ SyntheticDataOptions{ .num_days = 30, .page_size = 500 } };
+      TestDataProvider provider{};
+      gen.populate(provider);
+
+      auto hr_series = detail::getDataSeries<HeartRate>(provider, detail::SortedPropertyMap{});
+      REQUIRE(hr_series.size() == gen.heartRateCount());
+
+      auto sleep_series = detail::getDataSeries<SleepSession>(provider, detail::SortedPropertyMap{});
+      REQUIRE(sleep_series.size() == gen.sleepSessionCount());
+      REQUIRE(sleep_series.size() >= 30);
+
+      auto score_series = detail::getDataSeries<DailySleepScore>(provider, detail::SortedPropertyMap{});
+      REQUIRE(score_series.size() == gen.dailySleepScoreCount());
+   }
+
+
+   TEST_CASE("test_SyntheticDataGenerator_null_density", "[synthetic]")
+   {
+      SyntheticDataGenerator no_nulls{ SyntheticDataOptions{ .num_days = 7, .null_density = 0.0 } };
+      for (const auto& page : no_nulls.sleepSessionPages())
+      {
+         // the delta values are always null, so look for nulls anywhere else.
+         std::string json{ page };
+         for (auto key : { R"("readiness_score_delta":null)"sv, R"("sleep_score_delta":null)"sv, R"("next_token":null)"sv })
+         {
+            for (auto pos = json.find(key); pos != std::string::npos; pos = json.find(key))
+               json.erase(pos, key.size());
+         }
+         REQUIRE_FALSE(json.contains("null"));
+      }
+
+      SyntheticDataGenerator all_nulls{ SyntheticDataOptions{ .num_days = 7, .null_density = 1.0 } };
+      for (const auto& page : all_nulls.sleepSessionPages())
+      {
+         REQUIRE(page.contains(R"("average_hrv":null)"));
+         REQUIRE_FALSE(page.contains(R"("average_hrv":{)"));
+      }
+   }
+
+
+   TEST_CASE("test_SyntheticDataGenerator_dst_crossing", "[synthetic]")
+   {
+      // DST started on 3/13/2022 in the US
+      SyntheticDataOptions options{ .start_date = chrono::year{ 2022 } / 3 / 1, .num_days = 30 };
+      SyntheticDataGenerator gen{ options };
+
+      std::string sleep_json{};
+      for (const auto& page : gen.sleepSessionPages())
+         sleep_json.append(page);
+
+      REQUIRE(sleep_json.contains("-06:00"));
+      REQUIRE(sleep_json.contains("-05:00"));
+
+      // spring-forward day is only 23 hours long.
+      REQUIRE(gen.heartRateCount() == (30 * 24 - 1) * 12);
+
+      // no DST crossings in UTC
+      options.time_zone.clear();
+      SyntheticDataGenerator utc_gen{ options };
+      REQUIRE(utc_gen.heartRateCount() == 30 * 24 * 12);
+      for (const auto& page : utc_gen.sleepSessionPages())
+         REQUIRE_FALSE(page.contains("-05:00"));
+   }
+
+   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+} // namespace oura_charts::test
@@ -0,0 +1,122 @@
+//---------------------------------------------------------------------------------------------------------------------
+// test_TemporalJoin.cpp
+//
+// unit tests for joining heart rate samples with sleep session/day windows.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+#include "oura_charts/oura_charts.h"
+#include "SyntheticDataGenerator.h"
+#include "TestDataProvider.h"
+#include "oura_charts/DailySleepScore.h"
+#include "oura_charts/HeartRate.h"
+#include "oura_charts/SleepSession.h"
+#include "oura_charts/TemporalJoin.h"
+#include <catch2/catch_test_macros.hpp>
+
+namespace oura_charts::test
+{
+   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+   using namespace std::literals;
+
+   namespace
+   {
+      constexpr auto session_window = selectAsWindow<&SleepSession::bedtimeStart, &SleepSession::bedtimeEnd>;
+      constexpr auto day_window = selectAsDayWindow<&DailySleepScore::date>;
+
+      // the slow way, for comparison
+      template <typename WindowT>
+      auto countInWindow(const HeartRateSeries& hr_series, const WindowT& window, auto&& window_proj)
+      {
+         TimeWindow interval = window_proj(window);
+         return rg::count_if(hr_series, [&interval] (const HeartRate& hr) { return interval.contains(hr.timestamp()); });
+      }
+   }
+
+
+   TEST_CASE("test_joinByWindow_sleep_sessions", "[join]")
+   {
+      SyntheticDataGenerator gen{ SyntheticDataOptions{ .num_days = 14 } };
+      TestDataProvider provider{};
+      gen.populate(provider);
+
+      auto hr_series = detail::getDataSeries<HeartRate>(provider);
+      auto sessions = detail::getDataSeries<SleepSession>(provider);
+      REQUIRE(sessions.size() >= 14);
+
+      auto hr_by_session = joinByWindow(hr_series, sessions, session_window);
+      REQUIRE(hr_by_session.size() == sessions.size());
+
+      for (const auto& [session, hr_samples] : hr_by_session)
+      {
+         REQUIRE(rg::ssize(hr_samples) == countInWindow(hr_series, session.get(), session_window));
+         REQUIRE(rg::all_of(hr_samples, [&] (const HeartRate& hr) { return session_window(session.get()).contains(hr.timestamp()); }));
+      }
+   }
+
+
+   TEST_CASE("test_joinByWindow_days", "[join]")
+   {
+      SyntheticDataGenerator gen{ SyntheticDataOptions{ .num_days = 10 } };
+      TestDataProvider provider{};
+      gen.populate(provider);
+
+      auto hr_series = detail::getDataSeries<HeartRate>(provider);
+      auto scores = detail::getDataSeries<DailySleepScore>(provider);
+
+      std::vector<ptrdiff_t> counts{};
+      forEachWindow(hr_series, scores, day_window, [&counts] (const DailySleepScore&, auto hr_samples)
+                                                   {
+                                                      counts.push_back(rg::ssize(hr_samples));
+                                                   });
+      REQUIRE(counts.size() == scores.size());
+
+      ptrdiff_t total{};
+      for (auto&& [score, count] : vw::zip(scores, counts))
+      {
+         REQUIRE(count == countInWindow(hr_series, score, day_window));
+         total += count;
+      }
+
+      // the days don't overlap, so every sample that falls on a day with a score is counted once.
+      REQUIRE(total <= rg::ssize(hr_series));
+      REQUIRE(total > 0);
+   }
+
+
+   TEST_CASE("test_joinByWindow_overlapping", "[join]")
+   {
+      // one sample per minute for 4 hours
+      constexpr local_days day{ 2024y / 3 / 1 };
+      std::vector<detail::hr_data> hr_structs{};
+      for (auto ts = local_seconds{ day }; ts < day + 4h; ts += 1min)
+      {
+         hr_structs.emplace_back(detail::hr_data{ 60, "test"s, ts });
+      }
+      HeartRateSeries hr_series{ hr_structs };
+
+      // windows that overlap, are out of order, are empty, and are outside the data.
+      constexpr auto window_proj = [] (const TimeWindow& w) { return w; };
+      std::vector<TimeWindow> windows{ { day, day + 2h },
+                                       { day + 1h, day + 1h + 30min },
+                                       { day + 30min, day + 3h },
+                                       { day + 3h, day + 3h },
+                                       { day + 3h + 50min, day + 5h },
+                                       { day + 6h, day + 7h } };
+
+      auto joined = joinByWindow(hr_series, windows, window_proj);
+      REQUIRE(joined.size() == windows.size());
+
+      std::vector<ptrdiff_t> counts{};
+      for (const auto& [window, hr_samples] : joined)
+      {
+         REQUIRE(rg::all_of(hr_samples, [&] (const HeartRate& hr) { return window.get().contains(hr.timestamp()); }));
+         counts.push_back(rg::ssize(hr_samples));
+      }
+      REQUIRE(counts == std::vector<ptrdiff_t>{ 120, 30, 150, 0, 10, 0 });
+   }
+
+   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+} // namespace oura_charts::test
@@ -0,0 +1,147 @@
+//---------------------------------------------------------------------------------------------------------------------
+// test_ThreadPool.cpp
+//
+// unit tests for ThreadPool and TaskGroup
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+#include "oura_charts/oura_charts.h"
+#include "oura_charts/ThreadPool.h"
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+namespace oura_charts::test
+{
+   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+   TEST_CASE("test_ThreadPool_submit", "[pool]")
+   {
+      ThreadPool pool{ 4 };
+      REQUIRE(pool.threadCount() == 4);
+      REQUIRE_FALSE(pool.isWorkerThread());
+
+      std::vector<std::future<int>> results{};
+      for (int i = 0; i < 100; ++i)
+      {
+         results.push_back(pool.submit([i] { return i * 2; }));
+      }
+      for (int i = 0; i < 100; ++i)
+      {
+         REQUIRE(results[static_cast<size_t>(i)].get() == i * 2);
+      }
+
+      // the task runs on one of the pool's threads
+      auto on_worker = pool.submit([&pool] { return pool.isWorkerThread(); });
+      REQUIRE(on_worker.get());
+
+      // exceptions end up in the future
+      auto failed = pool.submit([] () -> int { throw std::runtime_error{ "test" }; });
+      REQUIRE_THROWS_AS(failed.get(), std::runtime_error);
+   }
+
+
+   TEST_CASE("test_ThreadPool_zero_threads", "[pool]")
+   {
+      // always has at least one thread
+      ThreadPool pool{ 0 };
+      REQUIRE(pool.threadCount() == 1);
+      REQUIRE(pool.submit([] { return 42; }).get() == 42);
+   }
+
+
+   TEST_CASE("test_TaskGroup_wait", "[pool]")
+   {
+      ThreadPool pool{ 3 };
+
+      SECTION("all tasks have finished when wait() returns")
+      {
+         std::vector<int> values(1000);
+         TaskGroup group{ pool };
+         for (size_t i = 0; i < values.size(); ++i)
+         {
+            group.run([&values, i] { values[i] = static_cast<int>(i); });
+         }
+         group.wait();
+
+         std::vector<int> expected(values.size());
+         std::iota(expected.begin(), expected.end(), 0);
+         REQUIRE(values == expected);
+      }
+
+      SECTION("the first exception is rethrown")
+      {
+         std::atomic<int> completed{};
+         TaskGroup group{ pool };
+         for (int i = 0; i < 20; ++i)
+         {
+            group.run([&completed, i]
+                      {
+                         if (i == 10)
+                            throw std::runtime_error{ "test" };
+                         ++completed;
+                      });
+         }
+         REQUIRE_THROWS_AS(group.wait(), std::runtime_error);
+
+         // the other tasks still ran, and the error is cleared once it's been thrown.
+         REQUIRE(completed == 19);
+         REQUIRE_NOTHROW(group.wait());
+      }
+
+      SECTION("nested groups don't deadlock")
+      {
+         // every worker waits on a group of its own, which only works if waiting threads run queued tasks.
+         std::atomic<int> leaf_count{};
+         TaskGroup outer{ pool };
+         for (int i = 0; i < 8; ++i)
+         {
+            outer.run([&pool, &leaf_count]
+                      {
+                         TaskGroup inner{ pool };
+                         for (int j = 0; j < 8; ++j)
+                         {
+                            inner.run([&leaf_count] { ++leaf_count; });
+                         }
+                         inner.wait();
+                      });
+         }
+         outer.wait();
+         REQUIRE(leaf_count == 64);
+      }
+   }
+
+
+   TEST_CASE("test_ThreadPool_uses_all_threads", "[pool]")
+   {
+      constexpr size_t thread_count = 4;
+      ThreadPool pool{ thread_count };
+
+      // each task blocks until all of them have started, so they have to run on different threads.
+      std::atomic<size_t> started{};
+      std::mutex mutex{};
+      std::set<std::thread::id> thread_ids{};
+      TaskGroup group{ pool };
+      for (size_t i = 0; i < thread_count; ++i)
+      {
+         group.run([&]
+                   {
+                      {
+                         std::lock_guard lock{ mutex };
+                         thread_ids.insert(std::this_thread::get_id());
+                      }
+                      ++started;
+                      while (started < thread_count)
+                         std::this_thread::yield();
+                   });
+      }
+      group.wait();
+      REQUIRE(thread_ids.size() == thread_count);
+   }
+
+   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+} // namespace oura_charts::test
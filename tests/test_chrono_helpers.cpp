@@ -101,6 +101,45 @@ namespace oura_charts::test
       REQUIRE(avg_calc.result().value() == 35s);
    }
 
+   TEST_CASE("test_DayNumber", "[datetime]")
+   {
+      static_assert(toDayNumber(1970y / 1 / 1) == 0);
+      static_assert(dayNumberToWeekday(0) == chrono::Thursday);
+      static_assert(dayNumberToYearMonthDay(toDayNumber(ymd)) == ymd);
+
+      REQUIRE(toDayNumber(sys_secs) == toDayNumber(ymd));
+      REQUIRE(toDayNumber(local_secs) == toDayNumber(ymd));
+
+      // compare against the chrono calendar types for every day from 1900 through 2100, which covers negative
+      // day numbers and the century/400 year leap rules.
+      constexpr auto first = toDayNumber(1900y / 1 / 1);
+      constexpr auto last = toDayNumber(2100y / 12 / 31);
+      for (auto day_num = first; day_num <= last; ++day_num)
+      {
+         const sys_days day{ days{ day_num } };
+         const year_month_day expected{ day };
+         const auto actual = dayNumberToYearMonthDay(day_num);
+         if (actual != expected || dayNumberToWeekday(day_num) != weekday{ day })
+         {
+            FAIL("mismatch for day number " << day_num);
+         }
+      }
+
+      // projections from a cached day number match the ones that use the date
+      struct DateHolder
+      {
+         year_month_day date() const { return dayNumberToYearMonthDay(day_num); }
+         DayNumber dayNumber() const { return day_num; }
+         DayNumber day_num{};
+      };
+      DateHolder holder{ toDayNumber(2024y / 2 / 29) };
+      REQUIRE(selectDayNumberAsWeekday<&DateHolder::dayNumber>(holder) == selectAsWeekday<&DateHolder::date>(holder));
+      REQUIRE(selectDayNumberAsMonth<&DateHolder::dayNumber>(holder) == selectAsMonth<&DateHolder::date>(holder));
+      REQUIRE(selectDayNumberAsYear<&DateHolder::dayNumber>(holder) == selectAsYear<&DateHolder::date>(holder));
+      REQUIRE(selectDayNumberAsYearMonth<&DateHolder::dayNumber>(holder) == selectAsYearMonth<&DateHolder::date>(holder));
+      REQUIRE(selectDayNumberAsYearMonthDay<&DateHolder::dayNumber>(holder) == selectAsYearMonthDay<&DateHolder::date>(holder));
+   }
+
    // NOLINTEND(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access) 
 
 } // namespace oura_charts::test
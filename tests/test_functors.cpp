@@ -166,6 +166,35 @@ namespace oura_charts::test
       REQUIRE(avg == testFunctor(nullable_range, AvgCalc<int, double>{}));
    }
 
+
+   TEST_CASE("test_calc_merge")
+   {
+      // splitting a range in two and merging the results is the same as calculating over the whole range.
+      auto mergedResult = [] <typename CalcT> (const auto& range, CalcT&&, size_t split)
+                          {
+                             CalcT first{};
+                             CalcT second{};
+                             rg::for_each(range | vw::take(split), std::ref(first));
+                             rg::for_each(range | vw::drop(split), std::ref(second));
+                             first.merge(second);
+                             return first.result();
+                          };
+
+      for (size_t split = 0; split <= nullable_range.size(); ++split)
+      {
+         REQUIRE(mergedResult(nullable_range, MinCalc<int>{}, split) == testFunctor(nullable_range, MinCalc<int>{}));
+         REQUIRE(mergedResult(nullable_range, MaxCalc<int>{}, split) == testFunctor(nullable_range, MaxCalc<int>{}));
+         REQUIRE(mergedResult(nullable_range, SumCalc<int>{}, split) == testFunctor(nullable_range, SumCalc<int>{}));
+         REQUIRE(mergedResult(nullable_range, AvgCalc<int>{}, split) == testFunctor(nullable_range, AvgCalc<int>{}));
+      }
+
+      // nothing merged into nothing is still nothing.
+      REQUIRE_FALSE(mergedResult(all_null, SumCalc<int>{}, 2).has_value());
+
+      std::array durations = { 10min, 20min, 45min, 5min };
+      REQUIRE(mergedResult(durations, AvgCalc<minutes>{}, 1) == testFunctor(durations, AvgCalc<minutes>{}));
+   }
+
    // NOLINTEND(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
 
 }  // namespace oura_charts::test
@@ -0,0 +1,77 @@
+//---------------------------------------------------------------------------------------------------------------------
+// test_instrumentation.cpp
+//
+// unit tests for the instrumentation counters/histograms/timers
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+
+#include "oura_charts/detail/instrumentation.h"
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+
+namespace oura_charts::test
+{
+   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+   TEST_CASE("test_instrumentation_counter")
+   {
+      if constexpr (!instrumentation::ENABLED)
+         SKIP("instrumentation disabled at compile time");
+
+      auto& ctr = instrumentation::counter("test.counter");
+      ctr.reset();
+      ctr.add();
+      ctr.add(4);
+      REQUIRE(ctr.value() == 5);
+
+      // looking up the same name again must return the same object
+      REQUIRE(&ctr == &instrumentation::counter("test.counter"));
+   }
+
+
+   TEST_CASE("test_instrumentation_histogram")
+   {
+      if constexpr (!instrumentation::ENABLED)
+         SKIP("instrumentation disabled at compile time");
+
+      auto& hist = instrumentation::histogram("test.histogram", instrumentation::MetricUnit::Bytes);
+      hist.reset();
+      for (uint64_t val : { 10, 20, 30, 1000 })
+         hist.record(val);
+
+      REQUIRE(hist.count() == 4);
+      REQUIRE(hist.sum() == 1060);
+      REQUIRE(hist.min() == 10);
+      REQUIRE(hist.max() == 1000);
+      REQUIRE(hist.bucket(4) == 1); // 10 is in [8, 16)
+      REQUIRE(hist.bucket(5) == 2); // 20, 30 are in [16, 32)
+
+      auto metrics = instrumentation::snapshot();
+      auto it = std::ranges::find(metrics, "test.histogram", &instrumentation::MetricSnapshot::name);
+      REQUIRE(it != metrics.end());
+      REQUIRE(it->unit == instrumentation::MetricUnit::Bytes);
+      REQUIRE(it->average() == 265.0);
+   }
+
+
+   TEST_CASE("test_instrumentation_scoped_timer")
+   {
+      if constexpr (!instrumentation::ENABLED)
+         SKIP("instrumentation disabled at compile time");
+
+      auto& timer_hist = instrumentation::timer("test.timer");
+      timer_hist.reset();
+      {
+         instrumentation::ScopedTimer timer{ timer_hist };
+      }
+      REQUIRE(timer_hist.count() == 1);
+
+      instrumentation::reset();
+      REQUIRE(timer_hist.count() == 0);
+      REQUIRE(instrumentation::snapshotToJson().find("test.timer") == std::string::npos);
+   }
+
+   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+} // namespace oura_charts::test
@@ -0,0 +1,121 @@
+//---------------------------------------------------------------------------------------------------------------------
+// test_json_backend.cpp
+//
+// unit tests for the JSON backends used by readJson()
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+#include "oura_charts/oura_charts.h"
+#include "SyntheticDataGenerator.h"
+#include "oura_charts/detail/json_structs.h"
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <vector>
+
+namespace oura_charts::test
+{
+   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
+
+   using namespace detail;
+
+   namespace
+   {
+      /// <summary>
+      ///   parse a page with the specified backend and return the decoded structs, so that every member of the
+      ///   results can be compared between backends.
+      /// </summary>
+      template <typename StorageT, typename BackendT>
+      std::vector<StorageT> parseData(const std::string& json, BackendT backend)
+      {
+         auto res = readJson<RestDataCollection<StorageT>>(json, {}, backend);
+         REQUIRE(res.has_value());
+         return std::move(res.value().data);
+      }
+
+      const SyntheticDataGenerator& generator()
+      {
+         static SyntheticDataGenerator gen{ SyntheticDataOptions{ .num_days = 30, .page_size = 0, .null_density = 0.2 } };
+         return gen;
+      }
+   }
+
+
+   static_assert(JsonBackendFor<GlazeBackend, hr_data>);
+   static_assert(JsonBackendFor<DefaultJsonBackend, RestDataCollection<sleep_data>>);
+
+
+   TEST_CASE("test_GlazeBackend", "[parsing][json]")
+   {
+      // explicitly selecting glaze gives the same result as the default, whichever backend that is.
+      const auto json = generator().heartRatePages().front();
+      auto default_res = readJson<RestDataCollection<hr_data>>(json);
+      auto glaze_res = readJson<RestDataCollection<hr_data>>(json, {}, GlazeBackend{});
+      REQUIRE(default_res.has_value());
+      REQUIRE(glaze_res.has_value());
+      REQUIRE(default_res->data.size() == generator().heartRateCount());
+      REQUIRE(default_res->data == glaze_res->data);
+
+      // errors are reported as an oura_exception
+      auto bad_res = readJson<RestDataCollection<hr_data>>(std::string{ R"({"data":[{"bpm":"fast"}]})" }, {}, GlazeBackend{});
+      REQUIRE_FALSE(bad_res.has_value());
+      REQUIRE(bad_res.error().category == ErrorCategory::Parse);
+   }
+
+
+#if defined(OURACHARTS_SIMDJSON) && OURACHARTS_SIMDJSON
+
+   TEST_CASE("test_SimdjsonBackend_matches_glaze", "[parsing][json]")
+   {
+      SECTION("heart rate")
+      {
+         const auto json = generator().heartRatePages().front();
+         const auto simd_data = parseData<hr_data>(json, SimdjsonBackend{});
+         REQUIRE(simd_data.size() == generator().heartRateCount());
+         REQUIRE(simd_data == parseData<hr_data>(json, GlazeBackend{}));
+      }
+
+      SECTION("sleep sessions")
+      {
+         const auto json = generator().sleepSessionPages().front();
+         const auto simd_data = parseData<sleep_data>(json, SimdjsonBackend{});
+         REQUIRE(simd_data.size() == generator().sleepSessionCount());
+         REQUIRE(simd_data == parseData<sleep_data>(json, GlazeBackend{}));
+         REQUIRE(parseData<sleep_summary_data>(json, SimdjsonBackend{}) == parseData<sleep_summary_data>(json, GlazeBackend{}));
+      }
+
+      SECTION("daily sleep scores")
+      {
+         const auto json = generator().dailySleepScorePages().front();
+         const auto simd_data = parseData<daily_sleep_data>(json, SimdjsonBackend{});
+         REQUIRE(simd_data.size() == generator().dailySleepScoreCount());
+         REQUIRE(simd_data == parseData<daily_sleep_data>(json, GlazeBackend{}));
+      }
+
+      SECTION("readiness contributors")
+      {
+         constexpr auto json = R"({"activity_balance": 56, "body_temperature": 98, "hrv_balance": null, "unknown": [1, 2], "sleep_balance": 81})";
+         auto simd_res = readJson<sleep_data::ReadinessContributorArray>(std::string{ json }, {}, SimdjsonBackend{});
+         auto glaze_res = readJson<sleep_data::ReadinessContributorArray>(std::string{ json }, {}, GlazeBackend{});
+         REQUIRE(simd_res.has_value());
+         REQUIRE(glaze_res.has_value());
+         REQUIRE(simd_res->values() == glaze_res->values());
+         REQUIRE(simd_res->presence() == glaze_res->presence());
+      }
+   }
+
+
+   TEST_CASE("test_SimdjsonBackend_errors", "[parsing][json]")
+   {
+      auto parse = [] (std::string json) { return readJson<RestDataCollection<hr_data>>(json, {}, SimdjsonBackend{}); };
+
+      REQUIRE_FALSE(parse(R"({"data":[{"bpm":"fast"}]})").has_value());
+      REQUIRE_FALSE(parse(R"({"data":[{"bpm":60,"timestamp":"yesterday"}]})").has_value());
+      REQUIRE_FALSE(parse(R"({"data":[{"bpm":60)").has_value());
+      REQUIRE(parse(R"({"data":[],"next_token":null})").has_value());
+   }
+
+#endif
+
+   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
+
+} // namespace oura_charts::test
@@ -0,0 +1,172 @@
+//---------------------------------------------------------------------------------------------------------------------
+// test_json_stream.cpp
+//
+// unit tests for incremental (streaming) parsing of paged REST data.
+//
+// Copyright (c) 2024 Jeff Kohn. All Right Reserved.
+//---------------------------------------------------------------------------------------------------------------------
+#include "oura_charts/oura_charts.h"
+#include "SyntheticDataGenerator.h"
+#include "TestDataProvider.h"
+#include "oura_charts/DataSeries.h"
+#include "oura_charts/HeartRate.h"
+#include "oura_charts/SleepSession.h"
+#include "oura_charts/detail/json_stream.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <string>
+#include <vector>
+
+namespace oura_charts::test
+{
+   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
+
+   using namespace std::literals;
+   using detail::JsonPageSplitter;
+
+   namespace
+   {
+      // feed 'json' to a splitter in chunks of the specified size, collecting the records.
+      auto splitPage(std::string_view json, size_t chunk_size, std::vector<std::string>& records)
+      {
+         JsonPageSplitter splitter{};
+         for (size_t pos = 0; pos < json.size(); pos += chunk_size)
+         {
+            bool ok = splitter.feed(json.substr(pos, chunk_size), [&records] (std::string_view record)
+                                                                  {
+                                                                     records.emplace_back(record);
+                                                                     return true;
+                                                                  });
+            if (!ok)
+               break;
+         }
+         return splitter.finish();
+      }
+   }
+
+
+   TEST_CASE("test_JsonPageSplitter_chunk_boundaries", "[json_stream]")
+   {
+      // strings containing braces, brackets, escaped quotes and a "data" key that isn't the top-level one.
+      constexpr auto json = R"({ "data": [ {"id":"a","text":"}]{[","nested":{"data":[1,2]}},
+                                           {"id":"b","text":"say \"hi\" \\"},
+                                           {"id":"c","list":[{"x":1},{"x":2}]} ],
+                                 "next_token": "abc\"123" })"sv;
+
+      auto chunk_size = GENERATE(1u, 2u, 3u, 7u, 64u, 4096u);
+      std::vector<std::string> records{};
+      auto next_token = splitPage(json, chunk_size, records);
+
+      REQUIRE(next_token.has_value());
+      REQUIRE(next_token.value() == R"(abc"123)");
+      REQUIRE(records.size() == 3);
+      REQUIRE(records[0] == R"({"id":"a","text":"}]{[","nested":{"data":[1,2]}})");
+      REQUIRE(records[1] == R"({"id":"b","text":"say \"hi\" \\"})");
+      REQUIRE(records[2] == R"({"id":"c","list":[{"x":1},{"x":2}]})");
+   }
+
+
+   TEST_CASE("test_JsonPageSplitter_envelope", "[json_stream]")
+   {
+      std::vector<std::string> records{};
+
+      SECTION("next_token before data, and no more pages")
+      {
+         auto next_token = splitPage(R"({"next_token":null,"data":[{"id":"a"}]})", 5, records);
+         REQUIRE(next_token.has_value());
+         REQUIRE_FALSE(next_token.value().has_value());
+         REQUIRE(records.size() == 1);
+      }
+
+      SECTION("empty data array")
+      {
+         auto next_token = splitPage(R"({"data":[],"next_token":"2"})", 3, records);
+         REQUIRE(next_token.has_value());
+         REQUIRE(next_token.value() == "2");
+         REQUIRE(records.empty());
+      }
+
+      SECTION("truncated page")
+      {
+         auto next_token = splitPage(R"({"data":[{"id":"a"},{"id":)", 4, records);
+         REQUIRE_FALSE(next_token.has_value());
+         REQUIRE(next_token.error().category == ErrorCategory::Parse);
+         REQUIRE(records.size() == 1);
+      }
+
+      SECTION("data array doesn't contain objects")
+      {
+         auto next_token = splitPage(R"({"data":[1,2,3],"next_token":null})", 4, records);
+         REQUIRE_FALSE(next_token.has_value());
+         REQUIRE(records.empty());
+      }
+
+      SECTION("data array contains a bare string")
+      {
+         auto next_token = splitPage(R"({"data":["x",{"id":"a"}],"next_token":null})", 3, records);
+         REQUIRE_FALSE(next_token.has_value());
+         REQUIRE(next_token.error().category == ErrorCategory::Parse);
+         REQUIRE(records.empty());
+      }
+
+      SECTION("unbalanced brackets")
+      {
+         auto next_token = splitPage(R"({"data":[]}]})", 4, records);
+         REQUIRE_FALSE(next_token.has_value());
+      }
+   }
+
+
+   TEST_CASE("test_JsonPageSplitter_cancel", "[json_stream]")
+   {
+      JsonPageSplitter splitter{};
+      size_t count{};
+      auto ok = splitter.feed(R"({"data":[{"id":"a"},{"id":"b"},{"id":"c"}],"next_token":null})",
+                              [&count] (std::string_view) { return ++count < 2; });
+
+      REQUIRE_FALSE(ok);
+      REQUIRE(count == 2);
+      REQUIRE_FALSE(splitter.finish().has_value());
+   }
+
+
+   TEST_CASE("test_streamDataSeries", "[json_stream][parsing]")
+   {
+      SyntheticDataGenerator gen{ SyntheticDataOptions{ .num_days = 20, .page_size = 300 } };
+      TestDataProvider provider{};
+      gen.populate(provider);
+
+      // small chunks so most records are split across chunk boundaries.
+      provider.setStreamChunkSize(GENERATE(17u, 4096u));
+
+      SECTION("streamed series matches the buffered one")
+      {
+         DataSeries<HeartRate> streamed{};
+         auto count = detail::streamDataSeries<HeartRate>(provider, detail::SortedPropertyMap{}, appendTo(streamed));
+         auto buffered = detail::getDataSeries<HeartRate>(provider, detail::SortedPropertyMap{});
+
+         REQUIRE(count == gen.heartRateCount());
+         REQUIRE(streamed.size() == buffered.size());
+         REQUIRE(std::ranges::equal(streamed, buffered, {}, &HeartRate::timestamp, &HeartRate::timestamp));
+         REQUIRE(std::ranges::equal(streamed, buffered, {}, &HeartRate::beatsPerMin, &HeartRate::beatsPerMin));
+      }
+
+      SECTION("records can be consumed without being stored")
+      {
+         size_t sessions{};
+         auto count = detail::streamDataSeries<SleepSession>(provider, detail::SortedPropertyMap{},
+                                                             [&sessions] (SleepSession&&) { ++sessions; });
+         REQUIRE(count == gen.sleepSessionCount());
+         REQUIRE(sessions == count);
+      }
+
+      SECTION("sink exceptions are propagated")
+      {
+         auto throwing_sink = [] (HeartRate&&) { throw oura_exception{ "sink failed" }; };
+         REQUIRE_THROWS_AS(detail::streamDataSeries<HeartRate>(provider, detail::SortedPropertyMap{}, throwing_sink), oura_exception);
+      }
+   }
+
+   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers, bugprone-unchecked-optional-access)
+
+} // namespace oura_charts::test